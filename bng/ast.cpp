@@ -11,6 +11,7 @@
 #include <cerrno>
 #include <iostream>
 #include <string>
+#include <algorithm>
 
 #include "bng/ast.h"
 #include "bng/parser_utils.h"
@@ -23,6 +24,8 @@ namespace BNG {
 static const std::string IND2 = "  ";
 static const std::string IND4 = "    ";
 
+static const size_t AST_ARENA_BLOCK_SIZE = 64 * 1024;
+
 // ------------------------------- ASTBaseNode ------------------------
 void ASTBaseNode::dump(const std::string ind) const {
   if (has_loc) {
@@ -190,7 +193,7 @@ void ASTSymbolTable::insert(const std::string id, ASTBaseNode* node, ParserConte
   }
 
   if (table.count(id) != 0) {
-    errs_loc() << "Symbol '" << id << "' was already defined.\n";
+    errs_loc(ctx) << "Symbol '" << id << "' was already defined.\n";
     ctx->inc_error_count();
   }
 
@@ -209,7 +212,7 @@ void ASTSymbolTable::insert(const std::string id, ASTBaseNode* node, ParserConte
 ASTBaseNode* ASTSymbolTable::get(const std::string& id, ASTBaseNode* loc, ParserContext* ctx) const {
   auto it = table.find(id);
   if (it == table.end()) {
-    errs_loc() << "Symbol '" << id << "' is not defined.\n";
+    errs_loc(ctx) << "Symbol '" << id << "' is not defined.\n";
     ctx->inc_error_count();
     return nullptr;
   }
@@ -228,65 +231,103 @@ void ASTSymbolTable::insert_molecule_declarations(const ASTListNode* molecule_no
 }
 
 
+void ASTSymbolTable::get_sorted_symbols(std::vector<const IdToNodeMap::value_type*>& res) const {
+  res.clear();
+  res.reserve(table.size());
+  for (const auto& item: table) {
+    res.push_back(&item);
+  }
+  sort(res.begin(), res.end(),
+      [](const IdToNodeMap::value_type* a, const IdToNodeMap::value_type* b) {
+        return a->first < b->first;
+      }
+  );
+}
+
+
 void ASTSymbolTable::dump() {
   cout << "ASTSymbolTable:\n";
-  for (const auto& item: table) {
-    cout << IND2 << item.first << " = \n";
-    item.second->dump(IND4);
+  vector<const IdToNodeMap::value_type*> sorted_symbols;
+  get_sorted_symbols(sorted_symbols);
+  for (const auto* item: sorted_symbols) {
+    cout << IND2 << item->first << " = \n";
+    item->second->dump(IND4);
   }
 }
 
 
 // ------------------------------- ASTContext ----------------------------
-ParserContext::~ParserContext() {
+ASTNodeArena::~ASTNodeArena() {
+  // nodes own strings and vectors so their destructors must be called
+  for (ASTBaseNode* n: nodes) {
+    n->~ASTBaseNode();
+  }
+  nodes.clear();
 
-  for (ASTBaseNode* n: all_nodes) {
-    delete n;
+  for (char* block: blocks) {
+    delete [] block;
   }
-  all_nodes.clear();
+  blocks.clear();
+}
+
+
+void* ASTNodeArena::allocate(const size_t size, const size_t alignment) {
+  size_t padding = (alignment - (size_t)current % alignment) % alignment;
+  if (current == nullptr || padding + size > remaining) {
+    size_t block_size = std::max(size + alignment, AST_ARENA_BLOCK_SIZE);
+    blocks.push_back(new char[block_size]);
+    current = blocks.back();
+    remaining = block_size;
+    padding = (alignment - (size_t)current % alignment) % alignment;
+  }
+
+  void* res = current + padding;
+  current += padding + size;
+  remaining -= padding + size;
+  return res;
+}
+
+
+ParserContext::~ParserContext() {
+  // nodes are freed by the arena
 }
 
 
 ASTExprNode* ParserContext::new_id_node(const std::string& id, const BNGLLTYPE& loc) {
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_id(id);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTExprNode* ParserContext::new_dbl_node(const double val, const BNGLLTYPE& loc) {
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_dbl(val);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTExprNode* ParserContext::new_dbl_node(const double val, const ASTBaseNode* loc) {
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_dbl(val);
   n->set_loc(loc->file, loc->line);
-  remember_node(n);
   return n;
 }
 
 
 ASTExprNode* ParserContext::new_dbl_node(const double val) {
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_dbl(val);
   n->has_loc = false;
-  remember_node(n);
   return n;
 }
 
 ASTExprNode* ParserContext::new_llong_node(const long long val, const BNGLLTYPE& loc) {
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_llong(val);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
@@ -294,12 +335,11 @@ ASTExprNode* ParserContext::new_llong_node(const long long val, const BNGLLTYPE&
 ASTExprNode* ParserContext::new_expr_node(
     ASTExprNode* left, const ExprType op, ASTExprNode* right, const BNGLLTYPE& loc) {
   assert((op == ExprType::UnaryPlus || op == ExprType::UnaryMinus) == (right == nullptr));
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_left(left);
   n->set_type(op); // operator
   n->set_right(right);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
@@ -310,45 +350,40 @@ ASTExprNode* ParserContext::new_expr_node(
     const BNGLLTYPE& loc) {
 
   assert(function_name != "");
-  ASTExprNode* n = new ASTExprNode;
+  ASTExprNode* n = nodes.create<ASTExprNode>();
   n->set_type(ExprType::FunctionCall);
   n->set_function_name(function_name);
   n->set_function_arguments(arguments);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTStrNode* ParserContext::new_empty_str_node() {
-  ASTStrNode* n = new ASTStrNode;
+  ASTStrNode* n = nodes.create<ASTStrNode>();
   n->str = "";
-  remember_node(n);
   return n;
 }
 
 
 ASTStrNode* ParserContext::new_str_node(const std::string str, const BNGLLTYPE& loc) {
-  ASTStrNode* n = new ASTStrNode;
+  ASTStrNode* n = nodes.create<ASTStrNode>();
   n->str = str;
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTStrNode* ParserContext::new_str_node(const long long val_to_str, const BNGLLTYPE& loc) {
-  ASTStrNode* n = new ASTStrNode;
+  ASTStrNode* n = nodes.create<ASTStrNode>();
   n->str = to_string(val_to_str);
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTListNode* ParserContext::new_list_node() {
-  ASTListNode* n = new ASTListNode();
-  remember_node(n);
+  ASTListNode* n = nodes.create<ASTListNode>();
   return n;
 }
 
@@ -359,12 +394,11 @@ ASTComponentNode* ParserContext::new_component_node(
     ASTStrNode* bond,
     const BNGLLTYPE& loc
 ) {
-  ASTComponentNode* n = new ASTComponentNode();
+  ASTComponentNode* n = nodes.create<ASTComponentNode>();
   n->name = name;
   n->states = state_list;
   n->bond = bond;
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
@@ -375,12 +409,11 @@ ASTMolNode* ParserContext::new_molecule_node(
     ASTStrNode* compartment,
     const BNGLLTYPE& loc
 ) {
-  ASTMolNode* n = new ASTMolNode();
+  ASTMolNode* n = nodes.create<ASTMolNode>();
   n->name = name;
   n->components = component_list;
   n->compartment = compartment;
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
@@ -392,22 +425,20 @@ ASTCompartmentNode* ParserContext::new_compartment_node(
     const std::string parent_name,
     const BNGLLTYPE& loc
 ) {
-  ASTCompartmentNode* n = new ASTCompartmentNode();
+  ASTCompartmentNode* n = nodes.create<ASTCompartmentNode>();
   n->name = name;
   n->dimensions = dimensions;
   n->volume = volume;
   n->parent_name = parent_name;
   n->set_loc(current_file, loc);
-  remember_node(n);
   return n;
 }
 
 
 ASTCplxNode* ParserContext::new_cplx_node(ASTMolNode* first_mol) {
-  ASTCplxNode* n = new ASTCplxNode(first_mol);
+  ASTCplxNode* n = nodes.create<ASTCplxNode>(first_mol);
   n->set_loc(first_mol);
 
-  remember_node(n);
   return n;
 }
 
@@ -419,7 +450,7 @@ ASTRxnRuleNode* ParserContext::new_rxn_rule_node(
     ASTListNode* products,
     ASTListNode* rates
 ) {
-  ASTRxnRuleNode* n = new ASTRxnRuleNode();
+  ASTRxnRuleNode* n = nodes.create<ASTRxnRuleNode>();
   n->name = name->str;
   n->reactants = reactants;
   n->reversible = reversible;
@@ -431,7 +462,6 @@ ASTRxnRuleNode* ParserContext::new_rxn_rule_node(
   ASTCplxNode* cplx = to_cplx_node(reactants->items[0]);
   n->set_loc(cplx->mols[0]);
 
-  remember_node(n);
   return n;
 }
 
@@ -440,14 +470,13 @@ ASTSeedSpeciesNode* ParserContext::new_seed_species_node(
     ASTCplxNode* cplx,
     ASTExprNode* count
 ) {
-  ASTSeedSpeciesNode* n = new ASTSeedSpeciesNode();
+  ASTSeedSpeciesNode* n = nodes.create<ASTSeedSpeciesNode>();
   n->cplx = cplx;
   n->count = count;
 
   // use the first molecule of the complex as the location
   n->set_loc(cplx);
 
-  remember_node(n);
   return n;
 }
 
@@ -458,13 +487,12 @@ ASTObservableNode* ParserContext::new_observable_node(
     ASTListNode* cplx_patterns,
     const BNGLLTYPE& loc
 ) {
-  ASTObservableNode* n = new ASTObservableNode();
+  ASTObservableNode* n = nodes.create<ASTObservableNode>();
   n->type = type;
   n->name = name;
   n->cplx_patterns = cplx_patterns;
   n->set_loc(current_file, loc);
 
-  remember_node(n);
   return n;
 }
 
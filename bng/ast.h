@@ -18,6 +18,11 @@
  */
 
 #include <string>
+#include <vector>
+#include <unordered_set>
+#include <unordered_map>
+#include <new>
+#include <utility>
 
 #include "bng/bng_defines.h"
 
@@ -449,7 +454,8 @@ public:
 
 class ASTSymbolTable {
 public:
-  typedef std::map<std::string, ASTBaseNode*> IdToNodeMap;
+  // iteration order is not defined, use get_sorted_symbols when the order matters
+  typedef std::unordered_map<std::string, ASTBaseNode*> IdToNodeMap;
 
   void insert(const std::string id, ASTBaseNode* node, ParserContext* ctx);
   void insert_molecule_declarations(const ASTListNode* molecule_node_list, ParserContext* ctx);
@@ -457,6 +463,9 @@ public:
   // if symbol does was not defined, returns null and prints out error message
   ASTBaseNode* get(const std::string& id, ASTBaseNode* loc, ParserContext* ctx) const;
 
+  // returns all symbols sorted by their id
+  void get_sorted_symbols(std::vector<const IdToNodeMap::value_type*>& res) const;
+
   const IdToNodeMap& get_as_map() const {
     return table;
   }
@@ -473,18 +482,52 @@ private:
 };
 
 
+// monotonic allocator for AST nodes,
+// all nodes are destroyed and their memory is released at once
+class ASTNodeArena {
+public:
+  ASTNodeArena()
+    : current(nullptr), remaining(0) {
+  }
+  ~ASTNodeArena();
+
+  ASTNodeArena(const ASTNodeArena&) = delete;
+  ASTNodeArena& operator=(const ASTNodeArena&) = delete;
+
+  template<class T, class... Args>
+  T* create(Args&&... args) {
+    T* n = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    nodes.push_back(n);
+    return n;
+  }
+
+private:
+  void* allocate(const size_t size, const size_t alignment);
+
+  std::vector<char*> blocks;
+  char* current;
+  size_t remaining;
+
+  // for calling destructors
+  std::vector<ASTBaseNode*> nodes;
+};
+
+
 // contains and owns all created nodes
 // also contains symbol table
 class ParserContext {
 public:
   ParserContext()
     : single_cplx(nullptr), errors(0), eof_returned_as_newline(false),
-      current_file(nullptr) {
+      current_line(1), current_file(nullptr) {
   }
 
   // frees all owned nodes
   ~ ParserContext();
 
+  ParserContext(const ParserContext&) = delete;
+  ParserContext& operator=(const ParserContext&) = delete;
+
   // ------------- AST node manipulation -----------------
 
   ASTExprNode* new_id_node(const std::string& id, const BNGLLTYPE& loc);
@@ -618,6 +661,15 @@ public:
     return current_file;
   }
 
+  // line of the last token returned by the scanner, used to report errors
+  void set_current_line(const int line) {
+    current_line = line;
+  }
+
+  int get_current_line() const {
+    return current_line;
+  }
+
   void dump();
 
   // context owns all strings parsed as IDs
@@ -638,14 +690,10 @@ public:
 private:
   int errors;
   bool eof_returned_as_newline;
+  int current_line;
 
-  void remember_node(ASTBaseNode* n) {
-    assert(all_nodes.count(n) == 0 && "Cannot add one node twice to be deleted");
-    all_nodes.insert(n);
-  }
-
-  // set that contains all nodes, used to free up memory
-  std::set<ASTBaseNode*> all_nodes;
+  // owns all nodes
+  ASTNodeArena nodes;
 
   // all input file names are owned by this set and only pointers are passed around
   const char* current_file;
@@ -654,8 +702,9 @@ private:
 
   // container for all parsed strings,
   // with GLR parser we must not delete strings returned as the attribute of a token,
-  // so we must maintain them somewhere, should not have much impact on performance
-  std::set<std::string> parser_string_pool;
+  // so we must maintain them somewhere, each distinct string is stored only once,
+  // pointers to the elements are not invalidated by rehashing
+  std::unordered_set<std::string> parser_string_pool;
 };
 
 
@@ -670,6 +719,12 @@ static inline ASTExprNode* to_expr_node(ASTBaseNode* n) {
   return dynamic_cast<ASTExprNode*>(n);
 }
 
+static inline const ASTExprNode* to_expr_node(const ASTBaseNode* n) {
+  assert(n != nullptr);
+  assert(n->is_expr());
+  return dynamic_cast<const ASTExprNode*>(n);
+}
+
 static inline const ASTStrNode* to_str_node(const ASTBaseNode* n) {
   assert(n != nullptr);
   assert(n->is_str());
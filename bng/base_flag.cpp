@@ -22,6 +22,7 @@ std::string BaseSpeciesCplxMolFlag::to_str() const {
   FLAG_TO_STR(SPECIES_CPLX_MOL_FLAG_SURF)
   FLAG_TO_STR(SPECIES_CPLX_MOL_FLAG_REACTIVE_SURFACE)
   FLAG_TO_STR(SPECIES_CPLX_FLAG_ONE_MOL_NO_COMPONENTS)
+  FLAG_TO_STR(SPECIES_CPLX_FLAG_SINGLE_MOL_WO_EXPLICIT_BONDS)
   FLAG_TO_STR(SPECIES_FLAG_CAN_VOLVOL)
   FLAG_TO_STR(SPECIES_FLAG_CAN_VOLSURF)
   FLAG_TO_STR(SPECIES_FLAG_CAN_VOLWALL)
@@ -45,6 +45,10 @@ enum species_cplx_mol_rxn_flag_t {
   // the code that references them must be able to handle their deletion
   SPECIES_FLAG_IS_REMOVABLE = 0x2000,
 
+  // complex has a single elementary molecule whose components use only !+, !? or no bond,
+  // such patterns are matched without graph matching
+  SPECIES_CPLX_FLAG_SINGLE_MOL_WO_EXPLICIT_BONDS = 0x4000,
+
   SPECIES_FLAG_CAN_SURFSURFSURF = 0x20000, // not supported - TODO LATER: remove
   SPECIES_FLAG_SET_MAX_STEP_LENGTH = 0x80000, // not supported
 
@@ -23,6 +23,8 @@
 #include "bng/rxn_compartment_utils.h"
 #include "bng/species.h"
 #include "bng/parser.h"
+#include "bng/model_cache.h"
+#include "bng/net_importer.h"
 #include "bng/bngl_names.h"
 
 #endif // LIBS_BNG_H_
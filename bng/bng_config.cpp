@@ -42,6 +42,8 @@ void BNGConfig::dump() const {
   cout << "  grid_density: \t\t" << grid_density << "\n";
   cout << "  rx_radius_3d: \t\t" << rxn_radius_3d << "\n";
   cout << "  rxn_and_species_report: \t\t" << rxn_and_species_report << "\n";
+  cout << "  max_num_rxn_classes: \t\t" << max_num_rxn_classes << "\n";
+  cout << "  max_num_product_set_memo_entries: \t\t" << max_num_product_set_memo_entries << "\n";
   // TODO: add dumps for BNGNotificatiosn and BNGWarnings
 
   notifications.dump();
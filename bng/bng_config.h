@@ -97,6 +97,8 @@ public:
     rxn_radius_3d(0),
     intermembrane_rxn_radius_3d(0),
     rxn_and_species_report(true),
+    max_num_rxn_classes(0),
+    max_num_product_set_memo_entries(0),
 	  debug_requires_diffusion_constants(false)
     {
   }
@@ -130,6 +132,14 @@ public:
   // generate report files during simulation
   bool rxn_and_species_report;
 
+  // maximal number of rxn classes kept by RxnContainer after
+  // RxnContainer::evict_cold_rxn_classes is called, 0 means unlimited
+  uint max_num_rxn_classes;
+
+  // maximal number of entries kept in the product set memo of RxnContainer,
+  // the oldest entries are removed first, 0 means unlimited
+  uint max_num_product_set_memo_entries;
+
   // flag to enable debug assertions that check that diffusion constants are set
   // default is false
   bool debug_requires_diffusion_constants;
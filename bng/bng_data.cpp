@@ -52,36 +52,61 @@ double Compartment::get_volume_including_children(
 }
 
 
+// names may contain only alphanumeric characters and '_'
+static string get_component_type_key(const string& elem_mol_type_name, const string& component_name) {
+  return elem_mol_type_name + "(" + component_name;
+}
+
+
+static string get_rxn_rule_key(const RxnRule& rr) {
+  string res = rr.name;
+  for (const Cplx& c: rr.reactants) {
+    res += " " + c.name;
+  }
+  res += " ->";
+  for (const Cplx& c: rr.products) {
+    res += " " + c.name;
+  }
+  return res;
+}
+
+
 void BNGData::clear() {
   state_names.clear();
   component_types.clear();
   elem_mol_types.clear();
+  compartments.clear();
   rxn_rules.clear();
+  parameters.clear();
+  compiled_parameters.clear();
+  seed_species.clear();
+  observables.clear();
+
+  state_name_ids.clear();
+  component_type_ids.clear();
+  elem_mol_type_ids.clear();
+  compartment_ids.clear();
+  rxn_rule_ids.clear();
 }
 
 
 state_id_t BNGData::find_or_add_state_name(const std::string& s) {
-  // rather inefficient search but most probably sufficient for now
-  for (state_id_t i = 0; i < state_names.size(); i++) {
-    if (state_names[i] == s) {
-      return i;
-    }
+  auto res = state_name_ids.insert(make_pair(s, (state_id_t)state_names.size()));
+  if (res.second) {
+    // not found
+    state_names.push_back(s);
   }
-
-  // not found
-  state_names.push_back(s);
-  return state_names.size() - 1;
+  return res.first->second;
 }
 
 
 // may return STATE_ID_INVALID when the name was not found
 state_id_t BNGData::find_state_id(const std::string& name) const {
-  for (state_id_t i = 0; i < state_names.size(); i++) {
-    if (state_names[i] == name) {
-      return i;
-    }
+  auto it = state_name_ids.find(name);
+  if (it == state_name_ids.end()) {
+    return STATE_ID_INVALID;
   }
-  return ELEM_MOL_TYPE_ID_INVALID;
+  return it->second;
 }
 
 
@@ -89,37 +114,38 @@ component_type_id_t BNGData::find_or_add_component_type(
     const ComponentType& ct,
     const bool merge_allowed_states) {
   assert(ct.elem_mol_type_name != "");
-  for (component_type_id_t i = 0; i < component_types.size(); i++) {
-    if (component_types[i].elem_mol_type_name == ct.elem_mol_type_name &&
-        component_types[i].name == ct.name) {
-
-      if (!merge_allowed_states) {
-        // check that the allowed_state_ids is equal or a subset
-        if (std::includes(
-            component_types[i].allowed_state_ids.begin(),
-            component_types[i].allowed_state_ids.end(),
-            ct.allowed_state_ids.begin(),
-            ct.allowed_state_ids.end()
-        )) {
-          return i;
-        }
-        else {
-          return COMPONENT_TYPE_ID_INVALID;
-        }
+  string key = get_component_type_key(ct.elem_mol_type_name, ct.name);
+  auto it = component_type_ids.find(key);
+  if (it != component_type_ids.end()) {
+    component_type_id_t i = it->second;
+    if (!merge_allowed_states) {
+      // check that the allowed_state_ids is equal or a subset
+      if (std::includes(
+          component_types[i].allowed_state_ids.begin(),
+          component_types[i].allowed_state_ids.end(),
+          ct.allowed_state_ids.begin(),
+          ct.allowed_state_ids.end()
+      )) {
+        return i;
       }
       else {
-        // merge allowed states and return current id
-        component_types[i].allowed_state_ids.insert(
-            ct.allowed_state_ids.begin(),
-            ct.allowed_state_ids.end());
-        return i;
+        return COMPONENT_TYPE_ID_INVALID;
       }
     }
+    else {
+      // merge allowed states and return current id
+      component_types[i].allowed_state_ids.insert(
+          ct.allowed_state_ids.begin(),
+          ct.allowed_state_ids.end());
+      return i;
+    }
   }
 
   // not found
+  component_type_id_t id = component_types.size();
   component_types.push_back(ct);
-  return component_types.size() - 1;
+  component_type_ids[key] = id;
+  return id;
 }
 
 
@@ -144,21 +170,21 @@ elem_mol_type_id_t BNGData::find_or_add_elem_mol_type(const ElemMolType& mt) {
   }
 
   // not found
+  elem_mol_type_id_t id = elem_mol_types.size();
   elem_mol_types.push_back(mt);
   elem_mol_types.back().set_finalized();
-  return elem_mol_types.size() - 1;
+  elem_mol_type_ids[mt.name] = id;
+  return id;
 }
 
 
 // may return MOLECULE_TYPE_ID_INVALID when the name was not found
 elem_mol_type_id_t BNGData::find_elem_mol_type_id(const std::string& name) const {
-  for (elem_mol_type_id_t i = 0; i < elem_mol_types.size(); i++) {
-    const ElemMolType& mt = elem_mol_types[i];
-    if (mt.name == name) {
-      return i;
-    }
+  auto it = elem_mol_type_ids.find(name);
+  if (it == elem_mol_type_ids.end()) {
+    return ELEM_MOL_TYPE_ID_INVALID;
   }
-  return ELEM_MOL_TYPE_ID_INVALID;
+  return it->second;
 }
 
 
@@ -170,6 +196,7 @@ compartment_id_t BNGData::add_compartment(const Compartment& c) {
   compartment_id_t id = compartments.size();
   compartments.push_back(c);
   compartments.back().id = id;
+  compartment_ids[c.name] = id;
   return id;
 }
 
@@ -181,12 +208,11 @@ compartment_id_t BNGData::find_compartment_id(const std::string& name) const {
     return in_out_id;
   }
 
-  for (compartment_id_t i = 0; i < compartments.size(); i++) {
-    if (compartments[i].name == name) {
-      return i;
-    }
+  auto it = compartment_ids.find(name);
+  if (it == compartment_ids.end()) {
+    return COMPARTMENT_ID_INVALID;
   }
-  return COMPARTMENT_ID_INVALID;
+  return it->second;
 }
 
 
@@ -254,9 +280,11 @@ void BNGData::get_compartments_sorted_by_parents_first(
 rxn_rule_id_t BNGData::find_or_add_rxn_rule(const RxnRule& rr) {
   // TODO LATER: check that if there is a reaction with the same
   //       reactants and products that the reaction rate is the same
-  for (rxn_rule_id_t i = 0; i < rxn_rules.size(); i++) {
-    if (rxn_rules[i] == rr) {
-      return i;
+  string key = get_rxn_rule_key(rr);
+  auto range = rxn_rule_ids.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (rxn_rules[it->second] == rr) {
+      return it->second;
     }
   }
 
@@ -264,6 +292,7 @@ rxn_rule_id_t BNGData::find_or_add_rxn_rule(const RxnRule& rr) {
   rxn_rule_id_t id = rxn_rules.size();
   rxn_rules.push_back(rr);
   rxn_rules.back().id = id;
+  rxn_rule_ids.insert(make_pair(key, id));
   return id;
 }
 
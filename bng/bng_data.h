@@ -10,10 +10,13 @@
 #ifndef LIBS_BNG_BNG_DATA_H_
 #define LIBS_BNG_BNG_DATA_H_
 
+#include <unordered_map>
+
 #include "bng/bng_defines.h"
 #include "bng/elem_mol_type.h"
 #include "bng/rxn_rule.h"
 #include "bng/cplx.h"
+#include "bng/compiled_expr.h"
 
 namespace BNG {
 
@@ -114,6 +117,9 @@ public:
  * Usually constant, initialized when BNGL is parsed
  */
 class BNGData {
+  friend class ModelCacheWriter;
+  friend class ModelCacheReader;
+
 private:
   // indexed with state_id_t
   std::vector<std::string> state_names;
@@ -138,6 +144,10 @@ private:
   // keeping for cases when the parameter values might be needed for other purposes
   std::map<std::string, double> parameters;
 
+  // definitions of parameters and rate constants,
+  // allow to change parameter values without parsing the model again
+  CompiledParameters compiled_parameters;
+
   // contents of the seed species section
   // not used directly but can be converted to other representations
   std::vector<SeedSpecies> seed_species;
@@ -146,6 +156,16 @@ private:
   // not used directly but can be converted to other representations
   std::vector<Observable> observables;
 
+  // name indices so that lookups do not depend on the model size
+  std::unordered_map<std::string, state_id_t> state_name_ids;
+  // key is elem mol type name and component name, see get_component_type_key
+  std::unordered_map<std::string, component_type_id_t> component_type_ids;
+  std::unordered_map<std::string, elem_mol_type_id_t> elem_mol_type_ids;
+  std::unordered_map<std::string, compartment_id_t> compartment_ids;
+  // key is rxn rule name and canonical names of its reactants and products,
+  // rules with the same key must be still compared
+  std::unordered_multimap<std::string, rxn_rule_id_t> rxn_rule_ids;
+
 public:
   void clear();
 
@@ -287,6 +307,21 @@ public:
     return parameters;
   }
 
+  CompiledParameters& get_compiled_parameters() {
+    return compiled_parameters;
+  }
+
+  // sets new parameter values and re-evaluates parameters and rate constants of
+  // rxn rules that depend on them, see CompiledParameters::update,
+  // ids of rxn rules whose rate constant changed are stored into updated_rxn_rule_ids
+  // returns number of errors
+  int update_parameters(
+      const std::map<std::string, double>& parameter_overrides,
+      std::vector<rxn_rule_id_t>& updated_rxn_rule_ids) {
+    updated_rxn_rule_ids.clear();
+    return compiled_parameters.update(parameter_overrides, parameters, rxn_rules, updated_rxn_rule_ids);
+  }
+
   // -------- utilities --------
   void dump() const;
 
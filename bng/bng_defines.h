@@ -54,10 +54,16 @@ const uint MAX_PRODUCT_SETS_PER_RXN = 1024*1024;
 // because the time interval between molecule creation and such unimol reaction is close to 0
 const double MAX_UNIMOL_RXN_PROBABILITY = 1e8;
 
-// if the count of products after applying a single rxn is greater ahan this value
-// and we know the count of the product, do not compute the products immediatelly
+// if the count of products after applying a single rxn is greater than this value
+// and we know the count of the product, species of the products are not defined immediatelly
+// but once the pathway is used, this determines the order in which new species are created,
+// when the products themselves are computed is decided by RxnClass's lazy product policy
 const uint MAX_IMMEDIATELLY_COMPUTED_PRODUCT_SETS_PER_RXN = 8;
 
+// rxn classes are allocated from blocks of this size owned by RxnContainer,
+// blocks are never moved or freed until the container is destroyed
+const uint RXN_CLASS_POOL_BLOCK_SIZE = 256;
+
 typedef uint state_id_t;
 const state_id_t STATE_ID_INVALID = UINT32_MAX;
 
@@ -144,6 +150,10 @@ const reactant_class_id_t REACTANT_CLASS_ID_INVALID = ID_INVALID;
 
 typedef uint_set<reactant_class_id_t> ReactantClassIdSet;
 
+// ids of rxn classes are dense and are reused once a rxn class is deleted
+typedef uint rxn_class_id_t;
+const rxn_class_id_t RXN_CLASS_ID_INVALID = ID_INVALID;
+
 const char PATH_SEPARATOR =
 #ifdef _WIN64
                             '\\';
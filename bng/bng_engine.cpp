@@ -13,20 +13,41 @@
 #include "bng/bng_engine.h"
 #include "bng/bngl_names.h"
 
-#define BOOST_POOL_NO_MT
-#include <boost/pool/pool_alloc.hpp>
-#undef BOOST_POOL_NO_MT
-
 using namespace std;
 
 namespace BNG {
 
 
-void BNGEngine::initialize() {
+void BNGEngine::initialize(const uint num_threads) {
   // insert information on rxn rules into rxn container
-  for (const RxnRule& r: data.get_rxn_rules()) {
-    all_rxns.add_and_finalize(r);
+  all_rxns.add_and_finalize(data.get_rxn_rules(), rxn_rule_ids_from_data, num_threads);
+
+  // observable patterns are also used to decide whether a species matches a reactant
+  ReactantPatternTable& patterns = all_rxns.get_reactant_pattern_table();
+  for (const Observable& o: data.get_observables()) {
+    for (const Cplx& pattern: o.patterns) {
+      patterns.add_pattern(pattern);
+    }
   }
+  patterns.compute_subsumption();
+}
+
+
+int BNGEngine::update_parameters(const std::map<std::string, double>& parameter_overrides) {
+  vector<rxn_rule_id_t> updated_rxn_rule_ids;
+  int num_errors = data.update_parameters(parameter_overrides, updated_rxn_rule_ids);
+
+  for (rxn_rule_id_t data_id: updated_rxn_rule_ids) {
+    if (data_id >= rxn_rule_ids_from_data.size()) {
+      // initialize was not called yet
+      continue;
+    }
+    RxnRule* rxn = all_rxns.get(rxn_rule_ids_from_data[data_id]);
+    // rxn classes that use this rule update their probabilities
+    rxn->update_rxn_rate(data.get_rxn_rules()[data_id].base_rate_constant);
+  }
+
+  return num_errors;
 }
 
 string BNGEngine::get_stats_report() const {
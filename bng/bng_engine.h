@@ -38,6 +38,9 @@ private:
   // data entered by user, reactions reference these data
   BNGData data;
 
+  // ids of rxn rules in all_rxns created by initialize, indexed by rxn rule id in data
+  std::vector<rxn_rule_id_t> rxn_rule_ids_from_data;
+
   const BNGConfig& bng_config;
 
 public:
@@ -48,8 +51,23 @@ public:
   }
 
   // is the bnglib is used directly with the output of
-  // bng_data, one needs to call initialize to update contents of the RxnContainer
-  void initialize();
+  // bng_data, one needs to call initialize to update contents of the RxnContainer,
+  // rxn rules are finalized in parallel with num_threads, the result does not depend on it
+  void initialize(const uint num_threads = 1);
+
+  // sets new values of parameters of a parsed model without parsing it again
+  // (e.g. for parameter sweeps), the values are applied as with parameter_overrides
+  // of parse_bngl_file, overrides from the previous call are not kept,
+  // - rate constants of rxn rules that depend on changed parameters are updated
+  //   and only probabilities of rxn classes that use these rules are recomputed,
+  //   species and rxn products are kept,
+  // - parameters overridden when the model was parsed get the value from their definition
+  //   in the model unless they are overridden again, parameters that are not defined
+  //   in the model keep the value of their parse-time override,
+  // - counts of seed species and volumes of compartments are not re-evaluated,
+  //   they keep the values computed when the model was parsed,
+  // - returns number of errors, errors are printed to the error output
+  int update_parameters(const std::map<std::string, double>& parameter_overrides);
 
   std::string get_stats_report() const;
 
@@ -14,6 +14,12 @@
 // for top of bngl_parser.hpp
 %code requires {      
 #include "bng/ast.h"
+
+// scanner state, defined also in the flex-generated header
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
 }
 
 // for top of bngl_parser.cpp
@@ -21,15 +27,10 @@
 #include "bng/ast.h"
 }
 
-// for bngl_parser.hpp
+// for bngl_parser.hpp, type names used by the flex scanner
 %code provides {
-    
-namespace BNG {
-  void create_parser_context();
-  ParserContext* get_parser_context();
-  void delete_parser_context();
-}
-
+#define YYSTYPE BNGLSTYPE
+#define YYLTYPE BNGLLTYPE
 }
 
 // for bngl_parser.cpp
@@ -39,15 +40,15 @@ namespace BNG {
   #include <string>
   #include "bng/parser_utils.h"
   #include "bng/bngl_names.h"
-    
+%}
+
+// for bngl_parser.cpp, after the value and location types are defined
+%code {
   // Declare stuff from Flex that Bison needs to know about:
-  extern int bngllex();
-  
-  void bnglerror(char const *s);
+  extern int bngllex(BNGLSTYPE* lvalp, BNGLLTYPE* llocp, yyscan_t scanner);
 
-  // global context used during parsing
-  BNG::ParserContext* g_ctx;
-%}
+  void bnglerror(const BNGLLTYPE* llocp, yyscan_t scanner, BNG::ParserContext* ctx, char const *s);
+}
 
 
 %require "3.0"
@@ -69,6 +70,12 @@ namespace BNG {
 // extend yylval (bngllval) with the possibility to store line)
 %locations
 
+// the parser is reentrant, there is no global state,
+// scanner and the context that owns the AST are passed explicitly
+%define api.pure
+%lex-param {yyscan_t scanner}
+%parse-param {yyscan_t scanner} {BNG::ParserContext* ctx}
+
 // One shift-reduce conflict is expected, the reason is that 
 // the beginning of the molecule types section is resolved
 // only after the first molecule type declaration is parsed as shown here.
@@ -168,7 +175,7 @@ start_bngl:
       nls_maybe_empty model_sections_list_maybe_empty // default mode to parse BNGL file
       
     | TOK_SINGLE_CPLX cplx TOK_NL {  // single complex to be parsed, prefixed by a unique string, scanner adds a newline
-    	g_ctx->single_cplx = $2;
+    	ctx->single_cplx = $2;
     }
 ;
 
@@ -210,7 +217,7 @@ section_list:
 section:
       TOK_BEGIN TOK_PARAMETERS nls parameter_list_maybe_empty TOK_END TOK_PARAMETERS
     | TOK_BEGIN TOK_MOLECULE TOK_TYPES nls molecule_types_list_maybe_empty TOK_END TOK_MOLECULE TOK_TYPES{
-        g_ctx->symtab.insert_molecule_declarations($5, g_ctx);
+        ctx->symtab.insert_molecule_declarations($5, ctx);
       }
     | TOK_BEGIN TOK_COMPARTMENTS nls compartment_list_maybe_empty TOK_END TOK_COMPARTMENTS
     | TOK_BEGIN TOK_REACTION TOK_RULES nls rxn_rule_list_maybe_empty TOK_END TOK_REACTION TOK_RULES 
@@ -234,10 +241,10 @@ parameter_list:
       
 parameter:
       TOK_ID expr nls {
-        g_ctx->symtab.insert($1, $2, g_ctx);
+        ctx->symtab.insert($1, $2, ctx);
       }
     | TOK_ID '=' expr nls {
-        g_ctx->symtab.insert($1, $3, g_ctx);
+        ctx->symtab.insert($1, $3, ctx);
       }
     | error nls
 ;
@@ -246,7 +253,7 @@ parameter:
 molecule_types_list_maybe_empty:
       molecule_types_list
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;
 
@@ -257,28 +264,28 @@ molecule_types_list:
         $$ = $1;
       }
     | molecule_type {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
 // fully general specification, might contain information on bonds, checked later in semantic checks 
 molecule_type:
       TOK_ID '(' component_type_list_maybe_empty ')' nls {
-        $$ = g_ctx->new_molecule_node($1, $3, nullptr, @1);    
+        $$ = ctx->new_molecule_node($1, $3, nullptr, @1);    
       }
     | TOK_ID nls {
         // no components neither parentheses
-        $$ = g_ctx->new_molecule_node($1, g_ctx->new_list_node(), nullptr, @1);    
+        $$ = ctx->new_molecule_node($1, ctx->new_list_node(), nullptr, @1);    
       }
     | error nls {
-        $$ = g_ctx->new_molecule_node(SYNTAX_ERROR, g_ctx->new_list_node(), nullptr, @1);
+        $$ = ctx->new_molecule_node(SYNTAX_ERROR, ctx->new_list_node(), nullptr, @1);
       }
 ;
 
 component_type_list_maybe_empty:
       component_type_list
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;
 
@@ -288,20 +295,20 @@ component_type_list:
         $$ = $1;
       }
     | component_type {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
 component_type:
       TOK_ID component_type_state_list_maybe_empty {
-        $$ = g_ctx->new_component_node($1, $2, g_ctx->new_empty_str_node(), @1);
+        $$ = ctx->new_component_node($1, $2, ctx->new_empty_str_node(), @1);
       }
 ; 
 
 component_type_state_list_maybe_empty:
       component_type_state_list
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;
     
@@ -311,16 +318,16 @@ component_type_state_list:
         $$ = $1;
       }
     | component_state {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
 component_state:
       '~' TOK_ID {
-        $$ = g_ctx->new_str_node($2, @2);
+        $$ = ctx->new_str_node($2, @2);
       }
     | '~' TOK_LLONG {
-        $$ = g_ctx->new_str_node($2, @2);
+        $$ = ctx->new_str_node($2, @2);
       }
 ;
 
@@ -338,13 +345,13 @@ compartment_list:
 
 compartment_decl:
       TOK_ID TOK_LLONG expr TOK_ID nls {
-        g_ctx->add_compartment(
-            g_ctx->new_compartment_node($1, $2, $3, $4, @1)
+        ctx->add_compartment(
+            ctx->new_compartment_node($1, $2, $3, $4, @1)
         );
     }
     | TOK_ID TOK_LLONG expr nls {
-        g_ctx->add_compartment(
-            g_ctx->new_compartment_node($1, $2, $3, "", @1)
+        ctx->add_compartment(
+            ctx->new_compartment_node($1, $2, $3, "", @1)
         );
     }
     | error nls
@@ -364,18 +371,18 @@ rxn_rule_list:
 rxn_rule:
       rxn_rule_name_maybe_empty rxn_rule_side rxn_rule_direction rxn_rule_side_or_zero rates nls {
          
-        BNG::ASTRxnRuleNode* n = g_ctx->new_rxn_rule_node($1, $2, $3, $4, $5);
-        g_ctx->add_rxn_rule(n);
+        BNG::ASTRxnRuleNode* n = ctx->new_rxn_rule_node($1, $2, $3, $4, $5);
+        ctx->add_rxn_rule(n);
       }
     | error nls
 ;
 
 rxn_rule_name_maybe_empty:
       TOK_ID ':' {
-        $$ = g_ctx->new_str_node($1, @1);
+        $$ = ctx->new_str_node($1, @1);
       }
     | /* empty */ {
-        $$ = g_ctx->new_empty_str_node();
+        $$ = ctx->new_empty_str_node();
     }
 ;    
 
@@ -383,12 +390,12 @@ rxn_rule_side_or_zero:
       rxn_rule_side
     | TOK_LLONG {
         if ($1 != 0) {
-          bnglerror("Unexpected constant on the right-hand side of a reaction, only '0' is accepted.");
+          bnglerror(&@1, scanner, ctx, "Unexpected constant on the right-hand side of a reaction, only '0' is accepted.");
         }
         // 0 is the same as molecule Thrash, we will create a complex with a single molecule
-        $$ = g_ctx->new_list_node()->append( 
-               g_ctx->new_cplx_node(
-        	       g_ctx->new_molecule_node(BNG::COMPLEX_ZERO, g_ctx->new_list_node(), nullptr, @1)
+        $$ = ctx->new_list_node()->append( 
+               ctx->new_cplx_node(
+        	       ctx->new_molecule_node(BNG::COMPLEX_ZERO, ctx->new_list_node(), nullptr, @1)
         	     )
        	);
       }
@@ -400,7 +407,7 @@ rxn_rule_side:
         $$ = $1;
       }
     | cplx {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
@@ -419,7 +426,7 @@ rates:
          $$ = $1; 
       }
     | expr {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
@@ -437,8 +444,8 @@ seed_species_list:
 
 seed_species_item:
       cplx expr nls {
-        BNG::ASTSeedSpeciesNode* n = g_ctx->new_seed_species_node($1, $2); 
-        g_ctx->add_seed_species(n);
+        BNG::ASTSeedSpeciesNode* n = ctx->new_seed_species_node($1, $2); 
+        ctx->add_seed_species(n);
       }
     | error nls
 ;
@@ -453,7 +460,7 @@ cplx:
 
 compartment_for_cplx_maybe_empty:
       '@' TOK_ID ':' {
-        $$ = g_ctx->new_str_node($2, @2);
+        $$ = ctx->new_str_node($2, @2);
       }
     | /* empty */ {
         $$ = nullptr;
@@ -466,23 +473,23 @@ cplx_no_compartment:
         $$ = $1;
       }
     | molecule_instance {
-        $$ = g_ctx->new_cplx_node($1);
+        $$ = ctx->new_cplx_node($1);
       }
 ;
 
 molecule_instance:
       TOK_ID '(' component_instance_list_maybe_empty ')' molecule_compartment {
-        $$ = g_ctx->new_molecule_node($1, $3, $5, @1);    
+        $$ = ctx->new_molecule_node($1, $3, $5, @1);    
       }
     | TOK_ID molecule_compartment {
         // no components neither parentheses
-        $$ = g_ctx->new_molecule_node($1, g_ctx->new_list_node(), $2, @1);    
+        $$ = ctx->new_molecule_node($1, ctx->new_list_node(), $2, @1);    
       }
 ;
 
 molecule_compartment:
       '@' TOK_ID {
-        $$ = g_ctx->new_str_node($2, @2);
+        $$ = ctx->new_str_node($2, @2);
       }
     | /* empty */ {
         $$ = nullptr;
@@ -492,7 +499,7 @@ molecule_compartment:
 component_instance_list_maybe_empty:
       component_instance_list
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;
 
@@ -502,40 +509,40 @@ component_instance_list:
         $$ = $1;
       }
     | component_instance {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;
 
 component_instance:
       TOK_ID component_instance_state_maybe_empty bond_instance_maybe_empty {
-        $$ = g_ctx->new_component_node($1, $2, $3, @1);
+        $$ = ctx->new_component_node($1, $2, $3, @1);
       }
 ; 
 
 component_instance_state_maybe_empty:
       '~' TOK_ID {
-        $$ = g_ctx->new_list_node()->append(g_ctx->new_str_node($2, @2));
+        $$ = ctx->new_list_node()->append(ctx->new_str_node($2, @2));
       }
     | '~' TOK_LLONG {
-        $$ = g_ctx->new_list_node()->append(g_ctx->new_str_node($2, @2));
+        $$ = ctx->new_list_node()->append(ctx->new_str_node($2, @2));
       }
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;
 
 bond_instance_maybe_empty:
       '!' TOK_LLONG {
-        $$ = g_ctx->new_str_node($2, @2);
+        $$ = ctx->new_str_node($2, @2);
       }
     | '!' '+' {
-        $$ = g_ctx->new_str_node(BNG::BOND_STR_BOUND, @2);
+        $$ = ctx->new_str_node(BNG::BOND_STR_BOUND, @2);
       }
     | '!' '?' {
-        $$ = g_ctx->new_str_node(BNG::BOND_STR_ANY, @2);
+        $$ = ctx->new_str_node(BNG::BOND_STR_ANY, @2);
       }      
     | /* empty */ {
-        $$ = g_ctx->new_empty_str_node();
+        $$ = ctx->new_empty_str_node();
     }
 ;
    
@@ -554,8 +561,8 @@ observables_list:
       
 observables_item:
       TOK_ID TOK_ID cplx_list nls {
-        BNG::ASTObservableNode* n = g_ctx->new_observable_node($1, $2, $3, @1); 
-        g_ctx->add_observable(n);
+        BNG::ASTObservableNode* n = ctx->new_observable_node($1, $2, $3, @1); 
+        ctx->add_observable(n);
       }
     | error nls    
 ;
@@ -568,7 +575,7 @@ cplx_list:
         $1->append($2);
       }
     | cplx {
-    	$$ = g_ctx->new_list_node()->append($1);
+    	$$ = ctx->new_list_node()->append($1);
       }
       
 // ---------------- action calls ------------------
@@ -640,18 +647,18 @@ expr_or_str:
       
 // ---------------- expressions --------------------- 
 expr:
-      TOK_ID                        { $$ = g_ctx->new_id_node($1, @1); } 
-    | TOK_DBL                       { $$ = g_ctx->new_dbl_node($1, @1); } 
-    | TOK_LLONG                     { $$ = g_ctx->new_llong_node($1, @1); }
+      TOK_ID                        { $$ = ctx->new_id_node($1, @1); } 
+    | TOK_DBL                       { $$ = ctx->new_dbl_node($1, @1); } 
+    | TOK_LLONG                     { $$ = ctx->new_llong_node($1, @1); }
     | '(' expr ')'                  { $$ = $2; } 
-    | expr '+' expr                 { $$ = g_ctx->new_expr_node($1, BNG::ExprType::Add, $3, @2); }
-    | expr '-' expr                 { $$ = g_ctx->new_expr_node($1, BNG::ExprType::Sub, $3, @2); }
-    | expr '*' expr                 { $$ = g_ctx->new_expr_node($1, BNG::ExprType::Mul, $3, @2); }
-    | expr '/' expr                 { $$ = g_ctx->new_expr_node($1, BNG::ExprType::Div, $3, @2); }
-    | expr '^' expr                 { $$ = g_ctx->new_expr_node($1, BNG::ExprType::Pow, $3, @2); }
-    | '+' expr %prec UNARYPLUS      { $$ = g_ctx->new_expr_node($2, BNG::ExprType::UnaryPlus, nullptr, @1); }
-    | '-' expr %prec UNARYMINUS     { $$ = g_ctx->new_expr_node($2, BNG::ExprType::UnaryMinus, nullptr, @1); }
-    | TOK_ID '(' expr_list_maybe_empty ')'  { $$ = g_ctx->new_expr_node($1, $3, @1); }
+    | expr '+' expr                 { $$ = ctx->new_expr_node($1, BNG::ExprType::Add, $3, @2); }
+    | expr '-' expr                 { $$ = ctx->new_expr_node($1, BNG::ExprType::Sub, $3, @2); }
+    | expr '*' expr                 { $$ = ctx->new_expr_node($1, BNG::ExprType::Mul, $3, @2); }
+    | expr '/' expr                 { $$ = ctx->new_expr_node($1, BNG::ExprType::Div, $3, @2); }
+    | expr '^' expr                 { $$ = ctx->new_expr_node($1, BNG::ExprType::Pow, $3, @2); }
+    | '+' expr %prec UNARYPLUS      { $$ = ctx->new_expr_node($2, BNG::ExprType::UnaryPlus, nullptr, @1); }
+    | '-' expr %prec UNARYMINUS     { $$ = ctx->new_expr_node($2, BNG::ExprType::UnaryMinus, nullptr, @1); }
+    | TOK_ID '(' expr_list_maybe_empty ')'  { $$ = ctx->new_expr_node($1, $3, @1); }
 ;
    
 expr_list_maybe_empty:
@@ -659,7 +666,7 @@ expr_list_maybe_empty:
         $$ = $1;
       }
     | /* empty */ {
-        $$ = g_ctx->new_list_node();
+        $$ = ctx->new_list_node();
       }
 ;    
 
@@ -669,31 +676,14 @@ expr_list:
         $$ = $1;
       }
     | expr {
-        $$ = g_ctx->new_list_node()->append($1);
+        $$ = ctx->new_list_node()->append($1);
       }
 ;    
  
     
 %%
 
-void bnglerror(char const *s) {
-  BNG::errs_loc() << s << "\n";
-  g_ctx->inc_error_count();
-}
-
-namespace BNG {
-void create_parser_context() {
-  assert(g_ctx == nullptr);
-  g_ctx = new ParserContext();
-}
-
-ParserContext* get_parser_context() {
-  return g_ctx;
-}
-
-void delete_parser_context() {
-  delete g_ctx;
-  g_ctx = nullptr;
+void bnglerror(const BNGLLTYPE* llocp, yyscan_t scanner, BNG::ParserContext* ctx, char const *s) {
+  BNG::errs_loc(ctx) << s << "\n";
+  ctx->inc_error_count();
 }
-
-}
\ No newline at end of file
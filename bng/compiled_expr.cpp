@@ -0,0 +1,244 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#include <cmath>
+#include <iostream>
+
+#include "bng/compiled_expr.h"
+#include "bng/rxn_rule.h"
+
+using namespace std;
+
+namespace BNG {
+
+static double bngl_max(const double a, const double b) {
+  return (a<b)?b:a;
+}
+
+static double bngl_min(const double a, const double b) {
+  return !(b<a)?a:b;
+}
+
+// TODO: check allowed argument ranges e.g. for asin
+// TODO: only the intersection of MDL and BNGL functions is supported now, some BNGL functios are missing
+static const BnglFunctionInfo bngl_function_infos[] = {
+  { "sqrt", 1, sqrt, nullptr },
+  { "exp", 1, exp, nullptr },
+  { "ln", 1, log, nullptr },
+  { "log10", 1, log10, nullptr },
+  { "sin", 1, sin, nullptr },
+  { "cos", 1, cos, nullptr },
+  { "tan", 1, tan, nullptr },
+  { "asin", 1, asin, nullptr },
+  { "acos", 1, acos, nullptr },
+  { "atan", 1, atan, nullptr },
+  { "abs", 1, fabs, nullptr },
+  { "ceil", 1, ceil, nullptr },
+  { "floor", 1, floor, nullptr },
+  { "max", 2, nullptr, bngl_max },
+  { "min", 2, nullptr, bngl_min }
+};
+
+
+const BnglFunctionInfo* find_bngl_function_info(const std::string& name) {
+  for (const BnglFunctionInfo& info: bngl_function_infos) {
+    if (name == info.name) {
+      return &info;
+    }
+  }
+  return nullptr;
+}
+
+
+bool CompiledExpr::evaluate(const std::vector<double>& param_values, double& res) const {
+  bool ok = true;
+  std::vector<double> stack;
+  stack.reserve(code.size());
+
+  for (const CompiledExprInstr& instr: code) {
+    switch (instr.op) {
+      case CompiledExprOp::Const:
+        stack.push_back(instr.value);
+        break;
+      case CompiledExprOp::Param:
+        assert(instr.param_index < param_values.size());
+        stack.push_back(param_values[instr.param_index]);
+        break;
+      case CompiledExprOp::UnaryMinus:
+        stack.back() = -stack.back();
+        break;
+      case CompiledExprOp::FunctionCall: {
+        // arguments are the topmost values on the stack, the last argument is on top
+        uint num_args = instr.func->num_arguments;
+        assert(num_args <= 2 && stack.size() >= num_args);
+        double args[2];
+        for (int i = num_args - 1; i >= 0; i--) {
+          args[i] = stack.back();
+          stack.pop_back();
+        }
+        stack.push_back(instr.func->evaluate(args));
+        break;
+      }
+      default: {
+        // binary operators
+        assert(stack.size() >= 2);
+        double right = stack.back();
+        stack.pop_back();
+        double& left = stack.back();
+        switch (instr.op) {
+          case CompiledExprOp::Add:
+            left = left + right;
+            break;
+          case CompiledExprOp::Sub:
+            left = left - right;
+            break;
+          case CompiledExprOp::Mul:
+            left = left * right;
+            break;
+          case CompiledExprOp::Div:
+            if (right == 0) {
+              ok = false;
+              left = 0;
+            }
+            else {
+              left = left / right;
+            }
+            break;
+          case CompiledExprOp::Pow:
+            left = pow(left, right);
+            break;
+          default:
+            release_assert(false && "Invalid operator");
+        }
+      }
+    }
+  }
+
+  assert(stack.size() == 1);
+  res = stack.back();
+  return ok;
+}
+
+
+bool CompiledExpr::uses_any_param(const std::vector<bool>& param_flags) const {
+  for (const CompiledExprInstr& instr: code) {
+    if (instr.op == CompiledExprOp::Param && param_flags[instr.param_index]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void CompiledParameters::clear() {
+  names.clear();
+  exprs.clear();
+  values.clear();
+  parameter_indices.clear();
+  rate_exprs.clear();
+  applied_overrides.clear();
+}
+
+
+uint CompiledParameters::add_parameter(const std::string& name, const CompiledExpr& expr, const double value) {
+  assert(parameter_indices.count(name) == 0);
+  uint index = names.size();
+  names.push_back(name);
+  exprs.push_back(expr);
+  values.push_back(value);
+  parameter_indices[name] = index;
+  return index;
+}
+
+
+void CompiledParameters::set_rxn_rule_rate_expr(const rxn_rule_id_t id, const CompiledExpr& expr) {
+  if (id >= rate_exprs.size()) {
+    rate_exprs.resize(id + 1);
+  }
+  if (rate_exprs[id].empty()) {
+    rate_exprs[id] = expr;
+  }
+}
+
+
+int CompiledParameters::update(
+    const std::map<std::string, double>& parameter_overrides,
+    std::map<std::string, double>& parameter_values,
+    std::vector<RxnRule>& rxn_rules,
+    std::vector<rxn_rule_id_t>& updated_rxn_rule_ids) {
+
+  int num_errors = 0;
+
+  // parameters whose override was added, changed or removed
+  vector<bool> changed(names.size(), false);
+  for (const auto& it: parameter_overrides) {
+    uint index = find_parameter_index(it.first);
+    if (index == INDEX_INVALID) {
+      errs() << "Cannot override parameter " << it.first << " that was not defined.\n";
+      num_errors++;
+      continue;
+    }
+    auto it_applied = applied_overrides.find(it.first);
+    if (it_applied == applied_overrides.end() || it_applied->second != it.second) {
+      changed[index] = true;
+    }
+  }
+  for (const auto& it: applied_overrides) {
+    if (parameter_overrides.count(it.first) == 0) {
+      changed[find_parameter_index(it.first)] = true;
+    }
+  }
+
+  if (num_errors != 0) {
+    return num_errors;
+  }
+  applied_overrides = parameter_overrides;
+
+  // parameters are ordered so that each of them is evaluated after its dependencies,
+  // changes are propagated in this order
+  for (uint i = 0; i < names.size(); i++) {
+    if (!changed[i] && !exprs[i].uses_any_param(changed)) {
+      continue;
+    }
+    changed[i] = true;
+
+    double new_value;
+    auto it_override = parameter_overrides.find(names[i]);
+    if (it_override != parameter_overrides.end()) {
+      new_value = it_override->second;
+    }
+    else if (!exprs[i].evaluate(values, new_value)) {
+      errs() << "Division by zero while evaluating parameter " << names[i] << ".\n";
+      num_errors++;
+    }
+
+    values[i] = new_value;
+    parameter_values[names[i]] = new_value;
+  }
+
+  for (rxn_rule_id_t id = 0; id < rate_exprs.size() && id < rxn_rules.size(); id++) {
+    if (rate_exprs[id].empty() || !rate_exprs[id].uses_any_param(changed)) {
+      continue;
+    }
+
+    double new_rate;
+    if (!rate_exprs[id].evaluate(values, new_rate)) {
+      errs() << "Division by zero while evaluating rate of rxn rule " << rxn_rules[id].to_str() << ".\n";
+      num_errors++;
+    }
+
+    if (rxn_rules[id].update_rxn_rate(new_rate)) {
+      updated_rxn_rule_ids.push_back(id);
+    }
+  }
+
+  return num_errors;
+}
+
+} // namespace BNG
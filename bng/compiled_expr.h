@@ -0,0 +1,174 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#ifndef LIBS_BNG_COMPILED_EXPR_H_
+#define LIBS_BNG_COMPILED_EXPR_H_
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+#include "bng/bng_defines.h"
+
+namespace BNG {
+
+class RxnRule;
+class ModelCacheWriter;
+class ModelCacheReader;
+
+// function that can be used in BNGL expressions, list used by data model to pymcell4
+// converter is in generator_utils.h: mdl_functions_to_py_bngl_map
+struct BnglFunctionInfo {
+  const char* name;
+  uint num_arguments;
+  double (*eval_1_arg_func_call)(double);
+  double (*eval_2_args_func_call)(double, double);
+
+  // args must contain num_arguments values
+  double evaluate(const double* args) const {
+    return (num_arguments == 1) ? eval_1_arg_func_call(args[0]) : eval_2_args_func_call(args[0], args[1]);
+  }
+};
+
+// returns nullptr if there is no function with this name
+const BnglFunctionInfo* find_bngl_function_info(const std::string& name);
+
+
+enum class CompiledExprOp {
+  Const,
+  Param,
+  UnaryMinus,
+  Add,
+  Sub,
+  Mul,
+  Div,
+  Pow,
+  FunctionCall
+};
+
+
+struct CompiledExprInstr {
+  CompiledExprInstr(const CompiledExprOp op_)
+    : op(op_), value(0), param_index(INDEX_INVALID), func(nullptr) {
+  }
+
+  CompiledExprOp op;
+  double value; // Const
+  uint param_index; // Param
+  const BnglFunctionInfo* func; // FunctionCall
+};
+
+
+// expression in postfix form created by the SemanticAnalyzer from the AST,
+// parameters are referenced by their index in CompiledParameters
+class CompiledExpr {
+public:
+  bool empty() const {
+    return code.empty();
+  }
+
+  void append(const CompiledExprInstr& instr) {
+    code.push_back(instr);
+  }
+
+  void append_const(const double value) {
+    CompiledExprInstr instr(CompiledExprOp::Const);
+    instr.value = value;
+    code.push_back(instr);
+  }
+
+  void append_param(const uint param_index) {
+    CompiledExprInstr instr(CompiledExprOp::Param);
+    instr.param_index = param_index;
+    code.push_back(instr);
+  }
+
+  // returns false on division by zero, res is then 0
+  bool evaluate(const std::vector<double>& param_values, double& res) const;
+
+  // flags are indexed by parameter index
+  bool uses_any_param(const std::vector<bool>& param_flags) const;
+
+  const std::vector<CompiledExprInstr>& get_code() const {
+    return code;
+  }
+
+private:
+  std::vector<CompiledExprInstr> code;
+};
+
+
+/**
+ * Parameters and rate constants of rxn rules of a parsed model
+ * in a form that allows to evaluate them again with different parameter values
+ * without parsing the model (used for parameter sweeps).
+ *
+ * Owned by BNGData.
+ */
+class CompiledParameters {
+  friend class ModelCacheWriter;
+  friend class ModelCacheReader;
+
+public:
+  void clear();
+
+  // parameters must be added in an order where each parameter is added only after
+  // all the parameters it uses, value is the value computed during parsing
+  uint add_parameter(const std::string& name, const CompiledExpr& expr, const double value);
+
+  // returns INDEX_INVALID if there is no such parameter
+  uint find_parameter_index(const std::string& name) const {
+    auto it = parameter_indices.find(name);
+    return (it != parameter_indices.end()) ? it->second : INDEX_INVALID;
+  }
+
+  // rxn rules with the same definition are merged by BNGData,
+  // only the first rate expression is kept
+  void set_rxn_rule_rate_expr(const rxn_rule_id_t id, const CompiledExpr& expr);
+
+  // overrides that were used when the parameters were evaluated during parsing,
+  // all overridden names must be parameters
+  void set_applied_overrides(const std::map<std::string, double>& parameter_overrides) {
+    applied_overrides = parameter_overrides;
+  }
+
+  // - parameters from parameter_overrides get the given value, the remaining
+  //   parameters use their definition from the model, i.e. overrides from previous
+  //   calls are not kept,
+  // - only parameters and rate constants that depend on parameters whose value
+  //   changed since the last call are evaluated,
+  // - updates parameter values and rate constants of rxn_rules and
+  //   appends ids of rxn rules whose rate constant changed to updated_rxn_rule_ids,
+  // - returns number of errors, errors are printed to the error output
+  int update(
+      const std::map<std::string, double>& parameter_overrides,
+      std::map<std::string, double>& parameter_values,
+      std::vector<RxnRule>& rxn_rules,
+      std::vector<rxn_rule_id_t>& updated_rxn_rule_ids
+  );
+
+private:
+  // all indexed with parameter index
+  std::vector<std::string> names;
+  std::vector<CompiledExpr> exprs;
+  std::vector<double> values;
+
+  std::unordered_map<std::string, uint> parameter_indices;
+
+  // indexed with rxn_rule_id_t, empty if the rate is not known
+  std::vector<CompiledExpr> rate_exprs;
+
+  // overrides used by the last update or during parsing
+  std::map<std::string, double> applied_overrides;
+};
+
+} // namespace BNG
+
+#endif // LIBS_BNG_COMPILED_EXPR_H_
@@ -110,6 +110,10 @@ void Cplx::finalize_cplx(const bool init_flags_and_compartments) {
     set_flag(SPECIES_CPLX_FLAG_ONE_MOL_NO_COMPONENTS, is_simple);
   }
 
+  // bonds may be changed without updating flags (e.g. when a copy is finalized),
+  // so this flag is always recomputed
+  set_flag(SPECIES_CPLX_FLAG_SINGLE_MOL_WO_EXPLICIT_BONDS, compute_is_single_elem_mol_wo_explicit_bonds());
+
   // we need graphs even for simple complexes because they can be used in reaction patterns
   graph.clear();
   create_graph();
@@ -236,6 +240,115 @@ compartment_id_t Cplx::get_complex_compartment_id(const bool dont_know_elem_mol_
 }
 
 
+bool Cplx::compute_is_single_elem_mol_wo_explicit_bonds() const {
+  if (elem_mols.size() != 1) {
+    return false;
+  }
+  for (const Component& comp: elem_mols[0].components) {
+    if (comp.bond_has_numeric_value()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+// same rules as in Node::compare for components
+static bool component_matches_pattern(const Component& pattern_comp, const Component& comp) {
+  if (pattern_comp.component_type_id != comp.component_type_id) {
+    return false;
+  }
+
+  if (pattern_comp.state_id != STATE_ID_DONT_CARE && comp.state_id != STATE_ID_DONT_CARE &&
+      pattern_comp.state_id != comp.state_id) {
+    return false;
+  }
+
+  if (pattern_comp.bond_value == BOND_VALUE_ANY || comp.bond_value == BOND_VALUE_ANY) {
+    return true;
+  }
+  else if (pattern_comp.bond_value == BOND_VALUE_BOUND) {
+    return comp.bond_value != BOND_VALUE_UNBOUND;
+  }
+  else {
+    assert(pattern_comp.bond_value == BOND_VALUE_UNBOUND);
+    return comp.bond_value == BOND_VALUE_UNBOUND;
+  }
+}
+
+
+// assigns pattern components to different components of the molecule,
+// graph matching finds only induced subgraphs so two assigned components
+// must not be bound to each other because the pattern has no such bond
+static bool assign_pattern_components(
+    const ElemMol& pattern_mol, const ElemMol& mol,
+    const uint pattern_index, small_vector<uint>& assigned) {
+
+  if (pattern_index == pattern_mol.components.size()) {
+    return true;
+  }
+
+  const Component& pattern_comp = pattern_mol.components[pattern_index];
+  for (uint i = 0; i < mol.components.size(); i++) {
+    const Component& comp = mol.components[i];
+    if (!component_matches_pattern(pattern_comp, comp)) {
+      continue;
+    }
+
+    bool can_assign = true;
+    for (uint a: assigned) {
+      if (a == i ||
+          (comp.bond_has_numeric_value() && mol.components[a].bond_value == comp.bond_value)) {
+        can_assign = false;
+        break;
+      }
+    }
+    if (!can_assign) {
+      continue;
+    }
+
+    assigned.push_back(i);
+    if (assign_pattern_components(pattern_mol, mol, pattern_index + 1, assigned)) {
+      return true;
+    }
+    assigned.pop_back();
+  }
+  return false;
+}
+
+
+bool Cplx::matches_single_elem_mol_pattern_ignore_orientation(const Cplx& pattern) const {
+  assert(pattern.is_single_elem_mol_pattern_wo_explicit_bonds());
+
+  const ElemMol& pattern_mol = pattern.elem_mols[0];
+
+  bool res = false;
+  for (const ElemMol& em: elem_mols) {
+    // same rules as in Node::compare for molecules
+    if (em.elem_mol_type_id != pattern_mol.elem_mol_type_id) {
+      continue;
+    }
+    if (pattern_mol.compartment_id != COMPARTMENT_ID_NONE &&
+        !is_in_out_compartment_id(pattern_mol.compartment_id) &&
+        pattern_mol.compartment_id != em.compartment_id) {
+      continue;
+    }
+
+    small_vector<uint> assigned;
+    if (assign_pattern_components(pattern_mol, em, 0, assigned)) {
+      res = true;
+      break;
+    }
+  }
+
+#ifdef DEBUG_CPLX_MATCHING_SINGLE_ELEM_MOL
+  // graph matching must give the same result
+  assert(res == matches_complex_pattern_ignore_orientation(pattern));
+#endif
+  return res;
+}
+
+
 bool Cplx::matches_complex_pattern_ignore_orientation(const Cplx& pattern) const {
 
 #ifdef DEBUG_CPLX_MATCHING
@@ -287,6 +400,14 @@ uint Cplx::get_pattern_num_matches(const Cplx& pattern) const {
 }
 
 
+uint Cplx::get_pattern_num_matches(const Cplx& pattern, const GraphSymmetry& pattern_symmetry) const {
+  assert(is_finalized() && pattern.is_finalized());
+  VertexMappingVector mappings;
+  get_subgraph_isomorphism_mappings(pattern.graph, graph, false, mappings, &pattern_symmetry);
+  return mappings.size() * (uint)pattern_symmetry.factor;
+}
+
+
 bool Cplx::matches_complex_fully_ignore_orientation(const Cplx& other) const {
   if (graph.m_vertices.size() != other.graph.m_vertices.size()) {
     // we need full match
@@ -379,6 +500,15 @@ void Cplx::canonicalize(const bool sort_components_by_name_do_not_finalize) {
 }
 
 
+void Cplx::assume_canonical() {
+  finalize_cplx();
+
+  set_flag(SPECIES_CPLX_FLAG_IS_CANONICAL);
+  name = "";
+  to_str(name);
+}
+
+
 void Cplx::canonicalize_w_single_elem_mol(const bool sort_components_by_name_do_not_finalize) {
   assert(elem_mols.size() == 1);
 
@@ -547,7 +677,8 @@ void Cplx::canonicalize_complex(const bool sort_components_by_name_do_not_finali
   // - do the actual canonicalization, labels define how to reorder molecules and components
   //   using function Traces instead of sparsenauty or nauty because it does not leave so much
   //   unfreed memory
-  // - WARNING: Threads function may not be thread safe, nauty uses many globals
+  // - nauty is built with thread local storage (HAVE_TLS in nauty.h),
+  //   so Traces may be called from multiple threads
   // - overwrites contents of labels and permutations
 #ifdef DEBUG_CANONICALIZATION
   dump_container(labels, "labels before");
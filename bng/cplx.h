@@ -164,6 +164,10 @@ public:
       if (!ignore_orientation && orientation != pattern.orientation) {
         return false;
       }
+      else if (pattern.is_single_elem_mol_pattern_wo_explicit_bonds()) {
+        // most patterns look like A(b~P), no need to use graph matching for them
+        return matches_single_elem_mol_pattern_ignore_orientation(pattern);
+      }
       else {
         return matches_complex_pattern_ignore_orientation(pattern);
       }
@@ -174,6 +178,10 @@ public:
    // used for counting of molecule pattern type observables
   uint get_pattern_num_matches(const Cplx& pattern) const;
 
+  // same as above, matches that differ only by an automorphism of the pattern
+  // are enumerated once and counted pattern_symmetry.factor times
+  uint get_pattern_num_matches(const Cplx& pattern, const GraphSymmetry& pattern_symmetry) const;
+
   // returns true if this complex is equivalent, neither of the complexes is a pattern
   bool matches_fully(const Cplx& other, const bool ignore_orientation = false) const {
 #ifdef DEBUG_CPLX_MATCHING_EXTRA_COMPARE
@@ -223,6 +231,11 @@ public:
   // after its products were pre-computed
   void canonicalize(const bool sort_components_by_name_do_not_finalize = false);
 
+  // same result as canonicalize but molecules and bonds are not reordered,
+  // to be used only when the complex is known to be in a canonical form already
+  // (e.g. species of a network generated by BioNetGen) to skip the graph canonicalization
+  void assume_canonical();
+
   // appends to string res
   void to_str(std::string& res, const bool in_surf_reaction = false, const bool with_orientation = true) const;
 
@@ -252,6 +265,14 @@ private:
 
   compartment_id_t get_complex_compartment_id(const bool override_is_surface_cplx = false) const;
 
+  // true if there is only one molecule and its components use only !+, !? or no bond,
+  // computed by finalize_cplx
+  bool is_single_elem_mol_pattern_wo_explicit_bonds() const {
+    return has_flag(SPECIES_CPLX_FLAG_SINGLE_MOL_WO_EXPLICIT_BONDS);
+  }
+  bool compute_is_single_elem_mol_wo_explicit_bonds() const;
+
+  bool matches_single_elem_mol_pattern_ignore_orientation(const Cplx& pattern) const;
   bool matches_complex_pattern_ignore_orientation(const Cplx& pattern) const;
   bool matches_complex_fully_ignore_orientation(const Cplx& other) const;
 
@@ -14,3 +14,4 @@
 //#define DEBUG_CPLX_RXNS
 //#define DEBUG_CPLX_MATCHING
 //#define DEBUG_CPLX_MATCHING_EXTRA_COMPARE
+//#define DEBUG_CPLX_MATCHING_SINGLE_ELEM_MOL
@@ -42,6 +42,15 @@ namespace fs = std::filesystem;
 #endif
 
 
+#ifndef _MSC_VER
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#include <fstream>
+#endif
+
 using namespace std;
 
 namespace FSUtils {
@@ -166,5 +175,90 @@ std::string get_current_dir() {
 #endif
 }
 
+
+#ifndef _MSC_VER
+
+bool MappedFile::map(const std::string& file_path) {
+  unmap();
+
+  int fd = open(file_path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return false;
+  }
+  size_t file_size = st.st_size;
+
+  // reserve zeroed memory that also covers the two terminating zero bytes,
+  // then map the file over its beginning, the rest of the file's last page is
+  // zero-filled by the system so no copy is needed
+  size_t page_size = sysconf(_SC_PAGESIZE);
+  size_t region_size = ((file_size + 2 + page_size - 1) / page_size) * page_size;
+  void* region = mmap(nullptr, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) {
+    close(fd);
+    return false;
+  }
+
+  if (file_size > 0) {
+    void* file_region = mmap(region, file_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (file_region == MAP_FAILED) {
+      munmap(region, region_size);
+      close(fd);
+      return false;
+    }
+  }
+
+  close(fd); // the mapping stays valid
+  data = (char*)region;
+  size = file_size;
+  mapped_size = region_size;
+  return true;
+}
+
+
+void MappedFile::unmap() {
+  if (data != nullptr) {
+    munmap(data, mapped_size);
+    data = nullptr;
+  }
+  size = 0;
+  mapped_size = 0;
+}
+
+#else
+
+bool MappedFile::map(const std::string& file_path) {
+  unmap();
+
+  ifstream in(file_path, ios::binary | ios::ate);
+  if (!in.is_open()) {
+    return false;
+  }
+  size = in.tellg();
+  in.seekg(0);
+
+  mapped_size = size + 2;
+  data = new char[mapped_size];
+  in.read(data, size);
+  data[size] = '\0';
+  data[size + 1] = '\0';
+  return true;
+}
+
+
+void MappedFile::unmap() {
+  delete [] data;
+  data = nullptr;
+  size = 0;
+  mapped_size = 0;
+}
+
+#endif
+
 } // namespace FSUtils
 
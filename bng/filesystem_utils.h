@@ -36,6 +36,44 @@ void list_dir(const std::string& dir_path, std::vector<std::string>& dirs);
 
 std::string get_current_dir();
 
+
+// Contents of a file mapped into memory followed by two zero bytes,
+// this is what flex needs to scan a buffer in place.
+// The mapping is private and writable, changes are not written to the file.
+// On systems without mmap, the file is read into memory.
+class MappedFile {
+public:
+  MappedFile()
+    : data(nullptr), size(0), mapped_size(0) {
+  }
+
+  ~MappedFile() {
+    unmap();
+  }
+
+  // owns the mapping, must not be copied
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // returns false if the file could not be opened or mapped
+  bool map(const std::string& file_path);
+  void unmap();
+
+  char* get_data() {
+    return data;
+  }
+
+  // size of the file, does not include the terminating zero bytes
+  size_t get_size() const {
+    return size;
+  }
+
+private:
+  char* data;
+  size_t size;
+  size_t mapped_size;
+};
+
 } // namespace FSUtils
 
 #endif /* LIBS_BNG_FILESYSTEM_UTILS_H_ */
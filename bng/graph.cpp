@@ -10,12 +10,19 @@
 #include "graph.h"
 
 #include <sstream>
+#include <cmath>
+#include <map>
+#include <set>
+#include <tuple>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/vf2_sub_graph_iso.hpp>
 
 #include "bng/bng_data.h"
 
+#include "nauty/traces.h"
+#include "nauty/nausparse.h"
+
 #include "debug_config.h"
 
 
@@ -89,14 +96,27 @@ public:
 
   // constructor, result is stored into mappings_
   CallBackToCollectMapping(
-      const Graph& graph1_, const Graph& graph2_, const bool only_first_match_, VertexMappingVector& mappings_)
-    : graph1(graph1_), graph2(graph2_), only_first_match(only_first_match_), mappings(mappings_) {}
+      const Graph& graph1_, const Graph& graph2_, const bool only_first_match_, VertexMappingVector& mappings_,
+      const GraphSymmetry* pattern_symmetry_)
+    : graph1(graph1_), graph2(graph2_), only_first_match(only_first_match_), mappings(mappings_),
+      pattern_symmetry(pattern_symmetry_) {}
 
   template <typename CorrespondenceMap1To2, typename CorrespondenceMap2To1>
   bool operator()(CorrespondenceMap1To2 f, CorrespondenceMap2To1) {
 
     // TODO: handle maximal number of matches, some counter
 
+    if (pattern_symmetry != nullptr) {
+      // skip mappings that differ from an already found or a future mapping only
+      // by an automorphism of the pattern
+      for (const auto& cond: pattern_symmetry->symmetry_breaking_conditions) {
+        if (get(boost::vertex_index_t(), graph2, get(f, cond.first)) >
+            get(boost::vertex_index_t(), graph2, get(f, cond.second))) {
+          return true; // continue search
+        }
+      }
+    }
+
     mappings.push_back(VertexMapping());
     BGL_FORALL_VERTICES_T(v, graph1, Graph) {
       mappings.back()[get(boost::vertex_index_t(), graph1, v)] =
@@ -116,6 +136,7 @@ private:
   const Graph& graph2;
   bool only_first_match;
   VertexMappingVector& mappings; // result is stored here
+  const GraphSymmetry* pattern_symmetry; // may be nullptr
 };
 
 // Binary function object that returns true if the values for item1
@@ -163,7 +184,8 @@ void get_subgraph_isomorphism_mappings(
     Graph& pattern,
     Graph& cplx,
     const bool only_first_match,
-    VertexMappingVector& res) {
+    VertexMappingVector& res,
+    const GraphSymmetry* pattern_symmetry) {
 
   res.clear();
 
@@ -176,7 +198,7 @@ void get_subgraph_isomorphism_mappings(
 #endif
 
   // setting result to store the resulting mappings
-  CallBackToCollectMapping callback(pattern, cplx,  only_first_match, res);
+  CallBackToCollectMapping callback(pattern, cplx,  only_first_match, res, pattern_symmetry);
 
   PropertyMapMoleculeTypeMatching vertex_comp =
       make_property_map_molecule_type_matching(get(vertex_name, pattern), get(vertex_name, cplx));
@@ -201,6 +223,225 @@ void get_subgraph_isomorphism_mappings(
 #endif
 }
 
+// color of a vertex for Traces, only vertices with the same color may be mapped onto each other:
+// individualization index (-1 when not individualized), index of the source graph,
+// is component, molecule or component type, compartment, state, bond flag
+typedef std::tuple<int, uint, bool, uint, uint, uint, uint> VertexColor;
+
+
+static VertexColor get_vertex_color(const Node& n, const uint graph_index) {
+  if (n.is_mol) {
+    return std::make_tuple(
+        -1, graph_index, false, n.mol->elem_mol_type_id, n.mol->compartment_id,
+        STATE_ID_INVALID, BOND_VALUE_INVALID);
+  }
+  else {
+    // numeric bond values are represented by edges
+    bond_value_t bond =
+        !n.component->bond_has_numeric_value() ? n.component->bond_value : BOND_VALUE_INVALID;
+    return std::make_tuple(
+        -1, graph_index, true, n.component->component_type_id, COMPARTMENT_ID_INVALID,
+        n.component->state_id, bond);
+  }
+}
+
+
+// appends vertices and edges of graph g to the sparse representation,
+// vertex indices of the vecS graph are used directly and offset by the number of
+// vertices already present
+static void add_graph_vertices(
+    const Graph& g_const, const uint graph_index,
+    vector<std::set<int>>& neighbors, vector<VertexColor>& colors) {
+
+  // not manipulating with the graph in any way, but boost needs
+  // non-const variant
+  Graph& g = const_cast<Graph&>(g_const);
+  VertexNameMap index = boost::get(boost::vertex_name, g);
+
+  int offset = neighbors.size();
+  int num_verts = boost::num_vertices(g);
+  neighbors.resize(offset + num_verts);
+
+  for (int v = 0; v < num_verts; v++) {
+    boost::graph_traits<Graph>::out_edge_iterator ei, edge_end;
+    for (boost::tie(ei, edge_end) = boost::out_edges(v, g); ei != edge_end; ++ei) {
+      neighbors[offset + v].insert(offset + boost::target(*ei, g));
+    }
+    colors.push_back(get_vertex_color(index[v], graph_index));
+  }
+}
+
+
+// computes the automorphism group with Traces, returns its size,
+// orbits[v] is set to the smallest vertex in the orbit of v
+static double compute_automorphisms(
+    const vector<std::set<int>>& neighbors, const vector<VertexColor>& colors, vector<int>& orbits) {
+
+  assert(neighbors.size() == colors.size());
+  int num_verts = neighbors.size();
+  orbits.resize(num_verts);
+  if (num_verts == 0) {
+    return 1;
+  }
+
+  // 1) sparse graph representation, same as in Cplx::canonicalize_complex
+  vector<size_t> v_edge_indices;
+  vector<int> d_out_degrees;
+  vector<int> e_neighbors;
+  std::map<VertexColor, vector<int>> color_classes;
+
+  for (int v = 0; v < num_verts; v++) {
+    v_edge_indices.push_back(e_neighbors.size());
+    e_neighbors.insert(e_neighbors.end(), neighbors[v].begin(), neighbors[v].end());
+    d_out_degrees.push_back(neighbors[v].size());
+
+    color_classes[colors[v]].push_back(v);
+  }
+
+  // 2) coloring, see Cplx::canonicalize_complex
+  vector<int> labels;
+  vector<int> permutations;
+  for (auto it_color: color_classes) {
+    vector<int>& indices = it_color.second;
+    for (size_t i = 0; i < indices.size(); i++) {
+      labels.push_back(indices[i]);
+      permutations.push_back((i != indices.size() - 1) ? 1 : 0);
+    }
+  }
+
+  SG_DECL(sg1);
+  sg1.nde = e_neighbors.size();
+  sg1.nv = num_verts;
+  sg1.d = d_out_degrees.data();
+  sg1.dlen = d_out_degrees.size();
+  sg1.v = v_edge_indices.data();
+  sg1.vlen = num_verts;
+  sg1.e = e_neighbors.data();
+  sg1.elen = e_neighbors.size();
+
+  // 3) compute the automorphism group, canonical form is not needed
+  DEFAULTOPTIONS_TRACES(options);
+  options.getcanon = FALSE;
+  options.defaultptn = FALSE;
+  options.digraph = FALSE;
+  TracesStats stats;
+
+  // nauty is built with thread local storage (HAVE_TLS in nauty.h),
+  // so Traces may be called from multiple threads
+  Traces(&sg1, labels.data(), permutations.data(), orbits.data(), &options, &stats, nullptr);
+  nausparse_freedyn();
+
+  return stats.grpsize1 * pow(10.0, stats.grpsize2);
+}
+
+
+void compute_pattern_symmetry(
+    const Graph& pattern,
+    const Graph* products,
+    const VertexMapping* products_to_pattern_mapping,
+    GraphSymmetry& res) {
+
+  res = GraphSymmetry();
+
+  vector<std::set<int>> neighbors;
+  vector<VertexColor> colors;
+  add_graph_vertices(pattern, 0, neighbors, colors);
+  int num_pattern_verts = neighbors.size();
+
+  // most patterns have no automorphisms, products then do not need to be considered
+  vector<int> orbits;
+  res.num_pattern_automorphisms = compute_automorphisms(neighbors, colors, orbits);
+  res.orbits = orbits;
+  if (res.num_pattern_automorphisms == 1) {
+    return;
+  }
+
+  bool orbits_computed = true;
+  if (products != nullptr) {
+    // products are added as a separate part of the graph connected to the pattern
+    // through the mapping, an automorphism must then map the products consistently
+    assert(products_to_pattern_mapping != nullptr);
+    add_graph_vertices(*products, 1, neighbors, colors);
+    for (const auto& prod_pat_pair: *products_to_pattern_mapping) {
+      int prod = num_pattern_verts + prod_pat_pair.first;
+      int pat = prod_pat_pair.second;
+      neighbors[prod].insert(pat);
+      neighbors[pat].insert(prod);
+    }
+    orbits_computed = false;
+  }
+
+  // symmetry breaking conditions are computed by individualizing vertices one by one,
+  // each individualized vertex must be mapped onto a lower index than the other vertices
+  // of its orbit in the stabilizer of the previously individualized vertices
+  // (Grochow & Kellis, Network motif discovery using subgraph enumeration and
+  // symmetry-breaking, 2007)
+  int num_individualized = 0;
+  while (true) {
+    if (!orbits_computed) {
+      compute_automorphisms(neighbors, colors, orbits);
+      if (num_individualized == 0) {
+        res.orbits.assign(orbits.begin(), orbits.begin() + num_pattern_verts);
+      }
+    }
+    orbits_computed = false;
+
+    // orbits of product vertices do not matter, they are not used in mappings
+    std::map<int, vector<int>> orbit_members;
+    for (int v = 0; v < num_pattern_verts; v++) {
+      orbit_members[orbits[v]].push_back(v);
+    }
+
+    int individualized = -1;
+    for (int v = 0; v < num_pattern_verts; v++) {
+      const vector<int>& members = orbit_members[orbits[v]];
+      if (members.size() > 1) {
+        individualized = v;
+        res.factor *= members.size();
+        for (int u: members) {
+          if (u != v) {
+            res.symmetry_breaking_conditions.push_back(make_pair(v, u));
+          }
+        }
+        break;
+      }
+    }
+
+    if (individualized == -1) {
+      // stabilizer of the pattern vertices is trivial
+      break;
+    }
+    std::get<0>(colors[individualized]) = num_individualized;
+    num_individualized++;
+  }
+}
+
+
+bool may_match_vertices_with_different_labels(const Graph& g_const) {
+
+  // not manipulating with the graph in any way, but boost needs
+  // non-const variant
+  Graph& g = const_cast<Graph&>(g_const);
+  VertexNameMap index = boost::get(boost::vertex_name, g);
+
+  int num_verts = boost::num_vertices(g);
+  for (int u = 0; u < num_verts; u++) {
+    // reactant pattern indices are ignored
+    Node n1 = index[u];
+    n1.reactant_pattern_index = INDEX_INVALID;
+    VertexColor c1 = get_vertex_color(n1, 0);
+    for (int v = u + 1; v < num_verts; v++) {
+      Node n2 = index[v];
+      n2.reactant_pattern_index = INDEX_INVALID;
+      if (get_vertex_color(n2, 0) != c1 && (n1.compare(n2) || n2.compare(n1))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+
 // bng_data might be nullptr
 void dump_graph(const Graph& g_const, const BNGData* bng_data, const std::string ind) {
 
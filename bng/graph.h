@@ -17,35 +17,6 @@
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/iteration_macros.hpp>
-#define BOOST_POOL_NO_MT
-#include <boost/pool/pool_alloc.hpp>
-#undef BOOST_POOL_NO_MT
-
-namespace boost {
-  // NOTE: not sure if we need to put this really into the boost namespace
-  struct pool_listS { };
-
-  // examples of allocators usage are here: https://theboostcpplibraries.com/boost.pool
-  // TODO: figure out whether we need to use purge_memory
-  //
-  // note from https://www.boost.org/doc/libs/1_65_0/libs/pool/doc/html/boost/fast_pool_allocator.html:
-  // The underlying singleton_pool used by the this allocator constructs a pool instance
-  // that is never freed. This means that memory allocated by the allocator can be still
-  // used after main() has completed, but may mean that some memory checking programs will
-  // complain about leaks.
-
-  template <class ValueType>
-  struct container_gen<pool_listS, ValueType> {
-    typedef std::list<ValueType, boost::fast_pool_allocator<ValueType>> type;
-  };
-
-  template <>
-  struct parallel_edge_traits<pool_listS> {
-    typedef allow_parallel_edge_tag type; 
-  };
-
-}
-
 
 namespace BNG {
 
@@ -189,11 +160,13 @@ typedef boost::property<boost::vertex_name_t, Node, boost::property< boost::vert
 
 // one can choose different underlying types (vecS/listS/setS...) but
 // vecS seems to be the most efficient
-// last 7th unlisted argument EdgeList must be listS (default) otherwise it is not possible to remove edges
+// last 7th unlisted argument EdgeList must be listS (default) otherwise it is not possible to remove edges,
+// it uses std::allocator because graphs are created in parallel by RxnContainer::add_and_finalize
+// and by concurrent parsing and a shared pool allocator would need a lock on every edge allocation
 typedef boost::adjacency_list<
     boost::vecS, boost::vecS, boost::undirectedS, MtVertexProperty,
     boost::no_property, boost::no_property,
-    boost::pool_listS
+    boost::listS
     > Graph;
 
 typedef boost::property_map<Graph, boost::vertex_name_t >::type VertexNameMap;
@@ -207,14 +180,58 @@ typedef Graph::edge_descriptor edge_descriptor_t;
 
 typedef boost::graph_traits<Graph>::vertex_iterator vertex_iter_t; // TODO: use this typedef wherever needed
 
-// finds all subgraph isomorphism mappings of pattern graph on cplx graph
+// symmetry of a pattern graph computed by compute_pattern_symmetry
+class GraphSymmetry {
+public:
+  GraphSymmetry()
+    : num_pattern_automorphisms(1), factor(1) {
+  }
+
+  // size of the automorphism group of the pattern alone
+  double num_pattern_automorphisms;
+
+  // size of the automorphism group of the pattern that is used for symmetry breaking,
+  // these automorphisms can be also extended to the products
+  double factor;
+
+  // indexed by pattern vertex, orbits[v] is the smallest vertex
+  // that can be mapped onto v by an automorphism
+  std::vector<int> orbits;
+
+  // symmetry breaking conditions (a, b), a mapping of the pattern is kept only if
+  // vertex a is mapped onto a vertex with a lower index than vertex b,
+  // from each group of mappings that differ only by an automorphism,
+  // exactly one mapping fulfills all conditions
+  std::vector<std::pair<vertex_descriptor_t, vertex_descriptor_t>> symmetry_breaking_conditions;
+};
+
+// finds all subgraph isomorphism mappings of pattern graph on cplx graph,
+// if pattern_symmetry is set, only one mapping from each group of mappings that
+// differ by an automorphism of the pattern is returned
 void get_subgraph_isomorphism_mappings(
     Graph& pattern,
     Graph& cplx,
     const bool only_first_match,
-    VertexMappingVector& res
+    VertexMappingVector& res,
+    const GraphSymmetry* pattern_symmetry = nullptr
+);
+
+// computes automorphisms of a pattern using Traces, nodes are colored by all their
+// attributes, if products are set, only automorphisms that can be extended to
+// the products through products_to_pattern_mapping are used
+// (i.e. applying the rule through such automorphism gives the same result)
+void compute_pattern_symmetry(
+    const Graph& pattern,
+    const Graph* products,
+    const VertexMapping* products_to_pattern_mapping,
+    GraphSymmetry& res
 );
 
+// returns true if a node of pattern g may match another node of g with different attributes,
+// e.g. a component without a state set matches a component with a state,
+// matches of g onto itself are then not only its automorphisms, reactant pattern indices are ignored
+bool may_match_vertices_with_different_labels(const Graph& g);
+
 void dump_graph(const Graph& g_const, const BNGData* bng_data = nullptr, const std::string ind = "");
 void dump_graph_mapping(const VertexMapping& mapping);
 
@@ -0,0 +1,604 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include "bng/model_cache.h"
+#include "bng/bng_data.h"
+#include "bng/compiled_expr.h"
+#include "bng/filesystem_utils.h"
+
+using namespace std;
+
+namespace BNG {
+
+static const char MODEL_CACHE_MAGIC[8] = { 'B', 'N', 'G', 'C', 'A', 'C', 'H', 'E' };
+
+// must be increased whenever the format or contents of the cached data change
+static const uint32_t MODEL_CACHE_VERSION = 2;
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+
+// FNV-1a
+static uint64_t hash_bytes(uint64_t hash, const char* bytes, const size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    hash ^= (unsigned char)bytes[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+
+uint64_t get_model_cache_key(
+    const std::string_view& bngl_source,
+    const std::map<std::string, double>& parameter_overrides) {
+
+  uint64_t key = hash_bytes(FNV_OFFSET_BASIS, bngl_source.data(), bngl_source.size());
+  for (const auto& it: parameter_overrides) {
+    // name including the terminating zero
+    key = hash_bytes(key, it.first.c_str(), it.first.size() + 1);
+    key = hash_bytes(key, reinterpret_cast<const char*>(&it.second), sizeof(it.second));
+  }
+  return key;
+}
+
+
+bool save_model_cache(const std::string& cache_file_name, const uint64_t key, const BNGData& bng_data) {
+  // write into a temporary file first and then rename it,
+  // multiple processes may be creating the same cache
+  random_device rd;
+  string tmp_file_name = cache_file_name + ".tmp" + to_string(rd());
+
+  {
+    ofstream out(tmp_file_name, ios::binary);
+    if (!out.is_open()) {
+      return false;
+    }
+    ModelCacheWriter writer(out);
+    writer.write(key, bng_data);
+    out.close();
+    if (out.fail()) {
+      remove(tmp_file_name.c_str());
+      return false;
+    }
+  }
+
+  if (rename(tmp_file_name.c_str(), cache_file_name.c_str()) != 0) {
+    remove(tmp_file_name.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+bool load_model_cache(const std::string& cache_file_name, const uint64_t key, BNGData& bng_data) {
+  FSUtils::MappedFile file;
+  if (!file.map(cache_file_name)) {
+    return false;
+  }
+
+  // complexes and rxn rules keep a pointer to bng_data so they must be
+  // read directly into it
+  ModelCacheReader reader(file.get_data(), file.get_size());
+  return reader.read(key, bng_data);
+}
+
+
+// ------------------------------- ModelCacheWriter ----------------------------
+
+void ModelCacheWriter::write_bytes(const char* bytes, const size_t size) {
+  out.write(bytes, size);
+  hash = hash_bytes(hash, bytes, size);
+}
+
+
+void ModelCacheWriter::write_str(const std::string& s) {
+  write_pod<uint64_t>(s.size());
+  write_bytes(s.data(), s.size());
+}
+
+
+void ModelCacheWriter::write_cplx(const Cplx& cplx) {
+  write_pod<uint64_t>(cplx.elem_mols.size());
+  for (const ElemMol& em: cplx.elem_mols) {
+    write_pod(em.elem_mol_type_id);
+    write_pod(em.compartment_id);
+    write_pod(em.get_flags());
+    write_pod<uint8_t>(em.is_finalized());
+
+    write_pod<uint64_t>(em.components.size());
+    for (const Component& comp: em.components) {
+      write_pod(comp.component_type_id);
+      write_pod(comp.state_id);
+      write_pod(comp.bond_value);
+    }
+  }
+  write_pod(cplx.get_orientation());
+  write_str(cplx.name);
+  write_pod(cplx.get_flags());
+  write_pod<uint8_t>(cplx.is_finalized());
+}
+
+
+void ModelCacheWriter::write_expr(const CompiledExpr& expr) {
+  write_pod<uint64_t>(expr.get_code().size());
+  for (const CompiledExprInstr& instr: expr.get_code()) {
+    write_pod<uint8_t>((uint8_t)instr.op);
+    write_pod(instr.value);
+    write_pod(instr.param_index);
+    // functions are stored by name
+    write_str((instr.func != nullptr) ? instr.func->name : "");
+  }
+}
+
+
+void ModelCacheWriter::write(const uint64_t key, const BNGData& bng_data) {
+  out.write(MODEL_CACHE_MAGIC, sizeof(MODEL_CACHE_MAGIC));
+  out.write(reinterpret_cast<const char*>(&MODEL_CACHE_VERSION), sizeof(MODEL_CACHE_VERSION));
+  out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+  hash = FNV_OFFSET_BASIS;
+
+  write_pod<uint64_t>(bng_data.state_names.size());
+  for (const string& s: bng_data.state_names) {
+    write_str(s);
+  }
+
+  write_pod<uint64_t>(bng_data.component_types.size());
+  for (const ComponentType& ct: bng_data.component_types) {
+    write_str(ct.name);
+    write_str(ct.elem_mol_type_name);
+    write_pod<uint64_t>(ct.allowed_state_ids.size());
+    for (state_id_t id: ct.allowed_state_ids) {
+      write_pod(id);
+    }
+  }
+
+  write_pod<uint64_t>(bng_data.elem_mol_types.size());
+  for (const ElemMolType& mt: bng_data.elem_mol_types) {
+    write_str(mt.name);
+    write_pod<uint64_t>(mt.component_type_ids.size());
+    for (component_type_id_t id: mt.component_type_ids) {
+      write_pod(id);
+    }
+    write_pod(mt.D);
+    write_pod(mt.time_step);
+    write_pod(mt.space_step);
+    write_pod<uint8_t>(mt.color_set);
+    write_pod(mt.color_r);
+    write_pod(mt.color_g);
+    write_pod(mt.color_b);
+    write_pod(mt.scale);
+    write_pod(mt.custom_time_step);
+    write_pod(mt.custom_space_step);
+    write_pod(mt.get_flags());
+    write_pod<uint8_t>(mt.is_finalized());
+  }
+
+  write_pod<uint64_t>(bng_data.compartments.size());
+  for (const Compartment& c: bng_data.compartments) {
+    write_pod(c.id);
+    write_str(c.name);
+    write_pod<uint8_t>(c.is_3d);
+    double volume_or_area = FLT_INVALID;
+    if (c.is_volume_or_area_set()) {
+      volume_or_area = c.is_3d ? c.get_volume() : c.get_area();
+    }
+    write_pod(volume_or_area);
+    write_pod(c.parent_compartment_id);
+    write_pod<uint64_t>(c.children_compartments.size());
+    for (compartment_id_t id: c.children_compartments) {
+      write_pod(id);
+    }
+  }
+
+  write_pod<uint64_t>(bng_data.rxn_rules.size());
+  for (const RxnRule& r: bng_data.rxn_rules) {
+    write_str(r.name);
+    write_pod(r.id);
+    write_pod<uint8_t>((uint8_t)r.type);
+    write_pod<uint64_t>(r.reactants.size());
+    for (const Cplx& c: r.reactants) {
+      write_cplx(c);
+    }
+    write_pod<uint64_t>(r.products.size());
+    for (const Cplx& c: r.products) {
+      write_cplx(c);
+    }
+    write_pod(r.base_rate_constant);
+    write_pod<uint64_t>(r.base_variable_rates.size());
+    for (const RxnRateInfo& ri: r.base_variable_rates) {
+      write_pod(ri.time);
+      write_pod(ri.rate_constant);
+    }
+  }
+
+  write_pod<uint64_t>(bng_data.parameters.size());
+  for (const auto& it: bng_data.parameters) {
+    write_str(it.first);
+    write_pod(it.second);
+  }
+
+  const CompiledParameters& cp = bng_data.compiled_parameters;
+  write_pod<uint64_t>(cp.names.size());
+  for (size_t i = 0; i < cp.names.size(); i++) {
+    write_str(cp.names[i]);
+    write_expr(cp.exprs[i]);
+    write_pod(cp.values[i]);
+  }
+  write_pod<uint64_t>(cp.rate_exprs.size());
+  for (const CompiledExpr& expr: cp.rate_exprs) {
+    write_expr(expr);
+  }
+  write_pod<uint64_t>(cp.applied_overrides.size());
+  for (const auto& it: cp.applied_overrides) {
+    write_str(it.first);
+    write_pod(it.second);
+  }
+
+  write_pod<uint64_t>(bng_data.seed_species.size());
+  for (const SeedSpecies& ss: bng_data.seed_species) {
+    write_cplx(ss.cplx);
+    write_pod(ss.count);
+  }
+
+  write_pod<uint64_t>(bng_data.observables.size());
+  for (const Observable& o: bng_data.observables) {
+    write_pod<uint8_t>((uint8_t)o.type);
+    write_str(o.name);
+    write_pod<uint64_t>(o.patterns.size());
+    for (const Cplx& c: o.patterns) {
+      write_cplx(c);
+    }
+  }
+
+  // checksum of all data, used to detect damaged files
+  uint64_t checksum = hash;
+  out.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+}
+
+
+// ------------------------------- ModelCacheReader ----------------------------
+
+bool ModelCacheReader::read_bytes(char* bytes, const size_t num_bytes) {
+  if (!valid || size - pos < num_bytes) {
+    valid = false;
+    memset(bytes, 0, num_bytes);
+    return false;
+  }
+  memcpy(bytes, data + pos, num_bytes);
+  pos += num_bytes;
+  return true;
+}
+
+
+bool ModelCacheReader::read_count(size_t& count) {
+  uint64_t value;
+  if (!read_pod(value) || value > size - pos) {
+    valid = false;
+    count = 0;
+    return false;
+  }
+  count = value;
+  return true;
+}
+
+
+bool ModelCacheReader::read_str(std::string& s) {
+  size_t len;
+  if (!read_count(len)) {
+    return false;
+  }
+  s.assign(data + pos, len);
+  pos += len;
+  return true;
+}
+
+
+bool ModelCacheReader::read_cplx(const BNGData& bng_data, Cplx& cplx) {
+  size_t num_elem_mols;
+  read_count(num_elem_mols);
+  for (size_t i = 0; i < num_elem_mols && valid; i++) {
+    ElemMol em;
+    read_pod(em.elem_mol_type_id);
+    read_pod(em.compartment_id);
+    uint flags;
+    read_pod(flags);
+    em.set_flags(flags);
+    uint8_t finalized;
+    read_pod(finalized);
+    if (finalized) {
+      em.set_finalized();
+    }
+
+    size_t num_components;
+    read_count(num_components);
+    for (size_t k = 0; k < num_components && valid; k++) {
+      Component comp;
+      read_pod(comp.component_type_id);
+      read_pod(comp.state_id);
+      read_pod(comp.bond_value);
+      em.components.push_back(comp);
+    }
+
+    if (em.elem_mol_type_id >= bng_data.get_elem_mol_types().size()) {
+      valid = false;
+    }
+    cplx.elem_mols.push_back(em);
+  }
+
+  orientation_t orientation;
+  read_pod(orientation);
+  cplx.set_orientation(orientation);
+  read_str(cplx.name);
+  uint flags;
+  read_pod(flags);
+  cplx.set_flags(flags);
+  uint8_t finalized;
+  read_pod(finalized);
+
+  // same as when a complex is copied, graph is created again
+  if (valid && finalized) {
+    cplx.finalize_cplx(false);
+  }
+  return valid;
+}
+
+
+bool ModelCacheReader::read_expr(CompiledExpr& expr) {
+  size_t num_instrs;
+  read_count(num_instrs);
+  for (size_t i = 0; i < num_instrs && valid; i++) {
+    uint8_t op;
+    read_pod(op);
+    if (op > (uint8_t)CompiledExprOp::FunctionCall) {
+      valid = false;
+    }
+    CompiledExprInstr instr((CompiledExprOp)op);
+    read_pod(instr.value);
+    read_pod(instr.param_index);
+    string func_name;
+    read_str(func_name);
+    if (instr.op == CompiledExprOp::FunctionCall) {
+      instr.func = find_bngl_function_info(func_name);
+      if (instr.func == nullptr) {
+        valid = false;
+      }
+    }
+    expr.append(instr);
+  }
+  return valid;
+}
+
+
+bool ModelCacheReader::read(const uint64_t key, BNGData& bng_data) {
+  char magic[sizeof(MODEL_CACHE_MAGIC)];
+  uint32_t version;
+  uint64_t stored_key;
+  read_bytes(magic, sizeof(magic));
+  read_pod(version);
+  read_pod(stored_key);
+  if (!valid ||
+      memcmp(magic, MODEL_CACHE_MAGIC, sizeof(magic)) != 0 ||
+      version != MODEL_CACHE_VERSION ||
+      stored_key != key) {
+    return false;
+  }
+
+  // verify checksum before anything is loaded
+  uint64_t checksum;
+  if (size - pos < sizeof(checksum)) {
+    return false;
+  }
+  memcpy(&checksum, data + size - sizeof(checksum), sizeof(checksum));
+  if (hash_bytes(FNV_OFFSET_BASIS, data + pos, size - pos - sizeof(checksum)) != checksum) {
+    return false;
+  }
+  size -= sizeof(checksum);
+
+  bng_data.clear();
+
+  size_t count;
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    string s;
+    read_str(s);
+    bng_data.find_or_add_state_name(s);
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    ComponentType ct;
+    read_str(ct.name);
+    read_str(ct.elem_mol_type_name);
+    size_t num_states;
+    read_count(num_states);
+    for (size_t k = 0; k < num_states && valid; k++) {
+      state_id_t id;
+      read_pod(id);
+      ct.allowed_state_ids.insert(id);
+    }
+    bng_data.find_or_add_component_type(ct, true);
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    ElemMolType mt;
+    read_str(mt.name);
+    size_t num_components;
+    read_count(num_components);
+    for (size_t k = 0; k < num_components && valid; k++) {
+      component_type_id_t id;
+      read_pod(id);
+      mt.component_type_ids.push_back(id);
+    }
+    read_pod(mt.D);
+    read_pod(mt.time_step);
+    read_pod(mt.space_step);
+    uint8_t color_set;
+    read_pod(color_set);
+    mt.color_set = color_set;
+    read_pod(mt.color_r);
+    read_pod(mt.color_g);
+    read_pod(mt.color_b);
+    read_pod(mt.scale);
+    read_pod(mt.custom_time_step);
+    read_pod(mt.custom_space_step);
+    uint flags;
+    read_pod(flags);
+    mt.set_flags(flags);
+    uint8_t finalized;
+    read_pod(finalized);
+    if (finalized) {
+      mt.set_finalized();
+    }
+    bng_data.find_or_add_elem_mol_type(mt);
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    Compartment c;
+    read_pod(c.id);
+    read_str(c.name);
+    uint8_t is_3d;
+    read_pod(is_3d);
+    c.is_3d = is_3d;
+    double volume_or_area;
+    read_pod(volume_or_area);
+    if (c.is_3d) {
+      c.set_volume(volume_or_area);
+    }
+    else {
+      c.set_area(volume_or_area);
+    }
+    read_pod(c.parent_compartment_id);
+    size_t num_children;
+    read_count(num_children);
+    for (size_t k = 0; k < num_children && valid; k++) {
+      compartment_id_t id;
+      read_pod(id);
+      c.children_compartments.insert(id);
+    }
+    bng_data.add_compartment(c);
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    RxnRule r(&bng_data);
+    read_str(r.name);
+    read_pod(r.id);
+    uint8_t type;
+    read_pod(type);
+    r.type = (RxnType)type;
+
+    size_t num_cplxs;
+    read_count(num_cplxs);
+    for (size_t k = 0; k < num_cplxs && valid; k++) {
+      Cplx c(&bng_data);
+      read_cplx(bng_data, c);
+      r.reactants.push_back(c);
+    }
+    read_count(num_cplxs);
+    for (size_t k = 0; k < num_cplxs && valid; k++) {
+      Cplx c(&bng_data);
+      read_cplx(bng_data, c);
+      r.products.push_back(c);
+    }
+
+    read_pod(r.base_rate_constant);
+    size_t num_rates;
+    read_count(num_rates);
+    for (size_t k = 0; k < num_rates && valid; k++) {
+      RxnRateInfo ri;
+      read_pod(ri.time);
+      read_pod(ri.rate_constant);
+      r.base_variable_rates.push_back(ri);
+    }
+
+    if (valid) {
+      // complexes were stored canonical and with their names,
+      // the rule is finalized only once by BNGEngine::initialize
+      r.cplxs_are_canonical = true;
+      bng_data.find_or_add_rxn_rule(r);
+    }
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    string name;
+    double value;
+    read_str(name);
+    read_pod(value);
+    bng_data.parameters[name] = value;
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    string name;
+    CompiledExpr expr;
+    double value;
+    read_str(name);
+    read_expr(expr);
+    read_pod(value);
+    bng_data.compiled_parameters.add_parameter(name, expr, value);
+  }
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    CompiledExpr expr;
+    read_expr(expr);
+    if (!expr.empty()) {
+      bng_data.compiled_parameters.set_rxn_rule_rate_expr(i, expr);
+    }
+  }
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    string name;
+    double value;
+    read_str(name);
+    read_pod(value);
+    bng_data.compiled_parameters.applied_overrides[name] = value;
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    SeedSpecies ss(&bng_data);
+    read_cplx(bng_data, ss.cplx);
+    read_pod(ss.count);
+    bng_data.seed_species.push_back(ss);
+  }
+
+  read_count(count);
+  for (size_t i = 0; i < count && valid; i++) {
+    Observable o;
+    uint8_t type;
+    read_pod(type);
+    o.type = (ObservableType)type;
+    read_str(o.name);
+    size_t num_patterns;
+    read_count(num_patterns);
+    for (size_t k = 0; k < num_patterns && valid; k++) {
+      Cplx c(&bng_data);
+      read_cplx(bng_data, c);
+      o.patterns.push_back(c);
+    }
+    bng_data.observables.push_back(o);
+  }
+
+  if (!valid || pos != size) {
+    bng_data.clear();
+    return false;
+  }
+  return true;
+}
+
+} // namespace BNG
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#ifndef LIBS_BNG_MODEL_CACHE_H_
+#define LIBS_BNG_MODEL_CACHE_H_
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <iostream>
+
+#include "bng/bng_defines.h"
+
+namespace BNG {
+
+class BNGData;
+class Cplx;
+class CompiledExpr;
+
+/**
+ * Binary cache of BNGData of a parsed model so that processes that use the same
+ * model do not have to parse it and run semantic analysis again.
+ *
+ * The cache contains the result of the semantic analysis. Complexes are stored
+ * in their canonical form with their names so they are not canonicalized again
+ * when loaded. Loaded rxn rules are not finalized, this is done only once
+ * by BNGEngine::initialize.
+ * The format is specific to the version of this library and to the
+ * machine architecture.
+ */
+
+// returns key identifying the model source together with the parameter overrides
+// that were used when it was parsed
+uint64_t get_model_cache_key(
+    const std::string_view& bngl_source,
+    const std::map<std::string, double>& parameter_overrides
+);
+
+// returns false if the file could not be written,
+// the file is replaced atomically so that other processes never read a partial file
+bool save_model_cache(const std::string& cache_file_name, const uint64_t key, const BNGData& bng_data);
+
+// returns false if the file does not exist, was created by a different version,
+// for a different key or is damaged, bng_data are not modified in this case
+// (except for the unlikely case when a damaged file has a valid checksum,
+// bng_data are cleared then)
+bool load_model_cache(const std::string& cache_file_name, const uint64_t key, BNGData& bng_data);
+
+
+class ModelCacheWriter {
+public:
+  ModelCacheWriter(std::ostream& out_)
+    : out(out_), hash(0) {
+  }
+
+  void write(const uint64_t key, const BNGData& bng_data);
+
+private:
+  template<class T>
+  void write_pod(const T& value) {
+    write_bytes(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+
+  void write_bytes(const char* bytes, const size_t size);
+  void write_str(const std::string& s);
+  void write_cplx(const Cplx& cplx);
+  void write_expr(const CompiledExpr& expr);
+
+  std::ostream& out;
+
+  // hash of everything written after the header
+  uint64_t hash;
+};
+
+
+class ModelCacheReader {
+public:
+  ModelCacheReader(const char* data_, const size_t size_)
+    : data(data_), size(size_), pos(0), valid(true) {
+  }
+
+  // returns false if the data are not valid, bng_data are not modified when the header
+  // or checksum do not match and are cleared when the contents are not valid
+  bool read(const uint64_t key, BNGData& bng_data);
+
+private:
+  template<class T>
+  bool read_pod(T& value) {
+    return read_bytes(reinterpret_cast<char*>(&value), sizeof(T));
+  }
+
+  bool read_bytes(char* bytes, const size_t num_bytes);
+  // reads number of items, each item must take at least one byte
+  bool read_count(size_t& count);
+  bool read_str(std::string& s);
+  bool read_cplx(const BNGData& bng_data, Cplx& cplx);
+  bool read_expr(CompiledExpr& expr);
+
+  const char* data;
+  size_t size;
+  size_t pos;
+  bool valid;
+};
+
+} // namespace BNG
+
+#endif // LIBS_BNG_MODEL_CACHE_H_
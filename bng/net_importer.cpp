@@ -0,0 +1,523 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+
+#include "bng/net_importer.h"
+#include "bng/bng_engine.h"
+#include "bng/parser.h"
+#include "bng/species.h"
+
+using namespace std;
+
+namespace BNG {
+
+// number of species strings converted at once by parse_cplx_strings
+const size_t NET_SPECIES_BATCH_SIZE = 4096;
+
+enum class NetSection {
+  None,
+  Header, // parameters, compartments, molecule types, observables
+  Species,
+  Reactions,
+  Groups,
+  Ignored
+};
+
+
+static bool is_integer(const string& s) {
+  if (s.empty()) {
+    return false;
+  }
+  for (char c: s) {
+    if (!isdigit(c)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static void split_by_whitespace(const string& line, vector<string>& tokens) {
+  tokens.clear();
+  istringstream ss(line);
+  string token;
+  while (ss >> token) {
+    tokens.push_back(token);
+  }
+}
+
+
+class NetImporter {
+public:
+  NetImporter(
+      BNGEngine& bng_engine_, NetGroupVector& groups_,
+      const bool species_are_canonical_, const string& stream_name_)
+    : bng_engine(bng_engine_), bng_data(bng_engine_.get_data()), groups(groups_),
+      species_are_canonical(species_are_canonical_), stream_name(stream_name_),
+      section(NetSection::None), header_processed(false),
+      line_nr(0), num_errors(0), fixed_species_reported(false) {
+  }
+
+  int import(istream& in);
+
+private:
+  ostream& errs_line() {
+    num_errors++;
+    errs() << stream_name << ":" << line_nr << ": ";
+    return cerr;
+  }
+
+  void process_line(const string& line);
+  void begin_section(const string& name);
+  void end_section(const string& name);
+
+  void process_header();
+
+  void add_species(const vector<string>& tokens);
+  void convert_pending_species();
+  void add_reaction(const vector<string>& tokens, const string& comment);
+  void add_group(const vector<string>& tokens);
+
+  bool evaluate(const string& expr, double& res);
+  bool get_species_id(const string& net_index, species_id_t& id);
+  bool get_species_ids(const string& net_indices, vector<species_id_t>& ids);
+
+  BNGEngine& bng_engine;
+  BNGData& bng_data;
+  NetGroupVector& groups;
+  const bool species_are_canonical;
+  const string stream_name;
+
+  NetSection section;
+  string section_name;
+
+  // sections processed by the BNGL parser, indices are removed
+  stringstream header_bngl;
+  bool header_processed;
+
+  uint64_t line_nr;
+  int num_errors;
+  bool fixed_species_reported;
+
+  // species read but not converted yet
+  vector<string> pending_species_strings;
+  vector<double> pending_species_counts;
+
+  // indexed by species index in the file - 1
+  vector<species_id_t> net_species_ids;
+};
+
+
+int NetImporter::import(istream& in) {
+  release_assert(bng_data.get_rxn_rules().empty() && bng_data.get_seed_species().empty() &&
+      "Network can be imported only into an empty engine");
+  groups.clear();
+
+  string line;
+  while (getline(in, line)) {
+    line_nr++;
+    process_line(line);
+  }
+
+  if (section != NetSection::None) {
+    errs_line() << "Missing 'end " << section_name << "'.\n";
+    convert_pending_species();
+  }
+  process_header();
+
+  return num_errors;
+}
+
+
+void NetImporter::process_line(const string& line) {
+  // comments are used only as names of reactions
+  string comment;
+  string text = line;
+  size_t comment_pos = line.find('#');
+  if (comment_pos != string::npos) {
+    comment = line.substr(comment_pos + 1);
+    text = line.substr(0, comment_pos);
+  }
+
+  vector<string> tokens;
+  split_by_whitespace(text, tokens);
+  if (tokens.empty()) {
+    return;
+  }
+
+  if (tokens[0] == "begin" || tokens[0] == "end") {
+    string name;
+    for (size_t i = 1; i < tokens.size(); i++) {
+      name += (i > 1 ? " " : "") + tokens[i];
+    }
+    if (tokens[0] == "begin") {
+      begin_section(name);
+    }
+    else {
+      end_section(name);
+    }
+    return;
+  }
+
+  switch (section) {
+    case NetSection::None:
+      errs_line() << "Unexpected line outside of a section.\n";
+      break;
+    case NetSection::Header:
+      // the first token is the index of the item
+      if (is_integer(tokens[0])) {
+        header_bngl << text.substr(text.find(tokens[0]) + tokens[0].size()) << "\n";
+      }
+      else {
+        header_bngl << text << "\n";
+      }
+      break;
+    case NetSection::Species:
+      add_species(tokens);
+      break;
+    case NetSection::Reactions:
+      add_reaction(tokens, comment);
+      break;
+    case NetSection::Groups:
+      add_group(tokens);
+      break;
+    case NetSection::Ignored:
+      break;
+  }
+}
+
+
+void NetImporter::begin_section(const string& name) {
+  if (section != NetSection::None) {
+    errs_line() << "Section '" << name << "' begins inside of section '" << section_name << "'.\n";
+    return;
+  }
+  section_name = name;
+
+  if (name == "model") {
+    // optional, sections of the model follow
+    return;
+  }
+  else if (name == "parameters" || name == "compartments" ||
+      name == "molecule types" || name == "observables") {
+    if (header_processed) {
+      errs_line() << "Section '" << name << "' must precede species, reactions and groups.\n";
+      section = NetSection::Ignored;
+      return;
+    }
+    section = NetSection::Header;
+    header_bngl << "begin " << name << "\n";
+  }
+  else if (name == "species") {
+    process_header();
+    section = NetSection::Species;
+  }
+  else if (name == "reactions") {
+    process_header();
+    section = NetSection::Reactions;
+  }
+  else if (name == "groups") {
+    process_header();
+    section = NetSection::Groups;
+  }
+  else {
+    // e.g. functions, rates that use them are reported as errors
+    warns() << stream_name << ":" << line_nr << ": Section '" << name << "' is not supported and is ignored.\n";
+    section = NetSection::Ignored;
+  }
+}
+
+
+void NetImporter::end_section(const string& name) {
+  if (name == "model" && section == NetSection::None) {
+    return;
+  }
+  if (section == NetSection::None || name != section_name) {
+    errs_line() << "Unexpected 'end " << name << "'.\n";
+    return;
+  }
+
+  if (section == NetSection::Header) {
+    header_bngl << "end " << name << "\n";
+  }
+  else if (section == NetSection::Species) {
+    convert_pending_species();
+  }
+  section = NetSection::None;
+}
+
+
+void NetImporter::process_header() {
+  if (header_processed) {
+    return;
+  }
+  header_processed = true;
+
+  string header = header_bngl.str();
+  if (header.empty()) {
+    return;
+  }
+  num_errors += parse_bngl_buffer(header, bng_data, map<string, double>(), stream_name);
+}
+
+
+void NetImporter::add_species(const vector<string>& tokens) {
+  if (tokens.size() != 3) {
+    errs_line() << "Species line must contain index, species and count.\n";
+    return;
+  }
+
+  uint64_t expected_index = net_species_ids.size() + pending_species_strings.size() + 1;
+  if (!is_integer(tokens[0]) || strtoull(tokens[0].c_str(), nullptr, 10) != expected_index) {
+    errs_line() << "Species index " << tokens[0] << " is invalid, expected " << expected_index << ".\n";
+    return;
+  }
+
+  double count;
+  if (!evaluate(tokens[2], count)) {
+    return;
+  }
+
+  string cplx_string = tokens[1];
+  if (cplx_string[0] == '$') {
+    // constant species are not supported by the engine
+    if (!fixed_species_reported) {
+      warns() << stream_name << ":" << line_nr <<
+          ": Fixed species (prefixed with $) are imported as regular species.\n";
+      fixed_species_reported = true;
+    }
+    cplx_string = cplx_string.substr(1);
+  }
+
+  pending_species_strings.push_back(cplx_string);
+  pending_species_counts.push_back(count);
+
+  if (pending_species_strings.size() >= NET_SPECIES_BATCH_SIZE) {
+    convert_pending_species();
+  }
+}
+
+
+void NetImporter::convert_pending_species() {
+  if (pending_species_strings.empty()) {
+    return;
+  }
+
+  // strings in the form generated by BioNetGen are converted directly,
+  // other strings are parsed with a shared parser context
+  vector<Cplx> cplxs;
+  num_errors += parse_cplx_strings(pending_species_strings, bng_data, cplxs);
+
+  const BNGConfig& bng_config = bng_engine.get_config();
+  SpeciesContainer& all_species = bng_engine.get_all_species();
+  for (size_t i = 0; i < cplxs.size(); i++) {
+    if (cplxs[i].elem_mols.empty()) {
+      // error was already reported
+      net_species_ids.push_back(SPECIES_ID_INVALID);
+      continue;
+    }
+
+    Species s(cplxs[i], bng_data, bng_config, true, species_are_canonical);
+    species_id_t id = all_species.find_or_add(s);
+    net_species_ids.push_back(id);
+
+    if (pending_species_counts[i] != 0) {
+      SeedSpecies ss(&bng_data);
+      ss.cplx = all_species.get(id);
+      ss.count = pending_species_counts[i];
+      bng_data.add_seed_species(ss);
+    }
+  }
+
+  pending_species_strings.clear();
+  pending_species_counts.clear();
+}
+
+
+void NetImporter::add_reaction(const vector<string>& tokens, const string& comment) {
+  if (tokens.size() != 4 || !is_integer(tokens[0])) {
+    errs_line() << "Reaction line must contain index, reactants, products and rate.\n";
+    return;
+  }
+
+  vector<species_id_t> reactant_ids;
+  vector<species_id_t> product_ids;
+  double rate;
+  if (!get_species_ids(tokens[1], reactant_ids) ||
+      !get_species_ids(tokens[2], product_ids) ||
+      !evaluate(tokens[3], rate)) {
+    return;
+  }
+  if (reactant_ids.empty() || reactant_ids.size() > 2) {
+    errs_line() << "Only reactions with one or two reactants are supported.\n";
+    return;
+  }
+
+  SpeciesContainer& all_species = bng_engine.get_all_species();
+  RxnRule r(&bng_data);
+  r.type = RxnType::Standard;
+  // comment contains name of the rule from which the reaction was generated
+  vector<string> comment_tokens;
+  split_by_whitespace(comment, comment_tokens);
+  if (!comment_tokens.empty()) {
+    r.name = comment_tokens[0];
+  }
+  for (species_id_t id: reactant_ids) {
+    r.append_reactant(all_species.get(id));
+  }
+  for (species_id_t id: product_ids) {
+    r.append_product(all_species.get(id));
+  }
+  r.base_rate_constant = rate;
+
+  bng_engine.get_all_rxns().add_explicit_rxn(r, reactant_ids, product_ids);
+}
+
+
+void NetImporter::add_group(const vector<string>& tokens) {
+  if ((tokens.size() != 2 && tokens.size() != 3) || !is_integer(tokens[0])) {
+    errs_line() << "Group line must contain index, name and species.\n";
+    return;
+  }
+
+  NetGroup group;
+  group.name = tokens[1];
+
+  // empty groups have no species list
+  if (tokens.size() == 3) {
+    stringstream ss(tokens[2]);
+    string item;
+    while (getline(ss, item, ',')) {
+      // items are either index or weight*index
+      double weight = 1;
+      string index = item;
+      size_t star_pos = item.find('*');
+      if (star_pos != string::npos) {
+        if (!evaluate(item.substr(0, star_pos), weight)) {
+          return;
+        }
+        index = item.substr(star_pos + 1);
+      }
+
+      species_id_t id;
+      if (!get_species_id(index, id)) {
+        return;
+      }
+      group.species_ids.push_back(id);
+      group.weights.push_back(weight);
+    }
+  }
+
+  groups.push_back(group);
+}
+
+
+// rates and counts are numbers, parameters or their products and quotients such as 2*kp,
+// this is what BioNetGen generates for rates that do not use functions
+bool NetImporter::evaluate(const string& expr, double& res) {
+  res = 1;
+  size_t pos = 0;
+  char op = '*';
+  while (pos <= expr.size()) {
+    size_t end = expr.find_first_of("*/", pos);
+    if (end == string::npos) {
+      end = expr.size();
+    }
+    string factor = expr.substr(pos, end - pos);
+
+    double value;
+    char* num_end;
+    value = strtod(factor.c_str(), &num_end);
+    if (factor.empty() ||
+        (*num_end != '\0' && !bng_data.get_parameter_value(factor, value))) {
+      errs_line() << "Could not evaluate '" << expr << "', only numbers, parameters, " <<
+          "and their products or quotients are supported.\n";
+      return false;
+    }
+
+    res = (op == '*') ? res * value : res / value;
+
+    if (end == expr.size()) {
+      break;
+    }
+    op = expr[end];
+    pos = end + 1;
+  }
+  return true;
+}
+
+
+bool NetImporter::get_species_id(const string& net_index, species_id_t& id) {
+  uint64_t index = is_integer(net_index) ? strtoull(net_index.c_str(), nullptr, 10) : 0;
+  if (index == 0 || index > net_species_ids.size()) {
+    errs_line() << "Species with index '" << net_index << "' was not defined.\n";
+    return false;
+  }
+  id = net_species_ids[index - 1];
+  if (id == SPECIES_ID_INVALID) {
+    // species could not be converted, error was already reported
+    num_errors++;
+    return false;
+  }
+  return true;
+}
+
+
+// index 0 means no species
+bool NetImporter::get_species_ids(const string& net_indices, vector<species_id_t>& ids) {
+  ids.clear();
+  if (net_indices == "0") {
+    return true;
+  }
+
+  stringstream ss(net_indices);
+  string item;
+  while (getline(ss, item, ',')) {
+    species_id_t id;
+    if (!get_species_id(item, id)) {
+      return false;
+    }
+    ids.push_back(id);
+  }
+  return true;
+}
+
+
+int import_net_stream(
+    std::istream& in,
+    BNGEngine& bng_engine,
+    NetGroupVector& groups,
+    const bool species_are_canonical,
+    const std::string& stream_name) {
+
+  NetImporter importer(bng_engine, groups, species_are_canonical, stream_name);
+  return importer.import(in);
+}
+
+
+int import_net_file(
+    const std::string& file_name,
+    BNGEngine& bng_engine,
+    NetGroupVector& groups,
+    const bool species_are_canonical) {
+
+  ifstream in(file_name);
+  if (!in.is_open()) {
+    cerr << "Could not open input file.\n";
+    return 1;
+  }
+
+  return import_net_stream(in, bng_engine, groups, species_are_canonical, file_name);
+}
+
+} /* namespace BNG */
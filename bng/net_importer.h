@@ -0,0 +1,73 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#ifndef LIBS_BNG_NET_IMPORTER_H_
+#define LIBS_BNG_NET_IMPORTER_H_
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "bng/bng_defines.h"
+
+namespace BNG {
+
+class BNGEngine;
+
+/**
+ * Group from the groups section of a .net file,
+ * i.e. an observable evaluated for the species of the network.
+ */
+class NetGroup {
+public:
+  std::string name;
+
+  // species that belong to this group and their weights,
+  // e.g. the number of molecules of the species that match a Molecules observable
+  std::vector<species_id_t> species_ids;
+  std::vector<double> weights;
+};
+
+typedef std::vector<NetGroup> NetGroupVector;
+
+
+// - imports a reaction network in the .net format generated by BioNetGen
+//   into bng_engine whose data must be empty,
+// - sections parameters, compartments, molecule types and observables are processed
+//   in the same way as in a BNGL file, species with a nonzero count are also added
+//   as seed species,
+// - reactions are added as explicit rxns (see RxnContainer::add_explicit_rxn),
+//   so no rxn rule matching is done when their rxn classes are used,
+//   rates may be numbers, parameters or their products such as 2*kp,
+// - when species_are_canonical is true, species strings are trusted to be in canonical
+//   form and are not canonicalized again (see Cplx::assume_canonical),
+// - the input is read in a single pass and species are converted in batches,
+//   so the text of large networks is never held in memory as a whole,
+// - returns number of errors, errors are printed to the error output
+int import_net_file(
+    const std::string& file_name,
+    BNGEngine& bng_engine,
+    NetGroupVector& groups,
+    const bool species_are_canonical = false
+);
+
+
+// same as import_net_file, only the network is read from a stream,
+// stream_name is used instead of a file name in error messages
+int import_net_stream(
+    std::istream& in,
+    BNGEngine& bng_engine,
+    NetGroupVector& groups,
+    const bool species_are_canonical = false,
+    const std::string& stream_name = "<stream>"
+);
+
+} /* namespace BNG */
+
+#endif /* LIBS_BNG_NET_IMPORTER_H_ */
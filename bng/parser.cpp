@@ -10,63 +10,143 @@
 #include <iostream>
 #include <cstdlib>
 #include <stdio.h>
+#include <algorithm>
 
 #include "parser.h"
 
-#include "bngl_scanner.hpp"
 #include "bngl_parser.hpp"
+#include "bngl_scanner.hpp"
 #include "bng/species.h"
 #include "bng/semantic_analyzer.h"
 #include "bng/bng_data.h"
+#include "bng/filesystem_utils.h"
+#include "bng/model_cache.h"
 
 using namespace std;
 
-extern FILE *bnglin;
-
 namespace BNG {
 
-int parse_bngl_file(
+// runs parser on the input set to the scanner and then performs semantic analysis,
+// destroys the scanner
+static int parse_and_analyze(
+    yyscan_t scanner,
+    ParserContext& ctx,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides) {
+
+  // run bison parser
+  int res = bnglparse(scanner, &ctx);
+
+  bngllex_destroy(scanner);
+
+  if (res != 0) {
+    // parse error, do not continue
+    return 1;
+  }
+
+  {
+    BNG::SemanticAnalyzer sema;
+    sema.check_and_convert_parsed_file(&ctx, &bng_data, parameter_overrides);
+  }
+
+  ctx.print_error_report();
+
+  return ctx.get_error_count();
+}
+
+
+static int parse_mapped_file(
+    FSUtils::MappedFile& file,
     const std::string& file_name,
     BNGData& bng_data,
     const std::map<std::string, double>& parameter_overrides) {
 
   bng_data.clear();
 
-  create_parser_context();
-  ParserContext* ctx = get_parser_context();
+  // all parser state is local, multiple files may be parsed concurrently
+  ParserContext ctx;
+  ctx.set_current_file_name(file_name.c_str());
+
+  yyscan_t scanner;
+  bngllex_init_extra(&ctx, &scanner);
+  // size includes the two terminating zero bytes required by flex
+  bngl_scan_buffer(file.get_data(), file.get_size() + 2, scanner);
+  // line number is not initialized by yy_scan_buffer
+  bnglset_lineno(1, scanner);
+
+  return parse_and_analyze(scanner, ctx, bng_data, parameter_overrides);
+}
+
+
+int parse_bngl_file(
+    const std::string& file_name,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides) {
 
-  FILE *infile = fopen(file_name.c_str(), "r");
-  if (infile == nullptr) {
+  // the file is scanned directly from the mapped memory
+  FSUtils::MappedFile file;
+  if (!file.map(file_name)) {
+    bng_data.clear();
     cerr << "Could not open input file.\n";
     return 1;
   }
 
-  ctx->set_current_file_name(file_name.c_str());
-  // set input file for flex
-  bnglin = infile;
-  // run bison parser
-  int res = bnglparse();
-  if (res != 0) {
-    // parse error, do not continue
-    BNG::delete_parser_context();
+  return parse_mapped_file(file, file_name, bng_data, parameter_overrides);
+}
+
+
+int parse_bngl_file_cached(
+    const std::string& file_name,
+    const std::string& cache_file_name,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides) {
+
+  FSUtils::MappedFile file;
+  if (!file.map(file_name)) {
+    bng_data.clear();
+    cerr << "Could not open input file.\n";
     return 1;
   }
 
-  BNG::SemanticAnalyzer sema;
-  sema.check_and_convert_parsed_file(ctx, &bng_data, parameter_overrides);
+  uint64_t key = get_model_cache_key(
+      string_view(file.get_data(), file.get_size()), parameter_overrides);
+  if (load_model_cache(cache_file_name, key, bng_data)) {
+    return 0;
+  }
+
+  int num_errors = parse_mapped_file(file, file_name, bng_data, parameter_overrides);
+  if (num_errors == 0) {
+    if (!save_model_cache(cache_file_name, key, bng_data)) {
+      warns() << "Could not write model cache file " << cache_file_name << ".\n";
+    }
+  }
+  return num_errors;
+}
+
 
-  ctx->print_error_report();
+int parse_bngl_buffer(
+    const std::string_view& buffer,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides,
+    const std::string& buffer_name) {
+
+  bng_data.clear();
 
-  int errors = ctx->get_error_count();
+  ParserContext ctx;
+  ctx.set_current_file_name(buffer_name.c_str());
 
-  BNG::delete_parser_context();
-  fflush(bnglin); // valgrind reports memory leak without this flush call
-  fclose(bnglin);
-  bngllex_destroy();
+  yyscan_t scanner;
+  bngllex_init_extra(&ctx, &scanner);
+  // flex needs its own writable copy terminated with two zero bytes,
+  // this is the only copy made
+  bngl_scan_bytes(buffer.data(), buffer.size(), scanner);
+  // line number is not initialized by yy_scan_bytes
+  bnglset_lineno(1, scanner);
 
-  return errors;
+  return parse_and_analyze(scanner, ctx, bng_data, parameter_overrides);
 }
 
+
 // bng_data are not cleared and one can continue with adding
 // complexes gradually
 int parse_single_cplx_string(
@@ -74,44 +154,259 @@ int parse_single_cplx_string(
     Cplx& res_cplx
 ) {
 
-  create_parser_context();
-  ParserContext* ctx = get_parser_context();
-
+  ParserContext ctx;
+  ctx.set_current_file_name(cplx_string.c_str());
 
   // form input for parser, the !CPLX switches it to a mode where it parses a single string
-  char* input = new char[cplx_string.size() + 32];
-  strcpy(input, "!CPLX ");
-  strcat(input, cplx_string.c_str());
-
-  bngl_scan_string(input);
+  string input = "!CPLX " + cplx_string;
 
-  ctx->set_current_file_name(cplx_string.c_str());
+  yyscan_t scanner;
+  bngllex_init_extra(&ctx, &scanner);
+  bngl_scan_string(input.c_str(), scanner);
+  // flex keeps line number per buffer and yy_scan_* does not initialize it
+  bnglset_lineno(1, scanner);
 
   // run bison parser
-  int res = bnglparse();
+  int res = bnglparse(scanner, &ctx);
 
-  delete [] input;
+  bngllex_destroy(scanner);
 
   if (res != 0) {
     // parse error, do not continue
-    BNG::delete_parser_context();
     return 1;
   }
 
-  BNG::SemanticAnalyzer sema;
+  {
+    BNG::SemanticAnalyzer sema;
+    sema.check_and_convert_single_cplx(&ctx, &bng_data, res_cplx);
+  }
 
-  CplxVector cplx_vec;
+  ctx.print_error_report();
+
+  return ctx.get_error_count();
+}
 
-  sema.check_and_convert_single_cplx(ctx, &bng_data, res_cplx);
 
-  ctx->print_error_report();
+static bool is_id_start_char(const char c) {
+  return isalpha(c) || c == '_';
+}
 
-  int errors = ctx->get_error_count();
 
-  BNG::delete_parser_context();
-  bngllex_destroy();
+static bool is_id_char(const char c) {
+  return isalnum(c) || c == '_';
+}
+
+
+// reads an identifier or a number starting at pos, returns an empty string if there is none
+static string read_id_or_number(const string& s, size_t& pos) {
+  size_t start = pos;
+  if (pos < s.size() && is_id_start_char(s[pos])) {
+    while (pos < s.size() && is_id_char(s[pos])) {
+      pos++;
+    }
+  }
+  else {
+    while (pos < s.size() && isdigit(s[pos])) {
+      pos++;
+    }
+  }
+  return s.substr(start, pos - start);
+}
+
+
+// converts complex string in the form generated by BioNetGen e.g. A(b~P,c!1).C(a!1)
+// without running the parser,
+// returns false if the string uses anything else (compartments, whitespace, ...),
+// if it uses molecule types, components or states that are not defined yet,
+// or if it is not valid, such strings must be processed by the parser
+// that extends the molecule types and reports errors,
+// bng_data are not modified, the result is the same as from
+// SemanticAnalyzer::check_and_convert_single_cplx
+static bool convert_canonical_cplx_string(const string& s, const BNGData& bng_data, Cplx& res) {
+  size_t pos = 0;
+  vector<bond_value_t> numeric_bonds;
+
+  while (true) {
+    string mol_name = read_id_or_number(s, pos);
+    if (mol_name.empty() || !is_id_start_char(mol_name[0])) {
+      return false;
+    }
+
+    elem_mol_type_id_t mt_id = bng_data.find_elem_mol_type_id(mol_name);
+    if (mt_id == ELEM_MOL_TYPE_ID_INVALID) {
+      return false;
+    }
+    const ElemMolType& mt = bng_data.get_elem_mol_type(mt_id);
+
+    ElemMol mi;
+    mi.set_is_vol();
+    mi.elem_mol_type_id = mt_id;
+    mi.compartment_id = COMPARTMENT_ID_NONE;
+
+    if (pos < s.size() && s[pos] == '(') {
+      pos++;
+      while (pos < s.size() && s[pos] != ')') {
+        string comp_name = read_id_or_number(s, pos);
+        if (comp_name.empty() || !is_id_start_char(comp_name[0])) {
+          return false;
+        }
+
+        component_type_id_t ct_id = bng_data.find_component_type_id(mt, comp_name);
+        if (ct_id == COMPONENT_TYPE_ID_INVALID) {
+          return false;
+        }
+
+        // component may be used at most as many times as it was declared
+        size_t num_declared = count(mt.component_type_ids.begin(), mt.component_type_ids.end(), ct_id);
+        size_t num_used = 0;
+        for (const Component& c: mi.components) {
+          if (c.component_type_id == ct_id) {
+            num_used++;
+          }
+        }
+        if (num_used >= num_declared) {
+          return false;
+        }
+
+        Component comp(ct_id);
+        comp.bond_value = BOND_VALUE_UNBOUND;
+
+        if (pos < s.size() && s[pos] == '~') {
+          pos++;
+          string state_name = read_id_or_number(s, pos);
+          // numeric states are converted by the parser e.g. 01 -> 1
+          if (state_name.empty() || (state_name.size() > 1 && state_name[0] == '0')) {
+            return false;
+          }
+          state_id_t state_id = bng_data.find_state_id(state_name);
+          if (state_id == STATE_ID_INVALID ||
+              bng_data.get_component_type(ct_id).allowed_state_ids.count(state_id) == 0) {
+            return false;
+          }
+          comp.state_id = state_id;
+        }
+
+        if (pos < s.size() && s[pos] == '!') {
+          pos++;
+          if (pos < s.size() && s[pos] == '+') {
+            comp.bond_value = BOND_VALUE_BOUND;
+            pos++;
+          }
+          else if (pos < s.size() && s[pos] == '?') {
+            comp.bond_value = BOND_VALUE_ANY;
+            pos++;
+          }
+          else {
+            string bond = read_id_or_number(s, pos);
+            if (bond.empty() || !isdigit(bond[0])) {
+              return false;
+            }
+            comp.bond_value = str_to_bond_value(bond);
+            if (comp.bond_value == BOND_VALUE_INVALID) {
+              return false;
+            }
+            numeric_bonds.push_back(comp.bond_value);
+          }
+        }
+
+        mi.components.push_back(comp);
+
+        if (pos < s.size() && s[pos] == ',') {
+          pos++;
+        }
+        else if (pos >= s.size() || s[pos] != ')') {
+          return false;
+        }
+      }
+      if (pos >= s.size()) {
+        return false;
+      }
+      pos++; // ')'
+    }
+
+    res.elem_mols.push_back(mi);
+
+    if (pos == s.size()) {
+      break;
+    }
+    if (s[pos] != '.') {
+      return false;
+    }
+    pos++;
+  }
+
+  // each bond must be used exactly twice
+  sort(numeric_bonds.begin(), numeric_bonds.end());
+  for (size_t i = 0; i < numeric_bonds.size(); i += 2) {
+    if (i + 1 >= numeric_bonds.size() || numeric_bonds[i] != numeric_bonds[i + 1] ||
+        (i + 2 < numeric_bonds.size() && numeric_bonds[i + 2] == numeric_bonds[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+int parse_cplx_strings(
+    const std::vector<std::string>& cplx_strings, BNGData& bng_data,
+    std::vector<Cplx>& res_cplxs
+) {
+  res_cplxs.clear();
+  res_cplxs.reserve(cplx_strings.size());
+
+  // scanner and semantic analyzer are shared by all strings that need the parser,
+  // each of them gets its own parser context because errors are counted per context
+  yyscan_t scanner = nullptr;
+  BNG::SemanticAnalyzer sema;
+  int num_errors = 0;
+
+  for (const string& cplx_string: cplx_strings) {
+    res_cplxs.push_back(Cplx(&bng_data));
+    Cplx& res_cplx = res_cplxs.back();
+
+    if (convert_canonical_cplx_string(cplx_string, bng_data, res_cplx)) {
+      continue;
+    }
+    res_cplx.elem_mols.clear();
+
+    ParserContext ctx;
+    ctx.set_current_file_name(cplx_string.c_str());
+
+    if (scanner == nullptr) {
+      bngllex_init_extra(&ctx, &scanner);
+    }
+    else {
+      bnglset_extra(&ctx, scanner);
+    }
+
+    string input = "!CPLX " + cplx_string;
+    YY_BUFFER_STATE buffer = bngl_scan_string(input.c_str(), scanner);
+    // line number belongs to the new buffer, it can be set only once the buffer exists
+    bnglset_lineno(1, scanner);
+    int res = bnglparse(scanner, &ctx);
+    bngl_delete_buffer(buffer, scanner);
+
+    if (res != 0) {
+      // parse error, counted as one error same as in parse_single_cplx_string
+      num_errors++;
+      continue;
+    }
+
+    sema.check_and_convert_single_cplx(&ctx, &bng_data, res_cplx);
+
+    ctx.print_error_report();
+    if (ctx.get_error_count() != 0) {
+      res_cplx.elem_mols.clear();
+      num_errors += ctx.get_error_count();
+    }
+  }
+
+  if (scanner != nullptr) {
+    bngllex_destroy(scanner);
+  }
 
-  return errors;
+  return num_errors;
 }
 
 } /* namespace BNG */
@@ -11,7 +11,9 @@
 #define LIBS_BNG_PARSER_H_
 
 #include <string>
+#include <string_view>
 #include <map>
+#include <vector>
 
 #include "bng_defines.h"
 
@@ -23,7 +25,7 @@ class Cplx;
 // parses input BNGL file and performs semantic analysis
 // returns number of errors encountered while parsing
 // prints errors and warnings directly to the error output
-// !! function is not reentrant
+// may be called concurrently from multiple threads with different bng_data
 int parse_bngl_file(
     const std::string& file_name,
     BNGData& bng_data,
@@ -31,6 +33,31 @@ int parse_bngl_file(
 );
 
 
+// same as parse_bngl_file, the result of semantic analysis is stored into
+// cache_file_name and loaded from it next time when the contents of the BNGL file
+// and parameter_overrides are the same (see model_cache.h),
+// the cache is created only when there were no errors,
+// unlike with parse_bngl_file, rxn rules loaded from the cache are not finalized,
+// they are finalized by BNGEngine::initialize (their complexes are already canonical)
+int parse_bngl_file_cached(
+    const std::string& file_name,
+    const std::string& cache_file_name,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides = std::map<std::string, double>()
+);
+
+
+// same as parse_bngl_file, only the model is read from a buffer
+// (e.g. a model generated by another process),
+// buffer_name is used instead of a file name in error messages
+int parse_bngl_buffer(
+    const std::string_view& buffer,
+    BNGData& bng_data,
+    const std::map<std::string, double>& parameter_overrides = std::map<std::string, double>(),
+    const std::string& buffer_name = "<buffer>"
+);
+
+
 // parses input BNGL complex instance or pattern string and performs
 // semantic analysis
 // returns number of errors encountered while parsing
@@ -44,6 +71,20 @@ int parse_single_cplx_string(
 );
 
 
+// parses multiple complex strings, the result is the same as when
+// parse_single_cplx_string is called for each of them,
+// res_cplxs contains one complex for each input string (empty if it could not be parsed)
+// - strings in canonical form that use only already defined molecule types,
+//   components and states (such as species names generated by BioNetGen) are converted
+//   directly without running the parser,
+// - other strings are parsed with a single parser context and scanner
+// returns total number of errors
+int parse_cplx_strings(
+    const std::vector<std::string>& cplx_strings, BNGData& bng_data,
+    std::vector<Cplx>& res_cplxs
+);
+
+
 } /* namespace BNG */
 
 #endif /* LIBS_BNG_PARSER_H_ */
@@ -17,15 +17,12 @@
 
 using namespace std;
 
-extern int bngllineno;
-extern BNG::ParserContext* g_ctx;
-
 namespace BNG {
 
-ostream& errs_loc() {
-  assert(g_ctx != nullptr);
+ostream& errs_loc(const ParserContext* ctx) {
+  assert(ctx != nullptr);
   cerr <<
-      g_ctx->get_current_file_name() << ":" << bngllineno <<
+      ctx->get_current_file_name() << ":" << ctx->get_current_line() <<
       ": error: ";
   return cerr;
 }
@@ -42,28 +39,28 @@ ostream& errs_loc(const ASTBaseNode* loc) {
 }
 
 
-double convert_to_dbl(const char* str) {
+double convert_to_dbl(const char* str, const ParserContext* ctx) {
   char* end;
   double res;
 
   errno = 0; // note: errno is thread-local
   res = strtod(str, &end);
   if (errno != 0 || *end != '\0') {
-    errs_loc() << "Could not convert floating point value '" << str << "'.\n";
+    errs_loc(ctx) << "Could not convert floating point value '" << str << "'.\n";
   }
 
   return res;
 }
 
 
-long long convert_dec_to_llong(const char* str) {
+long long convert_dec_to_llong(const char* str, const ParserContext* ctx) {
   char* end;
   long long int res;
 
   errno = 0; // note: errno is thread-local
   res = strtoll(str, &end, 10);
   if (errno != 0 || *end != '\0') {
-    errs_loc() << "Could not convert integer value '" << str << "'.\n";
+    errs_loc(ctx) << "Could not convert integer value '" << str << "'.\n";
   }
 
   return res;
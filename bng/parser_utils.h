@@ -19,12 +19,14 @@
 namespace BNG {
 
 class ASTBaseNode;
+class ParserContext;
 
-std::ostream& errs_loc();
+// reports error at the current location of the scanner
+std::ostream& errs_loc(const ParserContext* ctx);
 std::ostream& errs_loc(const ASTBaseNode* loc);
 
-double convert_to_dbl(const char* str);
-long long convert_dec_to_llong(const char* str);
+double convert_to_dbl(const char* str, const ParserContext* ctx);
+long long convert_dec_to_llong(const char* str, const ParserContext* ctx);
 
 // same as strdup, only uses 'new' to allocate memory so that we can
 // consistently use 'delete' afterwards to free it
@@ -0,0 +1,164 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#include "bng/product_set_memo.h"
+#include "bng/species_container.h"
+#include "bng/bng_config.h"
+
+using namespace std;
+
+namespace BNG {
+
+const RxnClassPathwayVector* ProductSetMemo::find(
+    const ProductSetMemoKey& key, const SpeciesContainer& all_species) {
+
+  auto it = memo.find(key);
+  if (it == memo.end()) {
+    num_misses++;
+    return nullptr;
+  }
+
+  // product species might have been removed in the meantime,
+  // species ids are not reused so the entry cannot be used anymore
+  for (const RxnClassPathway& pw: it->second.pathways) {
+    if (!pw.products_are_defined) {
+      continue;
+    }
+    for (const ProductSpeciesIdWIndices& prod: pw.product_species_w_indices) {
+      if (!all_species.is_valid_id(prod.product_species_id)) {
+        remove_entry(it);
+        num_misses++;
+        return nullptr;
+      }
+    }
+  }
+
+  // move to the end of the lru order
+  lru_order.splice(lru_order.end(), lru_order, it->second.lru_it);
+
+  num_hits++;
+  return &it->second.pathways;
+}
+
+
+void ProductSetMemo::insert(const ProductSetMemoKey& key, const RxnClassPathwayVector& pathways) {
+  auto res = memo.insert(make_pair(key, Entry()));
+  Entry& entry = res.first->second;
+  entry.pathways = pathways;
+  if (!res.second) {
+    // replacing an existing entry, its key is already indexed
+    lru_order.splice(lru_order.end(), lru_order, entry.lru_it);
+    return;
+  }
+
+  entry.lru_it = lru_order.insert(lru_order.end(), key);
+
+  keys_per_reactant[key.reactant_a_species_id].insert(key);
+  if (key.reactant_b_species_id != SPECIES_ID_INVALID) {
+    keys_per_reactant[key.reactant_b_species_id].insert(key);
+  }
+
+  if (bng_config.max_num_product_set_memo_entries != 0) {
+    remove_least_recently_used_entries();
+  }
+}
+
+
+void ProductSetMemo::set_pathway_products(
+    const ProductSetMemoKey& key, const uint index, const RxnClassPathway& defined_pathway) {
+  assert(defined_pathway.products_are_defined);
+
+  auto it = memo.find(key);
+  if (it == memo.end() || index >= it->second.pathways.size()) {
+    // entry was removed in the meantime
+    return;
+  }
+
+  RxnClassPathway& pw = it->second.pathways[index];
+  assert(pw.rxn_rule_id == defined_pathway.rxn_rule_id);
+  if (!pw.products_are_defined) {
+    pw.product_species_w_indices = defined_pathway.product_species_w_indices;
+    pw.rule_mapping_onto_reactants.clear();
+    pw.products_are_defined = true;
+  }
+}
+
+
+void ProductSetMemo::remove_key_of_reactant(const species_id_t reactant_id, const ProductSetMemoKey& key) {
+  auto it = keys_per_reactant.find(reactant_id);
+  if (it == keys_per_reactant.end()) {
+    return;
+  }
+  it->second.erase(key);
+  if (it->second.empty()) {
+    keys_per_reactant.erase(it);
+  }
+}
+
+
+void ProductSetMemo::remove_entry(EntryMap::iterator it) {
+  // copy, the key is owned by the erased entry
+  ProductSetMemoKey key = it->first;
+
+  lru_order.erase(it->second.lru_it);
+  memo.erase(it);
+
+  remove_key_of_reactant(key.reactant_a_species_id, key);
+  if (key.reactant_b_species_id != SPECIES_ID_INVALID) {
+    remove_key_of_reactant(key.reactant_b_species_id, key);
+  }
+}
+
+
+void ProductSetMemo::remove_least_recently_used_entries() {
+  uint max_entries = bng_config.max_num_product_set_memo_entries;
+  while (memo.size() > max_entries) {
+    assert(!lru_order.empty());
+    auto it = memo.find(lru_order.front());
+    assert(it != memo.end());
+    remove_entry(it);
+  }
+}
+
+
+void ProductSetMemo::remove_species_id_references(const species_id_t id) {
+  auto it = keys_per_reactant.find(id);
+  if (it == keys_per_reactant.end()) {
+    return;
+  }
+
+  // remove_entry also updates keys_per_reactant, so we must work on a copy
+  KeySet keys;
+  keys.swap(it->second);
+  keys_per_reactant.erase(it);
+
+  for (const ProductSetMemoKey& key: keys) {
+    auto memo_it = memo.find(key);
+    assert(memo_it != memo.end());
+    remove_entry(memo_it);
+  }
+}
+
+
+uint ProductSetMemo::get_num_reactant_references() const {
+  uint res = 0;
+  for (const auto& it: keys_per_reactant) {
+    res += it.second.size();
+  }
+  return res;
+}
+
+
+void ProductSetMemo::clear() {
+  memo.clear();
+  keys_per_reactant.clear();
+  lru_order.clear();
+}
+
+} // namespace BNG
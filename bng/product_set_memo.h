@@ -0,0 +1,156 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#ifndef LIBS_BNG_PRODUCT_SET_MEMO_H_
+#define LIBS_BNG_PRODUCT_SET_MEMO_H_
+
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "bng/bng_defines.h"
+#include "bng/rxn_rule.h"
+
+namespace BNG {
+
+class SpeciesContainer;
+class BNGConfig;
+
+// - the order of reactants is the order used by the rxn class, it determines
+//   which reactant pattern of the rule is assigned to which reactant
+//   (see RxnRule::get_bimol_reactant_indices)
+// - reactant_b_species_id is SPECIES_ID_INVALID for unimol rxns
+struct ProductSetMemoKey {
+  ProductSetMemoKey(
+      const rxn_rule_id_t rxn_rule_id_,
+      const species_id_t reactant_a_species_id_,
+      const species_id_t reactant_b_species_id_)
+    : rxn_rule_id(rxn_rule_id_),
+      reactant_a_species_id(reactant_a_species_id_),
+      reactant_b_species_id(reactant_b_species_id_) {
+  }
+
+  bool operator==(const ProductSetMemoKey& other) const {
+    return
+        rxn_rule_id == other.rxn_rule_id &&
+        reactant_a_species_id == other.reactant_a_species_id &&
+        reactant_b_species_id == other.reactant_b_species_id;
+  }
+
+  rxn_rule_id_t rxn_rule_id;
+  species_id_t reactant_a_species_id;
+  species_id_t reactant_b_species_id;
+};
+
+
+struct ProductSetMemoKeyHash {
+  size_t operator()(const ProductSetMemoKey& k) const {
+    size_t h = k.rxn_rule_id;
+    h = h * 1000003 ^ k.reactant_a_species_id;
+    h = h * 1000003 ^ k.reactant_b_species_id;
+    return h;
+  }
+};
+
+
+/**
+ * Remembers pathways computed by RxnRule::define_rxn_pathways_for_specific_reactants
+ * so that a rxn class that was removed (e.g. by cleanup, eviction or reset_caches)
+ * can be recreated without matching and applying the rxn rule again.
+ *
+ * Owned by RxnContainer, contents are kept when rxn classes are deleted.
+ */
+class ProductSetMemo {
+public:
+  ProductSetMemo(const BNGConfig& bng_config_)
+    : num_hits(0),
+      num_misses(0),
+      bng_config(bng_config_) {
+  }
+
+  // - returns nullptr if there is no entry or if the entry references
+  //   a product species that does not exist anymore, such an entry is removed
+  // - pathway_prob of the returned pathways holds the probability multiplicity,
+  //   i.e. the pathway probability is pathway_prob * RxnRule::compute_pathway_probability
+  const RxnClassPathwayVector* find(const ProductSetMemoKey& key, const SpeciesContainer& all_species);
+
+  // the entry might still be rejected by find when its products do not exist anymore
+  bool contains(const ProductSetMemoKey& key) const {
+    return memo.count(key) != 0;
+  }
+
+  // - pathway_prob of the stored pathways must be the probability multiplicity,
+  //   cum_prob is not used
+  // - when bng_config.max_num_product_set_memo_entries is set,
+  //   the least recently used entries are removed
+  void insert(const ProductSetMemoKey& key, const RxnClassPathwayVector& pathways);
+
+  // stores products of a pathway that was defined lazily by a rxn class,
+  // index is the index of the pathway among the pathways of the entry
+  void set_pathway_products(
+      const ProductSetMemoKey& key, const uint index, const RxnClassPathway& defined_pathway);
+
+  // removes all entries that use this species as a reactant,
+  // entries that use it as a product are removed once they are looked up
+  void remove_species_id_references(const species_id_t id);
+
+  void clear();
+
+  uint size() const {
+    return memo.size();
+  }
+
+  uint64_t get_num_hits() const {
+    return num_hits;
+  }
+
+  uint64_t get_num_misses() const {
+    return num_misses;
+  }
+
+  // number of keys stored in the per-reactant index,
+  // each entry is referenced once for each of its distinct reactants
+  uint get_num_reactant_references() const;
+
+private:
+  typedef std::list<ProductSetMemoKey> KeyList;
+  typedef std::unordered_set<ProductSetMemoKey, ProductSetMemoKeyHash> KeySet;
+
+  struct Entry {
+    RxnClassPathwayVector pathways;
+    // position of this entry's key in lru_order
+    KeyList::iterator lru_it;
+  };
+
+  typedef std::unordered_map<ProductSetMemoKey, Entry, ProductSetMemoKeyHash> EntryMap;
+
+  // removes the entry together with its key in lru_order and keys_per_reactant
+  void remove_entry(EntryMap::iterator it);
+  void remove_key_of_reactant(const species_id_t reactant_id, const ProductSetMemoKey& key);
+  void remove_least_recently_used_entries();
+
+  EntryMap memo;
+
+  // used to remove entries once a reactant species is removed,
+  // contains only keys of entries in memo
+  std::unordered_map<species_id_t, KeySet> keys_per_reactant;
+
+  // keys of all entries in memo, least recently used first,
+  // each key is present exactly once
+  KeyList lru_order;
+
+  uint64_t num_hits;
+  uint64_t num_misses;
+
+  const BNGConfig& bng_config;
+};
+
+} // namespace BNG
+
+#endif // LIBS_BNG_PRODUCT_SET_MEMO_H_
@@ -0,0 +1,307 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#include <algorithm>
+#include <set>
+
+#include "bng/reactant_pattern_table.h"
+#include "bng/species_container.h"
+
+using namespace std;
+
+namespace BNG {
+
+// returns true if every component that matches the specific component
+// also matches the general one, explicit bonds of the general component are not supported
+static bool component_is_more_general(const Component& general, const Component& specific) {
+  if (general.component_type_id != specific.component_type_id) {
+    return false;
+  }
+
+  if (general.state_id != STATE_ID_DONT_CARE && general.state_id != specific.state_id) {
+    return false;
+  }
+
+  if (general.bond_value == BOND_VALUE_ANY) {
+    return true;
+  }
+  else if (general.bond_value == BOND_VALUE_UNBOUND) {
+    return specific.bond_value == BOND_VALUE_UNBOUND;
+  }
+  else if (general.bond_value == BOND_VALUE_BOUND) {
+    // !+ or an explicit bond
+    return specific.bond_value != BOND_VALUE_UNBOUND && specific.bond_value != BOND_VALUE_ANY;
+  }
+  else {
+    return false;
+  }
+}
+
+
+// specific component is bound to one of the already used components of the same molecule
+static bool has_bond_to_used_component(
+    const ElemMol& specific, const uint index, const std::vector<bool>& specific_used) {
+  const Component& comp = specific.components[index];
+  if (!comp.bond_has_numeric_value()) {
+    return false;
+  }
+  for (uint i = 0; i < specific.components.size(); i++) {
+    if (specific_used[i] && specific.components[i].bond_value == comp.bond_value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+// finds an injective mapping of the general molecule's components
+// onto the specific molecule's components,
+// pattern matching uses induced subgraphs so the general pattern cannot match
+// when two of its components are mapped onto components bound to each other
+static bool map_components_onto_more_specific(
+    const ElemMol& general, const ElemMol& specific,
+    const uint general_index, std::vector<bool>& specific_used) {
+
+  if (general_index == general.components.size()) {
+    return true;
+  }
+
+  for (uint i = 0; i < specific.components.size(); i++) {
+    if (!specific_used[i] &&
+        component_is_more_general(general.components[general_index], specific.components[i]) &&
+        !has_bond_to_used_component(specific, i, specific_used)) {
+      specific_used[i] = true;
+      if (map_components_onto_more_specific(general, specific, general_index + 1, specific_used)) {
+        return true;
+      }
+      specific_used[i] = false;
+    }
+  }
+  return false;
+}
+
+
+// conservative check that returns true only when every species that matches
+// the specific pattern also matches the general one,
+// only general patterns with a single molecule without compartment are handled
+static bool pattern_is_more_general(const Cplx& general, const Cplx& specific) {
+  if (general.elem_mols.size() != 1) {
+    return false;
+  }
+
+  const ElemMol& general_mol = general.elem_mols[0];
+  if (general_mol.compartment_id != COMPARTMENT_ID_NONE) {
+    return false;
+  }
+
+  // the general molecule must be matched by one of the specific molecules,
+  // the match of specific onto a species then also gives a match of the general pattern
+  for (const ElemMol& specific_mol: specific.elem_mols) {
+    if (specific_mol.elem_mol_type_id != general_mol.elem_mol_type_id ||
+        specific_mol.components.size() < general_mol.components.size()) {
+      continue;
+    }
+
+    vector<bool> specific_used(specific_mol.components.size(), false);
+    if (map_components_onto_more_specific(general_mol, specific_mol, 0, specific_used)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+pattern_id_t ReactantPatternTable::add_pattern(const Cplx& pattern) {
+  assert(pattern.is_finalized());
+
+  string key = pattern.to_str(false, false);
+  auto it = pattern_ids.find(key);
+  if (it != pattern_ids.end()) {
+    return it->second;
+  }
+
+  pattern_id_t id = patterns.size();
+  patterns.push_back(pattern);
+  pattern_symmetries.push_back(GraphSymmetry());
+  compute_pattern_symmetry(pattern.get_graph(), nullptr, nullptr, pattern_symmetries.back());
+  pattern_ids[key] = id;
+  species_known.push_back(boost::dynamic_bitset<>());
+  species_matches_pattern.push_back(boost::dynamic_bitset<>());
+  more_general_patterns.push_back(vector<pattern_id_t>());
+  return id;
+}
+
+
+static bool contains_pattern_id(const vector<pattern_id_t>& sorted_ids, const pattern_id_t id) {
+  return binary_search(sorted_ids.begin(), sorted_ids.end(), id);
+}
+
+
+void ReactantPatternTable::compute_subsumption() {
+  uint n = patterns.size();
+
+  // only patterns with a single molecule may be more general than another pattern
+  // (see pattern_is_more_general), they are bucketed by their molecule type
+  // so that each pattern is compared only with candidates that use one of its molecule types
+  map<elem_mol_type_id_t, vector<pattern_id_t>> candidates_per_type;
+  for (pattern_id_t j = 0; j < n; j++) {
+    if (patterns[j].elem_mols.size() == 1) {
+      candidates_per_type[patterns[j].elem_mols[0].elem_mol_type_id].push_back(j);
+    }
+  }
+
+  // more_general[i] - sorted ids of patterns more general than i
+  vector<vector<pattern_id_t>> more_general(n);
+  for (pattern_id_t i = 0; i < n; i++) {
+    set<elem_mol_type_id_t> types_used;
+    for (const ElemMol& em: patterns[i].elem_mols) {
+      types_used.insert(em.elem_mol_type_id);
+    }
+    for (elem_mol_type_id_t type_id: types_used) {
+      auto it = candidates_per_type.find(type_id);
+      if (it == candidates_per_type.end()) {
+        continue;
+      }
+      for (pattern_id_t j: it->second) {
+        if (i != j && pattern_is_more_general(patterns[j], patterns[i])) {
+          more_general[i].push_back(j);
+        }
+      }
+    }
+    sort(more_general[i].begin(), more_general[i].end());
+  }
+
+  // patterns that are equivalent are not related, this keeps the graph acyclic
+  vector<vector<pattern_id_t>> more_general_wo_equivalent(n);
+  for (pattern_id_t i = 0; i < n; i++) {
+    for (pattern_id_t j: more_general[i]) {
+      if (!contains_pattern_id(more_general[j], i)) {
+        more_general_wo_equivalent[i].push_back(j);
+      }
+    }
+  }
+  more_general.swap(more_general_wo_equivalent);
+
+  // keep only the closest more general patterns, the relation is transitive
+  // so the other ones are checked through them,
+  // a pattern k between i and j has a single molecule of the same type as j
+  // so only patterns from the same bucket need to be checked
+  for (pattern_id_t i = 0; i < n; i++) {
+    more_general_patterns[i].clear();
+
+    map<elem_mol_type_id_t, vector<pattern_id_t>> more_general_per_type;
+    for (pattern_id_t j: more_general[i]) {
+      more_general_per_type[patterns[j].elem_mols[0].elem_mol_type_id].push_back(j);
+    }
+
+    for (const auto& bucket: more_general_per_type) {
+      for (pattern_id_t j: bucket.second) {
+        bool is_closest = true;
+        for (pattern_id_t k: bucket.second) {
+          if (k != j && contains_pattern_id(more_general[k], j)) {
+            is_closest = false;
+            break;
+          }
+        }
+        if (is_closest) {
+          more_general_patterns[i].push_back(j);
+        }
+      }
+    }
+    sort(more_general_patterns[i].begin(), more_general_patterns[i].end());
+  }
+}
+
+
+bool ReactantPatternTable::more_general_pattern_fails(
+    const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) {
+  // the more general patterns are evaluated first, recursively up to the most general ones
+  for (pattern_id_t general_id: more_general_patterns[pattern_id]) {
+    if (!species_matches(general_id, species_id, all_species)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool ReactantPatternTable::known_more_general_pattern_fails(
+    const pattern_id_t pattern_id, const species_id_t species_id) const {
+  for (pattern_id_t general_id: more_general_patterns[pattern_id]) {
+    const boost::dynamic_bitset<>& known = species_known[general_id];
+    if (species_id < known.size() && known[species_id] && !species_matches_pattern[general_id][species_id]) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+bool ReactantPatternTable::compute_match(
+    const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) const {
+  // orientation is ignored, same as in RxnRule::get_reactant_indices_uncached
+  return all_species.get_as_cplx(species_id).matches_pattern(patterns[pattern_id], true);
+}
+
+
+bool ReactantPatternTable::species_matches(
+    const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) {
+  assert(pattern_id < patterns.size());
+
+  boost::dynamic_bitset<>& known = species_known[pattern_id];
+  boost::dynamic_bitset<>& matches = species_matches_pattern[pattern_id];
+  if (species_id < known.size() && known[species_id]) {
+    return matches[species_id];
+  }
+
+  bool res;
+  if (more_general_pattern_fails(pattern_id, species_id, all_species)) {
+    res = false;
+    num_matches_pruned++;
+  }
+  else {
+    res = compute_match(pattern_id, species_id, all_species);
+    num_match_computations++;
+  }
+
+  if (species_id >= known.size()) {
+    known.resize(species_id + 1);
+    matches.resize(species_id + 1);
+  }
+  known[species_id] = true;
+  matches[species_id] = res;
+  return res;
+}
+
+
+bool ReactantPatternTable::species_matches_no_cache_update(
+    const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) const {
+  assert(pattern_id < patterns.size());
+
+  const boost::dynamic_bitset<>& known = species_known[pattern_id];
+  if (species_id < known.size() && known[species_id]) {
+    return species_matches_pattern[pattern_id][species_id];
+  }
+  if (known_more_general_pattern_fails(pattern_id, species_id)) {
+    return false;
+  }
+  return compute_match(pattern_id, species_id, all_species);
+}
+
+
+uint ReactantPatternTable::get_num_pattern_matches(
+    const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) {
+  if (!species_matches(pattern_id, species_id, all_species)) {
+    return 0;
+  }
+  return all_species.get_as_cplx(species_id).get_pattern_num_matches(
+      patterns[pattern_id], pattern_symmetries[pattern_id]);
+}
+
+} // namespace BNG
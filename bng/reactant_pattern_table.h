@@ -0,0 +1,125 @@
+/******************************************************************************
+ * Copyright (C) 2020-2021 by
+ * The Salk Institute for Biological Studies
+ *
+ * Use of this source code is governed by an MIT-style
+ * license that can be found in the LICENSE file or at
+ * https://opensource.org/licenses/MIT.
+******************************************************************************/
+
+#ifndef LIBS_BNG_REACTANT_PATTERN_TABLE_H_
+#define LIBS_BNG_REACTANT_PATTERN_TABLE_H_
+
+#include <vector>
+#include <map>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include "bng/bng_defines.h"
+#include "bng/cplx.h"
+
+namespace BNG {
+
+class SpeciesContainer;
+
+/**
+ * Unique reactant patterns of all rxn rules.
+ *
+ * Many rxn rules use the same reactant pattern (e.g. forward and reverse rules),
+ * results of matching species onto a pattern are cached here once for
+ * all rxn rules that use it.
+ *
+ * Owned by RxnContainer, patterns are added when rxn rules are added.
+ */
+class ReactantPatternTable {
+public:
+  ReactantPatternTable()
+    : num_match_computations(0),
+      num_matches_pruned(0) {
+  }
+
+  // returns id of an existing identical pattern or of a newly added one,
+  // the pattern must be finalized and canonical
+  pattern_id_t add_pattern(const Cplx& pattern);
+
+  uint get_num_patterns() const {
+    return patterns.size();
+  }
+
+  const Cplx& get_pattern(const pattern_id_t id) const {
+    assert(id < patterns.size());
+    return patterns[id];
+  }
+
+  // automorphisms of the pattern, computed when the pattern is added
+  const GraphSymmetry& get_pattern_symmetry(const pattern_id_t id) const {
+    assert(id < pattern_symmetries.size());
+    return pattern_symmetries[id];
+  }
+
+  // computes which patterns are more general than others,
+  // i.e. every species that matches the specific pattern also matches
+  // the general one, called from BNGEngine::initialize once
+  // rxn rule and observable patterns were added,
+  // patterns added later are not used for pruning until this is called again
+  void compute_subsumption();
+
+  // direct more general patterns of a pattern
+  const std::vector<pattern_id_t>& get_more_general_patterns(const pattern_id_t id) const {
+    assert(id < more_general_patterns.size());
+    return more_general_patterns[id];
+  }
+
+  // returns whether species matches pattern, the result is cached,
+  // more general patterns are checked first and if one of them does not
+  // match, the pattern is not matched at all
+  bool species_matches(const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species);
+
+  // does not modify the cache, may be called from multiple threads
+  // as long as no non-const method is called at the same time
+  bool species_matches_no_cache_update(
+      const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) const;
+
+  // returns how many times the pattern matches a species, used for counting of molecules observables,
+  // the cached result of species_matches is used first and symmetric matches are enumerated only once
+  uint get_num_pattern_matches(
+      const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species);
+
+  // number of species->pattern matches that had to be computed
+  uint64_t get_num_match_computations() const {
+    return num_match_computations;
+  }
+
+  // number of species->pattern matches decided by a more general pattern
+  uint64_t get_num_matches_pruned() const {
+    return num_matches_pruned;
+  }
+
+private:
+  bool more_general_pattern_fails(
+      const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species);
+  bool known_more_general_pattern_fails(const pattern_id_t pattern_id, const species_id_t species_id) const;
+
+  bool compute_match(const pattern_id_t pattern_id, const species_id_t species_id, const SpeciesContainer& all_species) const;
+
+  std::vector<Cplx> patterns;
+  std::vector<GraphSymmetry> pattern_symmetries;
+
+  // key is the pattern as a string without orientation (orientation is ignored when matching reactants)
+  std::map<std::string, pattern_id_t> pattern_ids;
+
+  // indexed by pattern id and then by species id
+  std::vector<boost::dynamic_bitset<>> species_known;
+  std::vector<boost::dynamic_bitset<>> species_matches_pattern;
+
+  // indexed by pattern id, set by compute_subsumption,
+  // contains only the closest more general patterns
+  std::vector<std::vector<pattern_id_t>> more_general_patterns;
+
+  uint64_t num_match_computations;
+  uint64_t num_matches_pruned;
+};
+
+} // namespace BNG
+
+#endif // LIBS_BNG_REACTANT_PATTERN_TABLE_H_
@@ -22,10 +22,21 @@ using namespace std;
 namespace BNG {
 
 RxnClass::~RxnClass() {
-  for (rxn_rule_id_t id: rxn_rule_ids) {
-    RxnRule* rxn = all_rxns.get(id);
-    rxn->remove_rxn_class_where_used(this);
+  for (const auto& rule_index: rxn_rule_where_used_indices) {
+    RxnRule* rxn = all_rxns.get(rule_index.first);
+    rxn->remove_rxn_class_where_used(this, rule_index.second);
+  }
+  delete_precomputed_products();
+}
+
+
+void RxnClass::delete_precomputed_products() {
+  for (auto& it: precomputed_products) {
+    for (ProductSpeciesPtrWIndices& product: it.second) {
+      delete product.product_species;
+    }
   }
+  precomputed_products.clear();
 }
 
 
@@ -144,22 +155,117 @@ double RxnClass::get_next_time_of_rxn_rate_update() const {
 }
 
 
-void RxnClass::define_rxn_pathway_using_mapping(const rxn_class_pathway_index_t pathway_index) {
+void RxnClass::define_rxn_pathway_using_products(
+    const rxn_class_pathway_index_t pathway_index, ProductCplxWIndicesVector& product_cplxs) {
   release_assert(pathways_and_rates_initialized);
 
-  vector<species_id_t> reactant_species;
-  for (auto& r: reactant_ids) {
-    reactant_species.push_back(r);
+  RxnClassPathway& pathway = pathways[pathway_index];
+  rxn_rule_id_t rxn_rule_id = pathway.rxn_rule_id;
+  RxnRule::define_rxn_pathway_using_products(all_species, product_cplxs, pathway);
+
+  assert(num_undefined_pathways > 0);
+  num_undefined_pathways--;
+
+#ifndef MCELL4_REVERSED_RXNS_IN_RXN_CLASS
+  // pathways of a single rxn rule are stored in the same order as in the product set memo
+  uint index_for_rxn_rule = 0;
+  while (index_for_rxn_rule < (uint)pathway_index &&
+      pathways[pathway_index - index_for_rxn_rule - 1].rxn_rule_id == rxn_rule_id) {
+    index_for_rxn_rule++;
+  }
+  ProductSetMemoKey key(
+      rxn_rule_id, reactant_ids[0], (is_bimol() ? reactant_ids[1] : SPECIES_ID_INVALID));
+  all_rxns.get_product_set_memo().set_pathway_products(key, index_for_rxn_rule, pathway);
+#endif
+}
+
+
+// - product species are found or created only when a pathway is queried and in the
+//   order of queries, the policy only decides when the products are computed,
+//   therefore it cannot change the results,
+// - products of the queried pathway are computed on demand unless they were precomputed,
+//   once the class is hot, products of all its remaining pathways are precomputed
+void RxnClass::define_products_for_query(const rxn_class_pathway_index_t pathway_index) {
+  num_product_queries++;
+
+  if (!pathways[pathway_index].products_are_defined) {
+    auto it = precomputed_products.find(pathway_index);
+    if (it != precomputed_products.end()) {
+      define_rxn_pathway_using_products(pathway_index, it->second);
+      precomputed_products.erase(it);
+    }
+    else {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+      const RxnRule* rxn = all_rxns.get(pathways[pathway_index].rxn_rule_id);
+      ProductCplxWIndicesVector product_cplxs;
+      rxn->compute_pathway_products_using_mapping(
+          all_species, bng_config, reactant_ids, pathways[pathway_index], product_cplxs);
+      define_rxn_pathway_using_products(pathway_index, product_cplxs);
+
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      time_computing_products_on_query += elapsed.count();
+      num_pathways_computed_on_query++;
+    }
+  }
+
+  if (is_hot_for_product_precomputation()) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    uint num_precomputed = precompute_pathway_products();
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    all_rxns.add_product_precomputation_time(elapsed.count(), num_precomputed);
+  }
+}
+
+
+// - the class is hot when it is selected repeatedly, i.e. at least half of its product queries
+//   used pathways that were already defined,
+// - and when the time already spent on computing its products on demand reached
+//   the estimated time to precompute products of all its remaining pathways
+//   (rent-or-buy rule, at most twice the time of the better of the two choices is spent),
+// - the estimate uses the measured time of earlier precomputations of all rxn classes,
+//   or the time of computing products of this class on demand when there were none
+bool RxnClass::is_hot_for_product_precomputation() const {
+  assert(num_undefined_pathways >= precomputed_products.size());
+  uint num_remaining = num_undefined_pathways - precomputed_products.size();
+  if (num_remaining == 0 || num_pathways_computed_on_query == 0) {
+    return false;
+  }
+
+  if (num_product_queries < 2 * num_pathways_computed_on_query) {
+    return false;
+  }
+
+  double time_per_pathway = all_rxns.get_avg_product_precomputation_time();
+  if (time_per_pathway == FLT_INVALID) {
+    time_per_pathway = time_computing_products_on_query / num_pathways_computed_on_query;
   }
+  return time_computing_products_on_query >= time_per_pathway * num_remaining;
+}
+
+
+uint RxnClass::precompute_pathway_products() {
+  release_assert(pathways_and_rates_initialized);
 
-  const RxnRule* rxn = all_rxns.get(pathways[pathway_index].rxn_rule_id);
-  rxn->define_rxn_pathway_using_mapping(all_species, bng_config, reactant_species, pathways[pathway_index]);
+  uint num_precomputed = 0;
+  for (size_t i = 0; i < pathways.size(); i++) {
+    if (pathways[i].products_are_defined || precomputed_products.count(i) != 0) {
+      continue;
+    }
+    const RxnRule* rxn = all_rxns.get(pathways[i].rxn_rule_id);
+    rxn->compute_pathway_products_using_mapping(
+        all_species, bng_config, reactant_ids, pathways[i], precomputed_products[i]);
+    num_precomputed++;
+  }
+  assert(num_undefined_pathways == precomputed_products.size());
+  return num_precomputed;
 }
 
 
 // based on MCell3's binary_search_double
 rxn_class_pathway_index_t RxnClass::get_pathway_index_for_probability(
     const double prob, const double local_prob_factor) {
+  mark_used();
   if (!pathways_and_rates_initialized) {
     // when a rxn class has only 1 rxn rule, the total prob may not be queried before
     init_rxn_pathways_and_rates();
@@ -188,6 +294,72 @@ rxn_class_pathway_index_t RxnClass::get_pathway_index_for_probability(
 }
 
 
+void RxnClass::build_pathway_alias_table() {
+  uint n = pathways.size();
+  assert(n > 0);
+
+  alias_table_probs.resize(n);
+  alias_table_indices.resize(n);
+
+  double total = 0;
+  for (const RxnClassPathway& pw: pathways) {
+    total += pw.pathway_prob;
+  }
+
+  if (total <= 0) {
+    // no pathway can be selected by probability, all are considered equal
+    for (uint i = 0; i < n; i++) {
+      alias_table_probs[i] = 1.0;
+      alias_table_indices[i] = i;
+    }
+    return;
+  }
+
+  // probabilities scaled so that their average is 1
+  vector<double> scaled(n);
+  vector<uint> small;
+  vector<uint> large;
+  for (uint i = 0; i < n; i++) {
+    scaled[i] = pathways[i].pathway_prob * n / total;
+    if (scaled[i] < 1.0) {
+      small.push_back(i);
+    }
+    else {
+      large.push_back(i);
+    }
+  }
+
+  while (!small.empty() && !large.empty()) {
+    uint s = small.back();
+    small.pop_back();
+    uint l = large.back();
+    large.pop_back();
+
+    alias_table_probs[s] = scaled[s];
+    alias_table_indices[s] = l;
+
+    // the large column gives away what the small one was missing
+    scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+    if (scaled[l] < 1.0) {
+      small.push_back(l);
+    }
+    else {
+      large.push_back(l);
+    }
+  }
+
+  // remaining columns are full, small ones may remain only due to rounding errors
+  for (uint l: large) {
+    alias_table_probs[l] = 1.0;
+    alias_table_indices[l] = l;
+  }
+  for (uint s: small) {
+    alias_table_probs[s] = 1.0;
+    alias_table_indices[s] = s;
+  }
+}
+
+
 // function for computing the probability factor (pb_factor) used to
 // convert reaction rate constants into probabilities
 double RxnClass::compute_pb_factor() const {
@@ -396,7 +568,8 @@ void RxnClass::add_rxn_rule_no_update(RxnRule* r) {
   rxn_rule_ids.push_back(r->id);
 
   // remember bidirectional mapping for rxn rate updates
-  r->add_rxn_class_where_used(this);
+  uint index = r->add_rxn_class_where_used(this);
+  rxn_rule_where_used_indices.push_back(make_pair(r->id, index));
 
   // and also set rxn class type
   const RxnRule* rxn = all_rxns.get(r->id);
@@ -410,15 +583,47 @@ void RxnClass::add_rxn_rule_no_update(RxnRule* r) {
 }
 
 
+void RxnClass::add_explicit_pathway(RxnRule* r, const RxnProductsVector& products) {
+  assert(r->is_explicit());
+  release_assert((explicit_pathways || rxn_rule_ids.empty()) &&
+      "Explicit pathways cannot be mixed with rxn rules that are matched onto reactants");
+
+  add_rxn_rule_no_update(r);
+
+  // probability is computed in init_rxn_pathways_and_rates
+  pathways.push_back(RxnClassPathway(r->id, FLT_INVALID, products));
+
+  explicit_pathways = true;
+  pathways_and_rates_initialized = false;
+}
+
+
 // based on mcell3's implementation init_reactions
 // but added support for cases where one reaction rule can have multiple sets of products
-void RxnClass::init_rxn_pathways_and_rates(const bool force_update) {
+void RxnClass::init_rxn_pathways_and_rates(
+    const bool force_update,
+    std::map<rxn_rule_id_t, ComplexRxnProductSets>* computed_product_sets) {
   if (!force_update && pathways_and_rates_initialized) {
     return;
   }
 
   assert(!reactant_ids.empty());
 
+  if (explicit_pathways) {
+    // products are known, only probabilities are computed,
+    // the pathways are kept in the order in which they were added
+    double pb_factor = compute_pb_factor();
+    for (RxnClassPathway& pw: pathways) {
+      const RxnRule* rxn = all_rxns.get(pw.rxn_rule_id);
+      pw.pathway_prob = rxn->compute_pathway_probability(bng_config, pb_factor);
+    }
+    num_undefined_pathways = 0;
+
+    finalize_pathway_probabilities();
+    pathways_and_rates_initialized = true;
+    return;
+  }
+
 #ifdef ORDER_RXNS_IN_RXN_CLASS_BY_NAME
   sort(rxn_rules.begin(), rxn_rules.end(),
       [](const RxnRule* a, const RxnRule* b) -> bool {
@@ -435,17 +640,51 @@ void RxnClass::init_rxn_pathways_and_rates(const bool force_update) {
   // 2) define pathways
   // sort rules by ID to make sure we get identical results all the time
   sort(rxn_rule_ids.begin(), rxn_rule_ids.end());
+  // products computed earlier for the same reactants are taken from the memo,
+  // the probabilities always use the current rates
+  ProductSetMemo& product_set_memo = all_rxns.get_product_set_memo();
+  species_id_t reactant_b_id = is_bimol() ? reactant_ids[1] : SPECIES_ID_INVALID;
   for (rxn_rule_id_t id: rxn_rule_ids) {
 
     RxnRule* rxn = all_rxns.get(id);
+    ProductSetMemoKey key(id, reactant_ids[0], reactant_b_id);
+
+    const RxnClassPathwayVector* memoized = product_set_memo.find(key, all_species);
+    if (memoized != nullptr) {
+      assert(computed_product_sets == nullptr || computed_product_sets->count(id) == 0);
+      double prob = rxn->compute_pathway_probability(bng_config, pb_factor);
+      for (const RxnClassPathway& pw: *memoized) {
+        pathways.push_back(pw);
+        pathways.back().pathway_prob = pw.pathway_prob * prob;
+      }
+      continue;
+    }
+
+    ComplexRxnProductSets* computed = nullptr;
+    if (computed_product_sets != nullptr) {
+      auto it_computed = computed_product_sets->find(id);
+      if (it_computed != computed_product_sets->end()) {
+        computed = &it_computed->second;
+      }
+    }
+
+    size_t first_new = pathways.size();
     rxn->define_rxn_pathways_for_specific_reactants(
         all_species,
         bng_config,
         reactant_ids[0],
-        (is_bimol() ? reactant_ids[1] : SPECIES_ID_INVALID),
+        reactant_b_id,
         pb_factor,
-        pathways
+        pathways,
+        computed
     );
+
+    // each of the pathways has the probability of the rxn rule
+    RxnClassPathwayVector new_pathways(pathways.begin() + first_new, pathways.end());
+    for (RxnClassPathway& pw: new_pathways) {
+      pw.pathway_prob = 1;
+    }
+    product_set_memo.insert(key, new_pathways);
   }
   assert(!pathways.empty());
 
@@ -466,7 +705,60 @@ void RxnClass::init_rxn_pathways_and_rates(const bool force_update) {
   pathways = rev_pathways;
 #endif
 
-  // 3) compute cumulative properties
+  delete_precomputed_products();
+  num_undefined_pathways = 0;
+  num_product_queries = 0;
+  num_pathways_computed_on_query = 0;
+  time_computing_products_on_query = 0;
+  for (const RxnClassPathway& pw: pathways) {
+    if (!pw.products_are_defined) {
+      num_undefined_pathways++;
+    }
+  }
+
+  // 3) compute cumulative properties and check them
+  finalize_pathway_probabilities();
+
+  pathways_and_rates_initialized = true;
+}
+
+
+void RxnClass::get_rxn_rule_ids_for_product_computation(std::vector<rxn_rule_id_t>& ids) const {
+  if (pathways_and_rates_initialized || explicit_pathways) {
+    return;
+  }
+
+  species_id_t reactant_b_id = is_bimol() ? reactant_ids[1] : SPECIES_ID_INVALID;
+  for (rxn_rule_id_t id: rxn_rule_ids) {
+    const RxnRule* rxn = all_rxns.get(id);
+    if (!rxn->is_simple() &&
+        !all_rxns.get_product_set_memo().contains(ProductSetMemoKey(id, reactant_ids[0], reactant_b_id))) {
+      ids.push_back(id);
+    }
+  }
+}
+
+
+void RxnClass::update_pathway_probabilities() {
+  if (!pathways_and_rates_initialized) {
+    // will be computed once needed
+    return;
+  }
+
+  // pb_factor depends only on reactants, not on rate constants
+  double pb_factor = compute_pb_factor();
+  for (RxnClassPathway& pw: pathways) {
+    const RxnRule* rxn = all_rxns.get(pw.rxn_rule_id);
+    pw.pathway_prob = rxn->compute_pathway_probability(bng_config, pb_factor);
+  }
+
+  finalize_pathway_probabilities();
+}
+
+
+void RxnClass::finalize_pathway_probabilities() {
+  assert(!pathways.empty());
+
   pathways[0].cum_prob = pathways[0].pathway_prob;
   for (uint i = 1; i < pathways.size(); i++) {
     pathways[i].cum_prob = pathways[i].pathway_prob + pathways[i-1].cum_prob;
@@ -481,6 +773,8 @@ void RxnClass::init_rxn_pathways_and_rates(const bool force_update) {
     max_fixed_p = 1.0;
   }
 
+  build_pathway_alias_table();
+
   if (bng_config.rxn_and_species_report) {
     append_to_report(bng_config.get_rxn_report_file_name(), to_str() + "\n\n");
   }
@@ -510,8 +804,6 @@ void RxnClass::init_rxn_pathways_and_rates(const bool force_update) {
         "Please check your reaction rates in reaction class:\n" << to_str() << "\n";
     exit(1);
   }
-
-  pathways_and_rates_initialized = true;
 }
 
 
@@ -527,8 +819,11 @@ void RxnClass::update_variable_rxn_rates(const double current_time) {
       any_changed = true;
     }
   }
-  if (!pathways_and_rates_initialized || any_changed) {
-    init_rxn_pathways_and_rates(true);
+  if (!pathways_and_rates_initialized) {
+    init_rxn_pathways_and_rates();
+  }
+  else if (any_changed) {
+    update_pathway_probabilities();
   }
 
   // report
@@ -12,6 +12,7 @@
 
 #include <string>
 #include <iostream>
+#include <map>
 
 #include "bng/bng_defines.h"
 #include "bng/rxn_rule.h"
@@ -30,6 +31,9 @@ class SpeciesContainer;
  */
 class RxnClass {
 public:
+  // index into the rxn class pool of RxnContainer, the id is reused once this rxn class is deleted
+  rxn_class_id_t id;
+
   // Standard reaction or special such as Reflect, Transparent or Absorb
   RxnType type;
 
@@ -51,6 +55,10 @@ private:
   // reactions are owned by RxnContainer, order in this vector is important
   std::vector<rxn_rule_id_t> rxn_rule_ids;
 
+  // index of this rxn class in RxnRule::rxn_classes_where_used of each of its rxn rules,
+  // not sorted unlike rxn_rule_ids
+  std::vector<std::pair<rxn_rule_id_t, uint>> rxn_rule_where_used_indices;
+
   // Maximum probability for region of p-space for all non-cooperative pathways,
   // valid when pathways_and_rates_initialized is true
   double max_fixed_p;
@@ -69,14 +77,43 @@ private:
   // flag for initialization of pathways on-demand
   bool pathways_and_rates_initialized;
 
+  // pathways were added with their products by add_explicit_pathway and
+  // are never computed from rxn rules, only their probabilities are updated
+  bool explicit_pathways;
+
+  // lazy product policy, see define_products_for_query,
+  // statistics are reset when pathways are initialized
+  uint num_undefined_pathways;
+  uint num_product_queries;
+  uint num_pathways_computed_on_query;
+  double time_computing_products_on_query; // in seconds
+
+  // products computed ahead of time for undefined pathways, indexed by pathway index,
+  // owns the product species until they are used to define the pathway
+  std::map<rxn_class_pathway_index_t, ProductCplxWIndicesVector> precomputed_products;
+
+  // rxn class cache of RxnContainer, the flag is cleared by its CLOCK eviction,
+  // see mark_used
+  bool used_recently;
+  uint64_t num_uses;
+
+  // Walker's alias table for get_pathway_index_for_uniform_random,
+  // valid when pathways_and_rates_initialized is true, indexed by pathway index,
+  // probs are probabilities to keep the column, indices are the alternatives
+  std::vector<double> alias_table_probs;
+  std::vector<rxn_class_pathway_index_t> alias_table_indices;
+
 public:
   RxnClass(
       RxnContainer& all_rxns_, SpeciesContainer& all_species_, const BNGConfig& bng_config_,
       const species_id_t reactant1_id, const species_id_t reactant2_id = SPECIES_ID_INVALID)
-    : type(RxnType::Invalid), max_fixed_p(FLT_INVALID),
+    : id(RXN_CLASS_ID_INVALID), type(RxnType::Invalid), max_fixed_p(FLT_INVALID),
       all_rxns(all_rxns_), all_species(all_species_), bng_config(bng_config_),
       bimol_vol_rxn_flag(false), intermembrane_surf_surf_rxn_flag(false),
-      pathways_and_rates_initialized(false)
+      pathways_and_rates_initialized(false), explicit_pathways(false),
+      num_undefined_pathways(0), num_product_queries(0), num_pathways_computed_on_query(0),
+      time_computing_products_on_query(0),
+      used_recently(true), num_uses(0)
     {
     reactant_ids.push_back(reactant1_id);
     if (reactant2_id != SPECIES_ID_INVALID) {
@@ -84,7 +121,7 @@ public:
     }
   }
 
-  // RxnRules may have pointers to rxn classes that use them, we must
+  // RxnRules have links to rxn classes that use them, we must
   // remove these links in the destructor
   ~RxnClass();
 
@@ -104,9 +141,45 @@ public:
     return pathways.size();
   }
 
+  // number of pathways whose product species were not defined yet
+  uint get_num_undefined_pathways() const {
+    return num_undefined_pathways;
+  }
+
+  // number of undefined pathways whose products were already computed
+  uint get_num_precomputed_pathways() const {
+    return precomputed_products.size();
+  }
+
+  // number of product queries while some pathways were undefined
+  uint get_num_product_queries() const {
+    return num_product_queries;
+  }
+
+  // - marks this rxn class as recently used so that it is not evicted by
+  //   RxnContainer::evict_cold_rxn_classes and counts the use as a rxn class cache hit,
+  // - called when the rxn class is looked up in RxnContainer, when its probability is
+  //   queried and when a pathway is selected
+  void mark_used() {
+    used_recently = true;
+    num_uses++;
+  }
+
+  // returns whether the class was used since the last call, used by the CLOCK eviction
+  bool clear_used_recently() {
+    bool res = used_recently;
+    used_recently = false;
+    return res;
+  }
+
+  uint64_t get_num_uses() const {
+    return num_uses;
+  }
+
   // first query for the max probability or for rxn rate update usually causes
   // rxn pathways to be initialized
   double get_max_fixed_p() {
+    mark_used();
     if (!pathways_and_rates_initialized) {
       init_rxn_pathways_and_rates();
     }
@@ -122,23 +195,79 @@ public:
 
     assert((size_t)pathway_index < pathways.size());
 
-    if (pathways[pathway_index].products_are_defined) {
-      return pathways[pathway_index].product_species_w_indices;
-    }
-    else {
-      define_rxn_pathway_using_mapping(pathway_index);
-      return pathways[pathway_index].product_species_w_indices;
+    if (num_undefined_pathways != 0) {
+      define_products_for_query(pathway_index);
     }
+    assert(pathways[pathway_index].products_are_defined);
+    return pathways[pathway_index].product_species_w_indices;
   }
 
+  // - computes products of all undefined pathways ahead of time,
+  // - species of the products are still found or created only once the pathway is queried,
+  //   so the species ids and all results are the same as when products are computed lazily,
+  // - does not modify species or other rxn classes, so it may be called concurrently
+  //   for different rxn classes once their pathways are initialized,
+  // - returns the number of pathways whose products were computed
+  uint precompute_pathway_products();
+
+  // - selects pathway using binary search over cumulative probabilities,
+  // - prob is in the range [0, max_fixed_p * local_prob_factor),
+  // - this is the MCell3-compatible mode, for the same random number gives
+  //   the same pathway as MCell3
   rxn_class_pathway_index_t get_pathway_index_for_probability(
       const double prob, const double local_prob_factor);
 
+  // - selects pathway in constant time using the alias table,
+  //   each pathway is selected with probability pathway_prob / max_fixed_p,
+  // - uniform_random is in the range [0, 1),
+  // - for a given random number, the result differs from get_pathway_index_for_probability
+  rxn_class_pathway_index_t get_pathway_index_for_uniform_random(const double uniform_random) {
+    mark_used();
+    if (!pathways_and_rates_initialized) {
+      init_rxn_pathways_and_rates();
+    }
+    assert(uniform_random >= 0 && uniform_random < 1);
+    assert(!alias_table_probs.empty() && alias_table_probs.size() == pathways.size());
+
+    double scaled = uniform_random * alias_table_probs.size();
+    uint column = (uint)scaled;
+    if (column >= alias_table_probs.size()) {
+      // may happen due to rounding
+      column = alias_table_probs.size() - 1;
+    }
+    if (scaled - column < alias_table_probs[column]) {
+      return column;
+    }
+    else {
+      return alias_table_indices[column];
+    }
+  }
+
   orientation_t get_reactant_orientation(uint reactant_index) const;
 
   // does not do pathways update
   void add_rxn_rule_no_update(RxnRule* r);
 
+  // called by RxnRule when this rxn class was moved in its list of rxn classes
+  void set_rxn_rule_where_used_index(const rxn_rule_id_t id, const uint index) {
+    for (auto& rule_index: rxn_rule_where_used_indices) {
+      if (rule_index.first == id) {
+        rule_index.second = index;
+        return;
+      }
+    }
+    assert(false && "Rxn rule is not used by this rxn class");
+  }
+
+  // adds an explicit rxn rule (see RxnRule::finalize_explicit) along with a pathway
+  // that has the given products, rxn classes with explicit pathways
+  // cannot contain rxn rules whose pathways are computed by matching
+  void add_explicit_pathway(RxnRule* r, const RxnProductsVector& products);
+
+  bool has_explicit_pathways() const {
+    return explicit_pathways;
+  }
+
   // this function expects that update_rxn_rates_if_needed was called
   // already for the current time
   double get_next_time_of_rxn_rate_update() const;
@@ -221,8 +350,21 @@ public:
   // products of this rxn class are needed, called on-demand
   // because computing even initial pathways without specific product species
   // for complex (and long) reactants may be costly)
-  // used also when rates are updated
-  void init_rxn_pathways_and_rates(const bool force_update = false);
+  // used also when rates are updated,
+  // computed_product_sets may contain products of complex rxn rules computed ahead
+  // of time for the reactants of this class, their species are taken over
+  void init_rxn_pathways_and_rates(
+      const bool force_update = false,
+      std::map<rxn_rule_id_t, ComplexRxnProductSets>* computed_product_sets = nullptr);
+
+  // complex rxn rules whose products must be computed by init_rxn_pathways_and_rates
+  // because they are not in the product set memo, empty when the pathways are initialized
+  void get_rxn_rule_ids_for_product_computation(std::vector<rxn_rule_id_t>& ids) const;
+
+  // - recomputes probabilities of existing pathways after rate constants of
+  //   rxn rules changed, products and order of pathways are kept,
+  // - does nothing if pathways were not initialized yet
+  void update_pathway_probabilities();
 
   void remove_from_rxn_rule_users_list();
 
@@ -233,7 +375,17 @@ public:
 
 private:
 
-  void define_rxn_pathway_using_mapping(const rxn_class_pathway_index_t pathway_index);
+  // uses and releases product_cplxs
+  void define_rxn_pathway_using_products(
+      const rxn_class_pathway_index_t pathway_index, ProductCplxWIndicesVector& product_cplxs);
+
+  // called for product queries while some pathways are undefined,
+  // defines the queried pathway and applies the lazy product policy
+  void define_products_for_query(const rxn_class_pathway_index_t pathway_index);
+
+  bool is_hot_for_product_precomputation() const;
+
+  void delete_precomputed_products();
 
   void update_variable_rxn_rates(const double current_time);
 
@@ -246,6 +398,13 @@ private:
   double get_reactant_time_step(const uint reactant_index) const;
 
   double compute_pb_factor() const;
+
+  // computes cumulative probabilities, max_fixed_p and the alias table from pathway probabilities,
+  // reports and checks the resulting probability
+  void finalize_pathway_probabilities();
+
+  // builds the alias table using Vose's method, expects that pathways are initialized
+  void build_pathway_alias_table();
 };
 
 
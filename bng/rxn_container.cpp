@@ -13,14 +13,38 @@
 #include <iostream>
 #include <sstream>
 #include <bitset>
+#include <thread>
+#include <chrono>
+#include <set>
 
 using namespace std;
 
 namespace BNG {
 
+// calls func(begin, end) on consecutive chunks of [0, size), each in its own thread
+template<class F>
+static void run_in_parallel(const size_t size, const uint num_threads, const F& func) {
+  if (num_threads <= 1 || size < 2) {
+    func(0, size);
+    return;
+  }
+
+  size_t chunk_size = (size + num_threads - 1) / num_threads;
+  std::vector<std::thread> threads;
+  for (size_t begin = 0; begin < size; begin += chunk_size) {
+    threads.push_back(
+        std::thread(func, begin, std::min(begin + chunk_size, size)));
+  }
+  for (std::thread& t: threads) {
+    t.join();
+  }
+}
+
+
 RxnContainer::~RxnContainer() {
-  for (RxnClass* rc: rxn_classes) {
-    delete rc;
+  delete_all_rxn_classes();
+  for (RxnClassStorage* block: rxn_class_blocks) {
+    delete [] block;
   }
 
   for (RxnRule* rxn: rxn_rules) {
@@ -34,10 +58,8 @@ RxnContainer::~RxnContainer() {
 
 
 void RxnContainer::reset_caches() {
-  for (RxnClass* rc: rxn_classes) {
-    delete rc;
-  }
-  rxn_classes.clear();
+  // the memory blocks of the rxn class pool are kept and will be reused
+  delete_all_rxn_classes();
 
   species_processed_for_bimol_rxn_classes.clear();
   species_processed_for_bimol_rxn_classes.shrink();
@@ -50,6 +72,14 @@ void RxnContainer::reset_caches() {
   for (RxnRule* rxn: rxn_rules) {
     rxn->reset_rxn_classes_where_used();
   }
+
+  // rxn classes of explicit rxns are not created on-demand
+  species_with_explicit_rxn_classes.clear();
+  for (RxnRule* rxn: rxn_rules) {
+    if (rxn->is_explicit()) {
+      add_explicit_rxn_to_rxn_class(rxn);
+    }
+  }
 }
 
 
@@ -115,11 +145,85 @@ rxn_rule_id_t RxnContainer::add_and_finalize(const RxnRule& r) {
   RxnRule* new_r = new RxnRule(r);
   new_r->id = rxn_rules.size();
   new_r->finalize();
+  new_r->set_reactant_pattern_table(reactant_pattern_table);
   rxn_rules.push_back(new_r);
   return new_r->id;
 }
 
 
+void RxnContainer::add_and_finalize(
+    const std::vector<RxnRule>& rules, std::vector<rxn_rule_id_t>& ids, const uint num_threads) {
+
+  // 1) copy and finalize the rules in parallel, each rule is independent and
+  //    its id is given by its index
+  rxn_rule_id_t first_id = rxn_rules.size();
+  std::vector<RxnRule*> new_rules(rules.size(), nullptr);
+  auto finalize_rules = [&rules, &new_rules, first_id](const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      RxnRule* new_r = new RxnRule(rules[i]);
+      new_r->id = first_id + i;
+      new_r->finalize();
+      new_rules[i] = new_r;
+    }
+  };
+  run_in_parallel(rules.size(), num_threads, finalize_rules);
+
+  // 2) the reactant pattern table is shared, register the patterns in the order of ids
+  ids.clear();
+  for (RxnRule* new_r: new_rules) {
+    new_r->set_reactant_pattern_table(reactant_pattern_table);
+    rxn_rules.push_back(new_r);
+    ids.push_back(new_r->id);
+  }
+}
+
+
+rxn_rule_id_t RxnContainer::add_explicit_rxn(
+    const RxnRule& r,
+    const std::vector<species_id_t>& reactant_ids,
+    const std::vector<species_id_t>& product_ids) {
+
+  RxnRule* new_r = new RxnRule(r);
+  new_r->id = rxn_rules.size();
+  new_r->finalize_explicit(reactant_ids, product_ids);
+  rxn_rules.push_back(new_r);
+
+  add_explicit_rxn_to_rxn_class(new_r);
+  return new_r->id;
+}
+
+
+void RxnContainer::add_explicit_rxn_to_rxn_class(RxnRule* r) {
+  const std::vector<species_id_t>& reactant_ids = r->get_explicit_reactant_species_ids();
+  const std::vector<species_id_t>& product_ids = r->get_explicit_product_species_ids();
+
+  RxnClass* rxn_class;
+  if (r->is_unimol()) {
+    rxn_class = get_or_create_empty_unimol_rxn_class(reactant_ids[0]);
+  }
+  else {
+    release_assert(r->is_bimol() && "Explicit rxns must have one or two reactants");
+    rxn_class = get_or_create_empty_bimol_rxn_class(reactant_ids[0], reactant_ids[1]);
+  }
+
+  RxnProductsVector products;
+  for (uint i = 0; i < product_ids.size(); i++) {
+    products.push_back(ProductSpeciesIdWIndices(product_ids[i], i));
+  }
+  rxn_class->add_explicit_pathway(r, products);
+
+  // rxn rules are not matched onto the reactants, all their rxn classes are
+  // created by explicit rxns, other species are processed as usual
+  for (species_id_t id: reactant_ids) {
+    if (species_with_explicit_rxn_classes.count(id) == 0) {
+      species_with_explicit_rxn_classes.insert(id);
+      species_processed_for_unimol_rxn_classes.insert(id);
+      species_processed_for_bimol_rxn_classes.insert(id);
+    }
+  }
+}
+
+
 RxnClass* RxnContainer::get_or_create_empty_unimol_rxn_class(const species_id_t reac_id) {
 
   auto it = unimol_rxn_class_map.find(reac_id);
@@ -128,8 +232,7 @@ RxnClass* RxnContainer::get_or_create_empty_unimol_rxn_class(const species_id_t
     return it->second;
   }
   else {
-    RxnClass* new_rxn_class = new RxnClass(*this, all_species, bng_config, reac_id);
-    rxn_classes.insert(new_rxn_class);
+    RxnClass* new_rxn_class = create_rxn_class(reac_id);
     unimol_rxn_class_map[reac_id] = new_rxn_class;
     return new_rxn_class;
   }
@@ -141,7 +244,8 @@ void RxnContainer::create_unimol_rxn_class_for_new_species(const species_id_t sp
   // find all reactions for species id
   small_vector<RxnRule*> rxns_for_new_species;
   for (RxnRule* r: rxn_rules) {
-    if (r->is_unimol() && r->species_can_be_reactant(species_id, all_species)) {
+    // explicit rxns are already in rxn classes of their reactants
+    if (r->is_unimol() && !r->is_explicit() && r->species_can_be_reactant(species_id, all_species)) {
       rxns_for_new_species.push_back(r);
     }
   }
@@ -195,8 +299,7 @@ RxnClass* RxnContainer::get_or_create_empty_bimol_rxn_class(const species_id_t r
   }
   else {
     // create a new one
-    RxnClass* new_rxn_class = new RxnClass(*this, all_species, bng_config, reac1_id, reac2_id);
-    rxn_classes.insert(new_rxn_class);
+    RxnClass* new_rxn_class = create_rxn_class(reac1_id, reac2_id);
 
     // insert it into maps
     it_map1->second[reac2_id] = new_rxn_class;
@@ -317,7 +420,8 @@ void RxnContainer::create_bimol_rxn_classes_for_new_species(const species_id_t s
   // also define reactant class
   small_vector<RxnRule*> rxns_for_new_species;
   for (RxnRule* r: rxn_rules) {
-    if (r->is_bimol() && r->species_can_be_reactant(species_id1, all_species)) {
+    // explicit rxns are already in rxn classes of their reactants
+    if (r->is_bimol() && !r->is_explicit() && r->species_can_be_reactant(species_id1, all_species)) {
       rxns_for_new_species.push_back(r);
     }
   }
@@ -430,18 +534,158 @@ void RxnContainer::create_bimol_rxn_classes_for_new_species(const species_id_t s
 }
 
 
+RxnClass* RxnContainer::create_rxn_class(const species_id_t reac1_id, const species_id_t reac2_id) {
+  rxn_class_id_t id;
+  if (!free_rxn_class_ids.empty()) {
+    id = free_rxn_class_ids.back();
+    free_rxn_class_ids.pop_back();
+    assert(rxn_classes[id] == nullptr);
+  }
+  else {
+    id = rxn_classes.size();
+    rxn_classes.push_back(nullptr);
+
+    if (id / RXN_CLASS_POOL_BLOCK_SIZE >= rxn_class_blocks.size()) {
+      rxn_class_blocks.push_back(new RxnClassStorage[RXN_CLASS_POOL_BLOCK_SIZE]);
+    }
+  }
+
+  RxnClassStorage* slot = &rxn_class_blocks[id / RXN_CLASS_POOL_BLOCK_SIZE][id % RXN_CLASS_POOL_BLOCK_SIZE];
+  RxnClass* new_rxn_class = new(slot) RxnClass(*this, all_species, bng_config, reac1_id, reac2_id);
+  new_rxn_class->id = id;
+  rxn_classes[id] = new_rxn_class;
+  num_rxn_class_cache_misses++;
+  return new_rxn_class;
+}
+
+
 void RxnContainer::delete_rxn_class(RxnClass* rxn_class) {
-  // remove the pointer from the rxn classes container so that they are not deleted
-  // when RxnContainer destructor is called
-  assert(rxn_classes.count(rxn_class) != 0);
-  rxn_classes.erase(rxn_class);
+  assert(rxn_class != nullptr);
+  rxn_class_id_t id = rxn_class->id;
+  assert(id < rxn_classes.size() && rxn_classes[id] == rxn_class);
+
+  num_rxn_class_cache_hits += rxn_class->get_num_uses();
+
+  // destructor also removes existing links from rxn rules to this rxn class,
+  // the memory stays in the pool
+  rxn_class->~RxnClass();
+
+  rxn_classes[id] = nullptr;
+  free_rxn_class_ids.push_back(id);
+}
+
+
+void RxnContainer::delete_all_rxn_classes() {
+  for (RxnClass* rc: rxn_classes) {
+    if (rc != nullptr) {
+      num_rxn_class_cache_hits += rc->get_num_uses();
+      rc->~RxnClass();
+    }
+  }
+  rxn_classes.clear();
+  free_rxn_class_ids.clear();
+  next_rxn_class_clock_hand = 0;
+}
+
+
+void RxnContainer::evict_rxn_class(RxnClass* rxn_class) {
+  if (rxn_class->is_unimol()) {
+    remove_unimol_rxn_class(rxn_class->reactant_ids[0]);
+    return;
+  }
+
+  assert(rxn_class->is_bimol());
+  species_id_t reac1_id = rxn_class->reactant_ids[0];
+  species_id_t reac2_id = rxn_class->reactant_ids[1];
+
+  // remove both mappings reac1 + reac2 and reac2 + reac1
+  auto it_map1 = bimol_rxn_class_map.find(reac1_id);
+  assert(it_map1 != bimol_rxn_class_map.end());
+  it_map1->second.erase(reac2_id);
+
+  auto it_map2 = bimol_rxn_class_map.find(reac2_id);
+  assert(it_map2 != bimol_rxn_class_map.end());
+  it_map2->second.erase(reac1_id);
+
+  // both species must be processed again so that the rxn class is recreated,
+  // processing skips rxn classes that already exist
+  species_processed_for_bimol_rxn_classes.erase(reac1_id);
+  species_processed_for_bimol_rxn_classes.erase(reac2_id);
+
+  delete_rxn_class(rxn_class);
+}
+
+
+uint64_t RxnContainer::get_num_rxn_class_cache_hits() const {
+  uint64_t res = num_rxn_class_cache_hits;
+  for (const RxnClass* rc: rxn_classes) {
+    if (rc != nullptr) {
+      res += rc->get_num_uses();
+    }
+  }
+  return res;
+}
+
 
-  // destructor also removes existing links from rxn rules to this rxn class
-  delete rxn_class;
+uint RxnContainer::evict_cold_rxn_classes() {
+  uint max_num = bng_config.max_num_rxn_classes;
+  if (max_num == 0 || get_num_rxn_classes() <= max_num) {
+    return 0;
+  }
+
+  uint num_evicted = 0;
+  // the first pass over all rxn classes may only clear the referenced flags,
+  // the second pass must then find enough rxn classes to evict unless they are protected
+  uint num_steps_left = 2 * rxn_classes.size();
+  while (get_num_rxn_classes() > max_num && num_steps_left > 0) {
+    num_steps_left--;
+    if (next_rxn_class_clock_hand >= rxn_classes.size()) {
+      next_rxn_class_clock_hand = 0;
+    }
+    rxn_class_id_t id = next_rxn_class_clock_hand;
+    next_rxn_class_clock_hand++;
+
+    RxnClass* rc = rxn_classes[id];
+    if (rc == nullptr) {
+      continue;
+    }
+    if (rc->clear_used_recently()) {
+      // give it a second chance
+      continue;
+    }
+
+    // rxn classes of superclasses are created for all known species during initialization
+    // and cannot be recreated the same way on-demand
+    bool uses_superclass = false;
+    for (species_id_t reac_id: rc->reactant_ids) {
+      if (all_species.is_species_superclass(reac_id)) {
+        uses_superclass = true;
+      }
+    }
+    if (uses_superclass) {
+      continue;
+    }
+
+    // explicit rxns are not matched onto species so their rxn classes cannot be recreated
+    if (rc->has_explicit_pathways()) {
+      continue;
+    }
+
+    evict_rxn_class(rc);
+    num_evicted++;
+  }
+
+  num_rxn_class_evictions += num_evicted;
+  return num_evicted;
 }
 
 
 void RxnContainer::remove_unimol_rxn_class(const species_id_t id) {
+  if (species_with_explicit_rxn_classes.count(id) != 0) {
+    // cannot be recreated, see evict_cold_rxn_classes
+    return;
+  }
+
   if (species_processed_for_unimol_rxn_classes.count(id) != 0) {
     // forget that we processed this species
     species_processed_for_unimol_rxn_classes.erase(id);
@@ -463,6 +707,10 @@ void RxnContainer::remove_unimol_rxn_class(const species_id_t id) {
 
 
 void RxnContainer::remove_bimol_rxn_classes(const species_id_t reac1_species_id) {
+  if (species_with_explicit_rxn_classes.count(reac1_species_id) != 0) {
+    // cannot be recreated, see evict_cold_rxn_classes
+    return;
+  }
 
   // remove the rxn classes and their mappings for the second reactants
   if (bimol_rxn_class_map.count(reac1_species_id) != 0) {
@@ -508,6 +756,172 @@ void RxnContainer::remove_bimol_rxn_classes(const species_id_t reac1_species_id)
 }
 
 
+void RxnContainer::init_rxn_rate_schedule() {
+  rxn_rate_change_queue = RxnRateChangeQueue();
+  for (const RxnRule* rxn: rxn_rules) {
+    if (rxn->may_update_rxn_rate()) {
+      rxn_rate_change_queue.push(make_pair(rxn->get_next_time_of_rxn_rate_update(), rxn->id));
+    }
+  }
+  rxn_rate_schedule_initialized = true;
+}
+
+
+uint RxnContainer::advance_to(const double time) {
+  if (!rxn_rate_schedule_initialized) {
+    init_rxn_rate_schedule();
+  }
+
+  uint num_changes = 0;
+  while (!rxn_rate_change_queue.empty()) {
+    const RxnRateChangeEvent& event = rxn_rate_change_queue.top();
+    if (event.first > time && !cmp_eq(event.first, time)) {
+      break;
+    }
+    RxnRule* rxn = get(event.second);
+    rxn_rate_change_queue.pop();
+
+    // does nothing if the rule was already updated for this time
+    bool changed = rxn->update_variable_rxn_rate(time, nullptr);
+    if (changed) {
+      num_changes++;
+      if (bng_config.notifications.rxn_probability_changed) {
+        notifys() <<
+            "Rate constant " << rxn->get_rate_constant() << " set for " << rxn->to_str() <<
+            " at time " << time << ".\n";
+      }
+    }
+
+    // schedule the next change
+    if (rxn->may_update_rxn_rate()) {
+      rxn_rate_change_queue.push(make_pair(rxn->get_next_time_of_rxn_rate_update(), rxn->id));
+    }
+  }
+
+  return num_changes;
+}
+
+
+void RxnContainer::warm_up(const std::vector<species_id_t>& species_ids, const uint num_threads) {
+
+  // ignore duplicates, keep the order in which the species were given
+  std::vector<species_id_t> unique_species_ids;
+  SpeciesIdSet species_ids_set;
+  for (species_id_t id: species_ids) {
+    assert(all_species.is_valid_id(id));
+    if (species_ids_set.count(id) == 0) {
+      species_ids_set.insert(id);
+      unique_species_ids.push_back(id);
+    }
+  }
+
+  // 1) find out which reactants of which rxn rules can the species match,
+  //    this part runs in parallel because it does not modify any shared data
+  std::vector<std::pair<RxnRule*, species_id_t>> queries;
+  for (RxnRule* r: rxn_rules) {
+    for (species_id_t id: unique_species_ids) {
+      if (!r->species_applicability.is_known(id)) {
+        queries.push_back(make_pair(r, id));
+      }
+    }
+  }
+
+  std::vector<std::vector<uint>> query_results(queries.size());
+  auto process_queries = [&queries, &query_results, this](const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      queries[i].first->compute_species_reactant_indices(queries[i].second, all_species, query_results[i]);
+    }
+  };
+
+  run_in_parallel(queries.size(), num_threads, process_queries);
+
+  // 2) store the results into rxn rule caches
+  for (size_t i = 0; i < queries.size(); i++) {
+    queries[i].first->set_species_reactant_indices(queries[i].second, query_results[i]);
+  }
+
+  // 3) create rxn classes among the species, each rxn class is processed only once
+  std::vector<RxnClass*> rxn_classes;
+  std::set<const RxnClass*> rxn_classes_set;
+  for (species_id_t id: unique_species_ids) {
+    RxnClass* unimol_rxn_class = get_unimol_rxn_class(id);
+    if (unimol_rxn_class != nullptr && rxn_classes_set.count(unimol_rxn_class) == 0) {
+      rxn_classes_set.insert(unimol_rxn_class);
+      rxn_classes.push_back(unimol_rxn_class);
+    }
+
+    // all known species are used because the species might have not been instantiated yet
+    SpeciesRxnClassesMap* bimol_rxn_classes = get_bimol_rxns_for_reactant(id, true);
+    if (bimol_rxn_classes == nullptr) {
+      continue;
+    }
+    // the map is ordered by species id
+    for (auto& it: *bimol_rxn_classes) {
+      if (species_ids_set.count(it.first) != 0 && rxn_classes_set.count(it.second) == 0) {
+        rxn_classes_set.insert(it.second);
+        rxn_classes.push_back(it.second);
+      }
+    }
+  }
+
+  // 4) compute products of complex rxn rules for reactants of each rxn class in parallel,
+  //    this is the costly part of pathway initialization and it does not modify any shared data
+  std::vector<std::map<rxn_rule_id_t, ComplexRxnProductSets>> computed_product_sets(rxn_classes.size());
+  std::vector<std::pair<size_t, rxn_rule_id_t>> product_queries;
+  for (size_t i = 0; i < rxn_classes.size(); i++) {
+    std::vector<rxn_rule_id_t> rxn_rule_ids;
+    rxn_classes[i]->get_rxn_rule_ids_for_product_computation(rxn_rule_ids);
+    for (rxn_rule_id_t rxn_rule_id: rxn_rule_ids) {
+      // insert here so that the maps are not modified by the threads
+      computed_product_sets[i][rxn_rule_id] = ComplexRxnProductSets();
+      product_queries.push_back(make_pair(i, rxn_rule_id));
+    }
+  }
+
+  auto compute_product_sets =
+      [&rxn_classes, &computed_product_sets, &product_queries, this](const size_t begin, const size_t end) {
+    for (size_t k = begin; k < end; k++) {
+      size_t i = product_queries[k].first;
+      rxn_rule_id_t rxn_rule_id = product_queries[k].second;
+      get(rxn_rule_id)->compute_product_sets_for_specific_reactants(
+          all_species, bng_config, rxn_classes[i]->reactant_ids,
+          computed_product_sets[i].find(rxn_rule_id)->second);
+    }
+  };
+
+  run_in_parallel(product_queries.size(), num_threads, compute_product_sets);
+
+  // 5) define pathways of the rxn classes, this may create new species so the order
+  //    must be always the same
+  for (size_t i = 0; i < rxn_classes.size(); i++) {
+    rxn_classes[i]->init_rxn_pathways_and_rates(false, &computed_product_sets[i]);
+  }
+
+  // 6) compute products of lazily defined pathways in parallel,
+  //    species of these products are defined once their pathways are used
+  std::vector<uint> num_precomputed(rxn_classes.size(), 0);
+  std::vector<double> precomputation_times(rxn_classes.size(), 0);
+  auto precompute_products =
+      [&rxn_classes, &num_precomputed, &precomputation_times](const size_t begin, const size_t end) {
+    for (size_t i = begin; i < end; i++) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      num_precomputed[i] = rxn_classes[i]->precompute_pathway_products();
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      precomputation_times[i] = elapsed.count();
+    }
+  };
+
+  run_in_parallel(rxn_classes.size(), num_threads, precompute_products);
+
+  // the time is used by rxn classes to estimate the cost of precomputation
+  for (size_t i = 0; i < rxn_classes.size(); i++) {
+    if (num_precomputed[i] != 0) {
+      add_product_precomputation_time(precomputation_times[i], num_precomputed[i]);
+    }
+  }
+}
+
+
 void RxnContainer::remove_species_id_references(const species_id_t id) {
   // this method is currently used only from SpeciesCleanupEvent
   // we are assuming that there are rxn classes that use this species
@@ -518,6 +932,7 @@ void RxnContainer::remove_species_id_references(const species_id_t id) {
   for (RxnRule* rxn: rxn_rules) {
     rxn->remove_species_id_references(id);
   }
+  product_set_memo.remove_species_id_references(id);
 }
 
 
@@ -554,27 +969,37 @@ void RxnContainer::print_periodic_stats() const {
 
   uint64_t applicable_total = 0;
   uint64_t not_applicable_total = 0;
+  uint64_t applicability_bytes_total = 0;
   for (const RxnRule* rxn: rxn_rules) {
-    applicable_total += rxn->species_applicable_as_any_reactant.size();
-    applicable_total += rxn->species_applicable_as_reactant[0].size();
-    applicable_total += rxn->species_applicable_as_reactant[1].size();
-
-    not_applicable_total += rxn->species_not_applicable_as_any_reactant.size();
-    not_applicable_total += rxn->species_not_applicable_as_reactant[0].size();
-    not_applicable_total += rxn->species_not_applicable_as_reactant[1].size();
+    applicable_total += rxn->species_applicability.get_num_applicable();
+    not_applicable_total += rxn->species_applicability.get_num_not_applicable();
+    applicability_bytes_total += rxn->species_applicability.get_memory_size();
   }
 
   std::cout <<
-      ITEM_SIZE(rxn_classes) <<
+      "RxnContainer: rxn_classes = " << get_num_rxn_classes() << "\n" <<
+      ITEM_SIZE(rxn_class_blocks) <<
+      ITEM_SIZE(free_rxn_class_ids) <<
+      "RxnContainer: rxn class cache hits = " << get_num_rxn_class_cache_hits() <<
+        ", misses = " << num_rxn_class_cache_misses <<
+        ", evictions = " << num_rxn_class_evictions << "\n" <<
+      ITEM_SIZE(product_set_memo) <<
+      "RxnContainer: product set memo hits = " << product_set_memo.get_num_hits() <<
+        ", misses = " << product_set_memo.get_num_misses() << "\n" <<
       ITEM_SIZE(species_processed_for_bimol_rxn_classes) <<
       ITEM_SIZE(species_processed_for_unimol_rxn_classes) <<
       ITEM_SIZE(unimol_rxn_class_map) <<
       ITEM_SIZE(bimol_rxn_class_map) <<
       ITEM_SIZE(rxn_rules) <<
+      "RxnContainer: unique reactant patterns = " << reactant_pattern_table.get_num_patterns() <<
+        ", computed species matches = " << reactant_pattern_table.get_num_match_computations() <<
+        ", pruned species matches = " << reactant_pattern_table.get_num_matches_pruned() << "\n" <<
       "RxnContainer: rxn_rules - total species applicable as reactant = " <<
         applicable_total << "\n" <<
       "RxnContainer: rxn_rules - total species not applicable as reactant = " <<
-        not_applicable_total << "\n";
+        not_applicable_total << "\n" <<
+      "RxnContainer: rxn_rules - total bytes used by species applicability caches = " <<
+        applicability_bytes_total << "\n";
 
 #undef ITEM_SIZE
 }
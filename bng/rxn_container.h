@@ -10,12 +10,17 @@
 #ifndef LIBS_BNG_RXN_CONTAINER_H_
 #define LIBS_BNG_RXN_CONTAINER_H_
 
+#include <type_traits>
+#include <queue>
+
 #define BOOST_ALLOW_DEPRECATED_HEADERS
 #include <boost/dynamic_bitset.hpp>
 
 #include "bng/bng_defines.h"
 #include "bng/rxn_rule.h"
 #include "bng/rxn_class.h"
+#include "bng/product_set_memo.h"
+#include "bng/reactant_pattern_table.h"
 #include "bng/species_container.h"
 
 namespace BNG {
@@ -25,11 +30,20 @@ typedef std::map<species_id_t, RxnClass*> SpeciesRxnClassesMap;
 typedef std::map<species_id_t, SpeciesRxnClassesMap> BimolRxnClassesMap;
 typedef SpeciesRxnClassesMap UnimolRxnClassesMap;
 
-typedef std::set<RxnClass*> RxnClassPtrSet;
+typedef std::vector<RxnClass*> RxnClassPtrVector;
 typedef std::vector<RxnRule*> RxnRuleVector;
 
+// raw memory for a single rxn class in the rxn class pool
+typedef std::aligned_storage<sizeof(RxnClass), alignof(RxnClass)>::type RxnClassStorage;
+
 typedef uint_set<species_id_t> SpeciesIdSet;
 
+// time when the rate constant of a rxn rule changes
+typedef std::pair<double, rxn_rule_id_t> RxnRateChangeEvent;
+// ordered so that the earliest event is on top
+typedef std::priority_queue<
+    RxnRateChangeEvent, std::vector<RxnRateChangeEvent>, std::greater<RxnRateChangeEvent>> RxnRateChangeQueue;
+
 // used always with two elements, the contained bitsets have size of
 // rxn_rules.size(), first one is for the first reactant, second for the second reactant
 // WARNING: the number of reaction rules cannot change in runtime for this to work
@@ -85,7 +99,15 @@ public:
 class RxnContainer {
 public:
   RxnContainer(SpeciesContainer& all_species_, BNGData& bng_data_, const BNGConfig& bng_config_)
-    : next_reactant_class_id(0),
+    : next_rxn_class_clock_hand(0),
+      rxn_rate_schedule_initialized(false),
+      num_rxn_class_cache_hits(0),
+      num_rxn_class_cache_misses(0),
+      num_rxn_class_evictions(0),
+      product_precomputation_time(0),
+      num_precomputed_pathway_products(0),
+      product_set_memo(bng_config_),
+      next_reactant_class_id(0),
       all_vol_mols_can_react_with_surface(false),
       all_surf_mols_can_react_with_surface(false),
       all_species(all_species_),
@@ -95,11 +117,71 @@ public:
 
   ~RxnContainer();
 
-  // completely resets the rxn container, keeps only rxn rules
+  // completely resets the rxn container, keeps only rxn rules,
+  // rxn classes of explicit rxns are created again right away
   void reset_caches();
 
   uint get_num_rxn_classes() const {
-    return rxn_classes.size();
+    assert(rxn_classes.size() >= free_rxn_class_ids.size());
+    return rxn_classes.size() - free_rxn_class_ids.size();
+  }
+
+  // returns nullptr if the rxn class with this id was deleted
+  RxnClass* get_rxn_class(const rxn_class_id_t id) {
+    assert(id < rxn_classes.size());
+    return rxn_classes[id];
+  }
+
+  // - when bng_config.max_num_rxn_classes is set and there are more rxn classes,
+  //   removes rxn classes that were not used recently (CLOCK approximation of LRU),
+  //   evicted rxn classes are recreated once they are needed again,
+  // - invalidates all RxnClass pointers and SpeciesRxnClassesMap pointers obtained earlier,
+  //   so it must be called only at points where the caller holds no such pointers
+  //   (similarly as for remove_unimol_rxn_class and remove_bimol_rxn_classes)
+  // - returns the number of evicted rxn classes
+  uint evict_cold_rxn_classes();
+
+  // - hit is a use of an existing rxn class (see RxnClass::mark_used),
+  //   including rxn classes reached through get_bimol_rxns_for_reactant,
+  //   miss means that a rxn class had to be (re)created
+  uint64_t get_num_rxn_class_cache_hits() const;
+
+  uint64_t get_num_rxn_class_cache_misses() const {
+    return num_rxn_class_cache_misses;
+  }
+
+  uint64_t get_num_rxn_class_evictions() const {
+    return num_rxn_class_evictions;
+  }
+
+  // - time spent computing products of rxn class pathways ahead of time,
+  //   rxn classes use it to estimate how long it would take to precompute their products
+  void add_product_precomputation_time(const double time, const uint num_pathways) {
+    product_precomputation_time += time;
+    num_precomputed_pathway_products += num_pathways;
+  }
+
+  // returns FLT_INVALID when no products were precomputed yet
+  double get_avg_product_precomputation_time() const {
+    if (num_precomputed_pathway_products == 0) {
+      return FLT_INVALID;
+    }
+    return product_precomputation_time / num_precomputed_pathway_products;
+  }
+
+  // unique reactant patterns of all rxn rules with cached species matches
+  const ReactantPatternTable& get_reactant_pattern_table() const {
+    return reactant_pattern_table;
+  }
+
+  ReactantPatternTable& get_reactant_pattern_table() {
+    return reactant_pattern_table;
+  }
+
+  // products computed for rxn rules and specific reactants,
+  // unlike rxn classes, the memo is kept by reset_caches and by rxn class removals
+  ProductSetMemo& get_product_set_memo() {
+    return product_set_memo;
   }
 
   // must be called once all reactions were added or were updated
@@ -108,6 +190,23 @@ public:
   // this method is supposed to be used only during initialization
   rxn_rule_id_t add_and_finalize(const RxnRule& r);
 
+  // same as calling add_and_finalize for each of the rules, their ids are stored into ids,
+  // - rules are finalized in parallel with num_threads, ids are assigned in the order
+  //   of rules so they do not depend on num_threads
+  void add_and_finalize(
+      const std::vector<RxnRule>& rules, std::vector<rxn_rule_id_t>& ids, const uint num_threads = 1);
+
+  // - adds a rxn whose reactants and products are the given species, e.g. a rxn
+  //   of a network generated earlier, r must not be finalized,
+  // - the rxn is added directly as a pathway to the unimol or bimol rxn class of
+  //   its reactants, no matching onto species is done for it,
+  // - the rxn classes with explicit pathways are not evicted or removed
+  // - returns id of the new rxn rule
+  rxn_rule_id_t add_explicit_rxn(
+      const RxnRule& r,
+      const std::vector<species_id_t>& reactant_ids,
+      const std::vector<species_id_t>& product_ids);
+
   // - might invalidate Species reference
   // - returns nullptr when there are no rxns, never returns an empty rxn class
   RxnClass* get_unimol_rxn_class(const species_id_t id) {
@@ -124,6 +223,7 @@ public:
       assert(it->second != nullptr);
       assert(it->second->get_num_reactions() != 0);
 
+      it->second->mark_used();
       return it->second;
     }
     else {
@@ -158,6 +258,7 @@ public:
       assert(it_res->second != nullptr);
       assert(it_res->second->get_num_reactions() != 0);
 
+      it_res->second->mark_used();
       return it_res->second;
     }
     else {
@@ -203,6 +304,36 @@ public:
   // frees up memory taken up by the species' rxn classes that is no longer needed
   void remove_bimol_rxn_classes(const species_id_t reac1_species_id);
 
+  // (re)creates the queue of times when rate constants of rxn rules with variable rates change,
+  // called automatically by the first advance_to, must be called again when
+  // variable rates of rxn rules were changed
+  void init_rxn_rate_schedule();
+
+  // - applies all rate changes of rxn rules scheduled up to and including time,
+  //   only rxn classes that use the affected rxn rules get their probabilities updated,
+  // - when this method is used, polling with RxnClass::update_rxn_rates_if_needed is not needed
+  // - returns the number of rate changes applied
+  uint advance_to(const double time);
+
+  // returns TIME_FOREVER if no change is scheduled
+  double get_next_rxn_rate_change_time() {
+    if (!rxn_rate_schedule_initialized) {
+      init_rxn_rate_schedule();
+    }
+    return rxn_rate_change_queue.empty() ? TIME_FOREVER : rxn_rate_change_queue.top().first;
+  }
+
+  // - creates all unimol and bimol rxn classes among the given species,
+  //   initializes their pathways and computes all their products so that this work
+  //   does not have to be done on-demand during simulation, species of lazily defined
+  //   products are created once their pathway is used (see RxnClass::precompute_pathway_products)
+  // - matching of the species onto reactant patterns and computation of products
+  //   is done in parallel with num_threads, rxn classes and product species are then created
+  //   sequentially in the order of species_ids,
+  //   therefore the ids of new species and rxn classes do not depend on num_threads
+  // - might invalidate Species references
+  void warm_up(const std::vector<species_id_t>& species_ids, const uint num_threads = 1);
+
   void remove_species_id_references(const species_id_t id);
 
   const ReactantClassIdSet& get_reacting_classes(Species& species) {
@@ -287,10 +418,18 @@ private:
   RxnClass* get_or_create_empty_unimol_rxn_class(const species_id_t reac_id);
   RxnClass* get_or_create_empty_bimol_rxn_class(const species_id_t reac1_id, const species_id_t reac2_id);
 
+  void add_explicit_rxn_to_rxn_class(RxnRule* r);
+
   void create_unimol_rxn_class_for_new_species(const species_id_t species_id);
   void create_bimol_rxn_classes_for_new_species(const species_id_t species_id, const bool for_all_known_species);
 
+  // allocates a new rxn class in the rxn class pool and assigns its id
+  RxnClass* create_rxn_class(const species_id_t reac1_id, const species_id_t reac2_id = SPECIES_ID_INVALID);
   void delete_rxn_class(RxnClass* rxn_class);
+  void delete_all_rxn_classes();
+
+  // removes the rxn class and all information that would prevent it from being recreated
+  void evict_rxn_class(RxnClass* rxn_class);
 
   void compute_reacting_classes(const ReactantClass& rc);
   reactant_class_id_t find_or_add_reactant_class(
@@ -299,11 +438,39 @@ private:
 
 private:
 
-  // owns reaction classes
-  // allocated in get_or_create_empty_bimol_rxn_class, deleted in destructor
-  // the size of the vector will be changing, so we cannot take pointers to its elements
-  // indexed by rxn_class_id_t
-  RxnClassPtrSet rxn_classes;
+  // owns memory for reaction classes,
+  // rxn class with id i is stored in block i / RXN_CLASS_POOL_BLOCK_SIZE at
+  // index i % RXN_CLASS_POOL_BLOCK_SIZE, blocks are freed in destructor
+  std::vector<RxnClassStorage*> rxn_class_blocks;
+
+  // reaction classes allocated in create_rxn_class,
+  // indexed by rxn_class_id_t, contains nullptr for ids that are in free_rxn_class_ids
+  RxnClassPtrVector rxn_classes;
+
+  // ids of deleted rxn classes that can be reused, the last one is used first
+  std::vector<rxn_class_id_t> free_rxn_class_ids;
+
+  // CLOCK eviction state, the used flag is kept by each RxnClass
+  rxn_class_id_t next_rxn_class_clock_hand;
+
+  // contains one event for each rxn rule that has pending variable rates,
+  // the event time may be earlier than the actual next time of the rule if the
+  // rule was updated through RxnClass::update_rxn_rates_if_needed
+  RxnRateChangeQueue rxn_rate_change_queue;
+  bool rxn_rate_schedule_initialized;
+
+  // statistics, hits of existing rxn classes are counted by the rxn classes,
+  // this counter holds hits of rxn classes that were deleted
+  uint64_t num_rxn_class_cache_hits;
+  uint64_t num_rxn_class_cache_misses;
+  uint64_t num_rxn_class_evictions;
+  double product_precomputation_time; // in seconds
+  uint64_t num_precomputed_pathway_products;
+
+  ProductSetMemo product_set_memo;
+
+  // shared by all rxn rules, rxn rules point to it
+  ReactantPatternTable reactant_pattern_table;
 
   // RxnContainer owns Rxn rules,
   // RxnClasses use pointers to these objects
@@ -314,6 +481,9 @@ private:
   SpeciesIdSet species_processed_for_bimol_rxn_classes;
   SpeciesIdSet species_processed_for_unimol_rxn_classes;
 
+  // reactants of explicit rxns, their rxn classes cannot be recreated on-demand
+  SpeciesIdSet species_with_explicit_rxn_classes;
+
   UnimolRxnClassesMap unimol_rxn_class_map;
 
   BimolRxnClassesMap bimol_rxn_class_map;
@@ -20,6 +20,7 @@
 #include <boost/graph/connected_components.hpp>
 
 #include "bng/rxn_rule.h"
+#include "bng/reactant_pattern_table.h"
 #include "bng/rxn_class.h"
 #include "bng/bngl_names.h"
 #include "bng/species.h"
@@ -72,7 +73,8 @@ void RxnRule::define_rxn_pathways_for_specific_reactants(
     const species_id_t reactant_a_species_id,
     const species_id_t reactant_b_species_id,
     const double pb_factor,
-    RxnClassPathwayVector& pathways
+    RxnClassPathwayVector& pathways,
+    ComplexRxnProductSets* computed_product_sets
 ) {
 
   if (is_simple()) {
@@ -93,14 +95,8 @@ void RxnRule::define_rxn_pathways_for_specific_reactants(
       product_species.push_back(ProductSpeciesIdWIndices(species_id, i));
     }
 
-    double prob;
-    if (cmp_eq(get_rate_constant(), DBL_GIGANTIC)) {
-      // special surface reactions are not scaled
-      prob = compute_rxn_probability(bng_config, 1);
-    }
-    else {
-      prob = compute_rxn_probability(bng_config, pb_factor);
-    }
+    // special surface reactions are not scaled
+    double prob = compute_pathway_probability(bng_config, pb_factor);
     pathways.push_back(RxnClassPathway(id, prob, product_species));
   }
   else {
@@ -133,7 +129,8 @@ void RxnRule::define_rxn_pathways_for_specific_reactants(
         bng_config,
         reactant_species,
         pb_factor,
-        pathways
+        pathways,
+        computed_product_sets
     );
 
   }
@@ -189,13 +186,17 @@ void RxnRule::finalize() {
   // also canonicalize the reactants and products so that a consistent
   // output is printed and 'name' of the complex reactants and products is set
   for (Cplx& ci: reactants) {
-    ci.canonicalize();
+    if (!cplxs_are_canonical) {
+      ci.canonicalize();
+    }
     ci.finalize_cplx();
     simple = simple && ci.is_simple();
   }
 
   for (Cplx& ci: products) {
-    ci.canonicalize();
+    if (!cplxs_are_canonical) {
+      ci.canonicalize();
+    }
     ci.finalize_cplx();
     simple = simple && ci.is_simple();
   }
@@ -211,24 +212,97 @@ void RxnRule::finalize() {
   // for MCell3 compatibility, updates mapping when needed
   move_products_that_are_also_reactants_to_be_the_first_products();
 
+  // complex rxns create products using edits compiled from the graphs
+  if (!simple) {
+    compile_edit_script();
+  }
+
+  compute_pattern_symmetry(patterns_graph, &products_graph, &products_to_patterns_mapping, patterns_symmetry);
+
   // set flag that tells us whether we have to do equivalence checks
   // when constructing sets of possible products
-  if (matching_may_produce_multiple_identical_results()) {
+  uint num_self_matches = get_num_patterns_graph_self_matches();
+  bool identical_components = may_modify_more_than_one_identical_component();
+  if (num_self_matches > 1 || identical_components) {
     set_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS);
   }
 
+  // matches that differ by a symmetry of the rule are not kept when matching patterns
+  // onto reactants, if these are the only matches of the patterns onto themselves,
+  // the kept matches give different products
+  kept_mappings_give_unique_products =
+      !identical_components && (double)num_self_matches == patterns_symmetry.factor;
+
   set_finalized();
 }
 
 
-bool RxnRule::matching_may_produce_multiple_identical_results() const {
+void RxnRule::finalize_explicit(
+    const std::vector<species_id_t>& reactant_species_ids,
+    const std::vector<species_id_t>& product_species_ids) {
+  release_assert(!reactant_species_ids.empty() && "Explicit rxns without reactants are not supported");
+  assert(reactant_species_ids.size() == reactants.size());
+  assert(product_species_ids.size() == products.size());
+  explicit_reactant_species_ids = reactant_species_ids;
+  explicit_product_species_ids = product_species_ids;
+
+  bool simple = true;
+
+  for (Cplx& ci: reactants) {
+    ci.finalize_cplx();
+    simple = simple && ci.is_simple();
+  }
+
+  for (Cplx& ci: products) {
+    ci.finalize_cplx();
+    simple = simple && ci.is_simple();
+  }
+
+  if (simple) {
+    set_flag(RXN_FLAG_SIMPLE);
+  }
+
+  // simple products that are also reactants with the same compartment are mapped onto
+  // their reactants, this is what compute_reactants_products_mapping gives for simple complexes,
+  // unlike in finalize, the products are not reordered because their order is given by the network
+  pat_prod_cplx_mapping.clear();
+  vector<bool> reactant_is_mapped(reactants.size(), false);
+  for (uint pi = 0; pi < products.size(); pi++) {
+    const Cplx& prod = products[pi];
+    if (!prod.is_simple()) {
+      continue;
+    }
+    for (uint ri = 0; ri < reactants.size(); ri++) {
+      const Cplx& reac = reactants[ri];
+      if (!reactant_is_mapped[ri] && reac.is_simple() &&
+          reac.elem_mols[0].elem_mol_type_id == prod.elem_mols[0].elem_mol_type_id &&
+          reac.elem_mols[0].compartment_id == prod.elem_mols[0].compartment_id) {
+        reactant_is_mapped[ri] = true;
+        pat_prod_cplx_mapping.push_back(CplxIndexPair(ri, pi, true));
+        break;
+      }
+    }
+  }
+
+  set_finalized();
+}
+
+
+uint RxnRule::get_num_patterns_graph_self_matches() const {
+
+  // if every node can match only nodes with the same label,
+  // the matches of the patterns graph onto itself are its automorphisms
+  // that were already computed with Traces
+  if (!may_match_vertices_with_different_labels(patterns_graph)) {
+    return (uint)patterns_symmetry.num_pattern_automorphisms;
+  }
 
   Graph patterns_graph_no_indices = patterns_graph;
 
   // we must not have pattern indices when checking for symmetry
   set_graph_reactant_pattern_indices(patterns_graph_no_indices, INDEX_INVALID);
 
-  // are there multiple matches of the patterns graph onto itself?
+  // how many matches of the patterns graph onto itself are there?
   VertexMappingVector mappings;
   get_subgraph_isomorphism_mappings(
       patterns_graph_no_indices,
@@ -237,12 +311,7 @@ bool RxnRule::matching_may_produce_multiple_identical_results() const {
       mappings
   );
   assert(mappings.size() >= 1);
-  if (mappings.size() > 1) {
-    return true;
-  }
-
-  // now check whether we can match multiple components in the same molecule
-  return may_modify_more_than_one_identical_component();
+  return mappings.size();
 }
 
 
@@ -1090,7 +1159,7 @@ static bool convert_graph_component_to_product_cplx_inst(
     const vector<int>& graph_components,
     const int graph_component_index,
     Species* species,
-    std::set<uint>& product_indices
+    RuleProductIndices& product_indices
 ) {
   product_indices.clear();
 
@@ -1169,7 +1238,7 @@ static bool convert_graph_component_to_product_cplx_inst(
 
 
 // product compartment may be set only partially in the rxn rule, this sets them accordingly
-void RxnRule::set_product_compartments(Species* product_species, std::set<uint>& product_indices) const {
+void RxnRule::set_product_compartments(Species* product_species, const RuleProductIndices& product_indices) const {
   // first we need to sef surf/vol flags
   product_species->finalize_cplx();
 
@@ -1262,7 +1331,7 @@ void RxnRule::create_products_from_reactants_graph(
     // A(b!1).B(a!1) -> A(b) + B(a)
     // is applied on
     // A(b!1,c!2).B(a!1,c!3).C(a!2,B!3) - a single complex is a result
-    std::set<uint> product_indices;
+    RuleProductIndices product_indices;
     bool is_rxn_product =
         convert_graph_component_to_product_cplx_inst(
             reactants_graph, graph_components, i, product_species, product_indices);
@@ -1353,15 +1422,520 @@ static void sort_mappings(VertexMappingVector& mappings) {
 }
 
 
-void RxnRule::create_products_for_complex_rxn(
-    SpeciesContainer& all_species,
+// finds to what the bond of a product component leads to,
+// returns false if the target is neither mapped onto patterns nor a new component
+static bool get_edit_bond_target(
+    const vertex_descriptor_t prod_target_desc,
+    const VertexMapping& products_to_patterns_mapping,
+    const map<vertex_descriptor_t, uint>& new_component_indices,
+    const VertexNameMap& patterns_index,
+    bool& target_is_new_component,
+    vertex_descriptor_t& target_pattern_vertex,
+    uint& target_new_component_index
+) {
+  auto new_it = new_component_indices.find(prod_target_desc);
+  if (new_it != new_component_indices.end()) {
+    target_is_new_component = true;
+    target_new_component_index = new_it->second;
+    return true;
+  }
+
+  auto pat_it = products_to_patterns_mapping.find(prod_target_desc);
+  if (pat_it == products_to_patterns_mapping.end() || patterns_index[pat_it->second].is_mol) {
+    return false;
+  }
+  target_is_new_component = false;
+  target_pattern_vertex = pat_it->second;
+  return true;
+}
+
+
+bool RxnRule::compile_edit_script() {
+  edit_script.clear();
+
+  VertexNameMap products_index = boost::get(boost::vertex_name, products_graph);
+  VertexNameMap patterns_index = boost::get(boost::vertex_name, patterns_graph);
+
+  // new elementary molecules, their components are in the same order as in the graph
+  map<vertex_descriptor_t, uint> new_component_indices;
+  uint num_new_components = 0;
+  std::pair<vertex_iter_t, vertex_iter_t> it;
+  for (it = boost::vertices(products_graph); it.first != it.second; ++it.first) {
+    vertex_descriptor_t prod_desc = *it.first;
+    const Node& prod_node = products_index[prod_desc];
+    if (!prod_node.is_mol || products_to_patterns_mapping.count(prod_desc) != 0) {
+      continue;
+    }
+    if (prod_node.product_index == INDEX_INVALID) {
+      return false;
+    }
+
+    ElemMol em = *prod_node.mol;
+    em.components.clear();
+    boost::graph_traits<Graph>::out_edge_iterator ei, edge_end;
+    for (boost::tie(ei,edge_end) = boost::out_edges(prod_desc, products_graph); ei != edge_end; ++ei) {
+      vertex_descriptor_t prod_comp_desc = boost::target(*ei, products_graph);
+      const Node& comp_node = products_index[prod_comp_desc];
+      if (comp_node.is_mol) {
+        return false;
+      }
+      em.components.push_back(*comp_node.component);
+      new_component_indices[prod_comp_desc] = num_new_components;
+      num_new_components++;
+    }
+    edit_script.new_elem_mols.push_back(em);
+    edit_script.new_elem_mol_product_indices.push_back(prod_node.product_index);
+  }
+
+  for (auto new_comp: new_component_indices) {
+    vertex_descriptor_t prod_target_desc = get_bond_target(products_graph, new_comp.first, false);
+    if (prod_target_desc == TARGET_NOT_FOUND) {
+      continue;
+    }
+    RxnRuleNewBond bond;
+    bond.new_component_index = new_comp.second;
+    bool ok = get_edit_bond_target(
+        prod_target_desc, products_to_patterns_mapping, new_component_indices, patterns_index,
+        bond.target_is_new_component, bond.target_pattern_vertex, bond.target_new_component_index);
+    if (!ok) {
+      return false;
+    }
+    edit_script.new_bonds.push_back(bond);
+  }
+
+  // changes of elementary molecules and components mapped onto reactant patterns,
+  // the order of edits is the same as the order of changes in apply_rxn_on_reactants_graph
+  for (const auto& prod_pat_pair: products_to_patterns_mapping) {
+    vertex_descriptor_t prod_desc = prod_pat_pair.first;
+    vertex_descriptor_t pat_desc = prod_pat_pair.second;
+    const Node& prod_node = products_index[prod_desc];
+    const Node& pat_node = patterns_index[pat_desc];
+    if (prod_node.product_index == INDEX_INVALID || prod_node.is_mol != pat_node.is_mol) {
+      return false;
+    }
+
+    edit_script.edits.push_back(
+        RxnRuleEdit(RxnRuleEditType::SetProductIndex, pat_desc, prod_node.product_index));
+
+    if (!prod_node.is_mol) {
+      const Component& prod_ci = *prod_node.component;
+      if (prod_ci.state_is_set()) {
+        edit_script.edits.push_back(
+            RxnRuleEdit(RxnRuleEditType::SetState, pat_desc, prod_ci.state_id));
+      }
+
+      if (prod_ci.bond_value != BOND_VALUE_ANY) {
+        RxnRuleEdit edit(RxnRuleEditType::SetBond, pat_desc, 0);
+        edit.bond_value = prod_ci.bond_value;
+        if (prod_ci.bond_has_numeric_value()) {
+          vertex_descriptor_t prod_target_desc = get_bond_target(products_graph, prod_desc, false);
+          if (prod_target_desc == TARGET_NOT_FOUND) {
+            return false;
+          }
+          bool ok = get_edit_bond_target(
+              prod_target_desc, products_to_patterns_mapping, new_component_indices, patterns_index,
+              edit.target_is_new_component, edit.target_pattern_vertex, edit.target_new_component_index);
+          if (!ok) {
+            return false;
+          }
+        }
+        edit_script.edits.push_back(edit);
+      }
+    }
+    else {
+      const ElemMol& prod_em = *prod_node.mol;
+      // reactant has the same elem mol type as the pattern
+      if (prod_em.elem_mol_type_id != pat_node.mol->elem_mol_type_id) {
+        edit_script.edits.push_back(
+            RxnRuleEdit(RxnRuleEditType::ChangeElemMolType, pat_desc, prod_em.elem_mol_type_id));
+      }
+      if (is_specific_compartment_id(prod_em.compartment_id)) {
+        edit_script.edits.push_back(
+            RxnRuleEdit(RxnRuleEditType::SetCompartment, pat_desc, prod_em.compartment_id));
+      }
+    }
+  }
+
+  edit_script.compiled = true;
+  return true;
+}
+
+
+static uint find_edit_script_root(vector<uint>& parents, uint i) {
+  while (parents[i] != i) {
+    parents[i] = parents[parents[i]];
+    i = parents[i];
+  }
+  return i;
+}
+
+
+void RxnRule::create_products_using_edit_script(
+    const std::vector<const Cplx*>& input_reactants,
+    const VertexMapping& pattern_reactant_mapping,
+    ProductCplxWIndicesVector& created_products
+) const {
+  assert(edit_script.compiled);
+  created_products.clear();
+  created_products.reserve(2);
+
+  // flat copy of elementary molecules of all reactants followed by the new elementary molecules,
+  // components are indexed by their order in this copy
+  vector<ElemMol> mols;
+  vector<uint> mol_reactant_indices; // INDEX_INVALID for new elementary molecules
+  vector<uint> mol_first_component_indices;
+  vector<RuleProductIndices> mol_product_indices;
+  vector<uint> bond_partners; // component index -> bound component index or INDEX_INVALID
+  vector<uint> component_mol_indices;
+  // vertices of the merged reactants graph -> (elementary molecule, component or INDEX_INVALID),
+  // each elementary molecule is followed by its components in Cplx::create_graph
+  vector<pair<uint, uint>> vertex_mol_components;
+
+  for (uint r = 0; r < input_reactants.size(); r++) {
+    map<bond_value_t, uint> bond_first_components;
+    for (const ElemMol& em: input_reactants[r]->elem_mols) {
+      uint mol_index = mols.size();
+      mols.push_back(em);
+      mol_reactant_indices.push_back(r);
+      mol_first_component_indices.push_back(bond_partners.size());
+      vertex_mol_components.push_back(make_pair(mol_index, INDEX_INVALID));
+
+      for (uint c = 0; c < em.components.size(); c++) {
+        uint comp_index = bond_partners.size();
+        vertex_mol_components.push_back(make_pair(mol_index, c));
+        bond_partners.push_back(INDEX_INVALID);
+        component_mol_indices.push_back(mol_index);
+
+        const Component& comp = em.components[c];
+        if (comp.bond_has_numeric_value()) {
+          auto bond_it = bond_first_components.find(comp.bond_value);
+          if (bond_it == bond_first_components.end()) {
+            bond_first_components[comp.bond_value] = comp_index;
+          }
+          else {
+            bond_partners[comp_index] = bond_it->second;
+            bond_partners[bond_it->second] = comp_index;
+          }
+        }
+      }
+    }
+  }
+  uint first_new_component_index = bond_partners.size();
+  mol_product_indices.resize(mols.size());
+
+  for (uint i = 0; i < edit_script.new_elem_mols.size(); i++) {
+    const ElemMol& em = edit_script.new_elem_mols[i];
+    uint mol_index = mols.size();
+    mols.push_back(em);
+    mol_reactant_indices.push_back(INDEX_INVALID);
+    mol_first_component_indices.push_back(bond_partners.size());
+    mol_product_indices.push_back(RuleProductIndices());
+    mol_product_indices.back().insert(edit_script.new_elem_mol_product_indices[i]);
+    for (uint c = 0; c < em.components.size(); c++) {
+      bond_partners.push_back(INDEX_INVALID);
+      component_mol_indices.push_back(mol_index);
+    }
+  }
+
+  // reactant elementary molecule and component addressed by a pattern vertex
+  auto get_reactant_mol_component = [&](const vertex_descriptor_t pat_desc) -> const pair<uint, uint>& {
+    auto it = pattern_reactant_mapping.find(pat_desc);
+    assert(it != pattern_reactant_mapping.end() && "Mapping must exist");
+    assert(it->second < vertex_mol_components.size());
+    return vertex_mol_components[it->second];
+  };
+
+  auto get_target_component_index = [&](
+      const bool target_is_new_component,
+      const vertex_descriptor_t target_pattern_vertex,
+      const uint target_new_component_index) -> uint {
+    if (target_is_new_component) {
+      return first_new_component_index + target_new_component_index;
+    }
+    else {
+      const pair<uint, uint>& mc = get_reactant_mol_component(target_pattern_vertex);
+      assert(mc.second != INDEX_INVALID);
+      return mol_first_component_indices[mc.first] + mc.second;
+    }
+  };
+
+  bool reactant_used[2] = { false, false };
+  vector<pair<uint, uint>> bonds_to_remove;
+  vector<pair<uint, uint>> bonds_to_add;
+
+  for (const RxnRuleEdit& edit: edit_script.edits) {
+    const pair<uint, uint>& mc = get_reactant_mol_component(edit.pattern_vertex);
+    ElemMol& em = mols[mc.first];
+
+    switch (edit.type) {
+      case RxnRuleEditType::SetProductIndex:
+        mol_product_indices[mc.first].insert(edit.id);
+        assert(mol_reactant_indices[mc.first] < 2);
+        reactant_used[mol_reactant_indices[mc.first]] = true;
+        break;
+
+      case RxnRuleEditType::SetState:
+        assert(mc.second != INDEX_INVALID);
+        em.components[mc.second].state_id = edit.id;
+        break;
+
+      case RxnRuleEditType::SetBond: {
+          assert(mc.second != INDEX_INVALID);
+          uint comp_index = mol_first_component_indices[mc.first] + mc.second;
+          // bond values of reactants are not modified until products are created
+          bond_value_t reac_bond_value = em.components[mc.second].bond_value;
+
+          // same rules as in apply_rxn_on_reactants_graph
+          if (edit.bond_value == reac_bond_value || reac_bond_value == BOND_VALUE_ANY) {
+            break;
+          }
+
+          if (reac_bond_value != BOND_VALUE_UNBOUND) {
+            assert(bond_partners[comp_index] != INDEX_INVALID);
+            if (edit.bond_value == BOND_VALUE_UNBOUND) {
+              bonds_to_remove.push_back(make_pair(comp_index, bond_partners[comp_index]));
+            }
+            else if (edit.bond_value != BOND_VALUE_BOUND) {
+              bonds_to_remove.push_back(make_pair(comp_index, bond_partners[comp_index]));
+              bonds_to_add.push_back(make_pair(comp_index, get_target_component_index(
+                  edit.target_is_new_component, edit.target_pattern_vertex, edit.target_new_component_index)));
+            }
+          }
+          else {
+            release_assert(edit.bond_value != BOND_VALUE_BOUND && "Cannot change bond from to !+");
+            bonds_to_add.push_back(make_pair(comp_index, get_target_component_index(
+                edit.target_is_new_component, edit.target_pattern_vertex, edit.target_new_component_index)));
+          }
+        }
+        break;
+
+      case RxnRuleEditType::ChangeElemMolType:
+        if (em.elem_mol_type_id != edit.id) {
+          change_elem_mol_type_and_component_types(*bng_data, em, edit.id);
+        }
+        break;
+
+      case RxnRuleEditType::SetCompartment:
+        em.compartment_id = edit.id;
+        break;
+
+      default:
+        assert(false);
+    }
+  }
+
+  for (const RxnRuleNewBond& bond: edit_script.new_bonds) {
+    bonds_to_add.push_back(make_pair(
+        first_new_component_index + bond.new_component_index,
+        get_target_component_index(
+            bond.target_is_new_component, bond.target_pattern_vertex, bond.target_new_component_index)));
+  }
+
+  for (const pair<uint, uint>& b: bonds_to_remove) {
+    if (bond_partners[b.first] == b.second) {
+      bond_partners[b.first] = INDEX_INVALID;
+      bond_partners[b.second] = INDEX_INVALID;
+    }
+  }
+
+  for (const pair<uint, uint>& b: bonds_to_add) {
+    if (bond_partners[b.first] == b.second) {
+      // already added from the other side
+      continue;
+    }
+    release_assert(bond_partners[b.first] == INDEX_INVALID && bond_partners[b.second] == INDEX_INVALID &&
+        "Component may have only one bond");
+    bond_partners[b.first] = b.second;
+    bond_partners[b.second] = b.first;
+  }
+
+  // split into connected parts using union-find over elementary molecules
+  vector<uint> parents(mols.size());
+  for (uint i = 0; i < parents.size(); i++) {
+    parents[i] = i;
+  }
+  for (uint c = 0; c < bond_partners.size(); c++) {
+    if (bond_partners[c] != INDEX_INVALID && bond_partners[c] > c) {
+      uint root1 = find_edit_script_root(parents, component_mol_indices[c]);
+      uint root2 = find_edit_script_root(parents, component_mol_indices[bond_partners[c]]);
+      if (root1 != root2) {
+        parents[max(root1, root2)] = min(root1, root2);
+      }
+    }
+  }
+
+  // parts are ordered by their first elementary molecule, same as connected_components of the graph
+  vector<uint> root_part_indices(mols.size(), INDEX_INVALID);
+  vector<vector<uint>> parts;
+  for (uint m = 0; m < mols.size(); m++) {
+    uint root = find_edit_script_root(parents, m);
+    if (root_part_indices[root] == INDEX_INVALID) {
+      root_part_indices[root] = parts.size();
+      parts.push_back(vector<uint>());
+    }
+    parts[root_part_indices[root]].push_back(m);
+  }
+
+  vector<bond_value_t> new_bond_values(bond_partners.size(), BOND_VALUE_UNBOUND);
+  for (const vector<uint>& part: parts) {
+    // parts that contain a reactant that was not used by the rule were consumed
+    bool is_rxn_product = true;
+    RuleProductIndices product_indices;
+    for (uint m: part) {
+      if (mol_reactant_indices[m] != INDEX_INVALID && !reactant_used[mol_reactant_indices[m]]) {
+        is_rxn_product = false;
+        break;
+      }
+      for (uint i: mol_product_indices[m]) {
+        product_indices.insert(i);
+      }
+    }
+    if (!is_rxn_product) {
+      continue;
+    }
+    release_assert(!product_indices.empty());
+
+    Species* product_species = new Species(*bng_data);
+    bond_value_t next_bond_value = 1;
+    for (uint m: part) {
+      product_species->elem_mols.push_back(mols[m]);
+      ElemMol& em = product_species->elem_mols.back();
+      for (uint c = 0; c < em.components.size(); c++) {
+        uint comp_index = mol_first_component_indices[m] + c;
+        uint partner = bond_partners[comp_index];
+        if (partner == INDEX_INVALID) {
+          em.components[c].bond_value = BOND_VALUE_UNBOUND;
+        }
+        else {
+          if (new_bond_values[partner] == BOND_VALUE_UNBOUND) {
+            new_bond_values[comp_index] = next_bond_value;
+            new_bond_values[partner] = next_bond_value;
+            next_bond_value++;
+          }
+          em.components[c].bond_value = new_bond_values[comp_index];
+        }
+      }
+    }
+
+    set_product_compartments(product_species, product_indices);
+    created_products.push_back(ProductSpeciesPtrWIndices(product_species, product_indices));
+  }
+}
+
+
+void RxnRule::create_products_using_graphs(
+    const std::vector<const Cplx*>& input_reactants,
+    const VertexMapping& pattern_reactant_mapping,
+    ProductCplxWIndicesVector& created_products
+) const {
+  // we need to make a copy of the reactants because we will be modifying them
+  // a new graph will have its ordering indices cleared
+  vector<Cplx> input_reactants_copy;
+  input_reactants_copy.reserve(2);
+  for (const Cplx* cplx: input_reactants) {
+    input_reactants_copy.push_back(*cplx);
+  }
+
+  // and create a graph from them
+  // because we creating it from canonical species, we know for sure that this is the same
+  // graph as was used when mapping was computed
+  Graph reactants_graph = input_reactants_copy[0].get_graph();
+  if (input_reactants_copy.size() == 2) {
+    merge_graphs(reactants_graph, input_reactants_copy[1].get_graph());
+  }
+
+  set_ordering_indices(reactants_graph);
+
+  // manipulate nodes using information about products and the precomputed mapping
+  apply_rxn_on_reactants_graph(
+      *bng_data,
+      reactants_graph,
+      pattern_reactant_mapping,
+      patterns_graph,
+      products_to_patterns_mapping,
+      products_graph
+  );
+
+  // convert graph with products into cplx instances
+  create_products_from_reactants_graph(bng_data, reactants_graph, created_products);
+}
+
+
+void RxnRule::create_products_for_mapping(
+    const std::vector<const Cplx*>& input_reactants,
+    const VertexMapping& pattern_reactant_mapping,
+    ProductCplxWIndicesVector& created_products
+) const {
+  if (!edit_script.compiled) {
+    create_products_using_graphs(input_reactants, pattern_reactant_mapping, created_products);
+    return;
+  }
+
+  create_products_using_edit_script(input_reactants, pattern_reactant_mapping, created_products);
+
+#ifndef NDEBUG
+  // check that the edit script gives the same products as graph manipulation
+  ProductCplxWIndicesVector graph_products;
+  create_products_using_graphs(input_reactants, pattern_reactant_mapping, graph_products);
+  assert(graph_products.size() == created_products.size());
+  for (size_t i = 0; i < graph_products.size(); i++) {
+    assert(graph_products[i].rule_product_indices == created_products[i].rule_product_indices);
+    assert(graph_products[i].product_species->to_str() == created_products[i].product_species->to_str());
+    delete graph_products[i].product_species;
+  }
+#endif
+}
+
+
+void RxnRule::apply_rxn_on_reactants_copy(
+    const std::vector<const Cplx*>& input_reactants,
+    const VertexMapping& pattern_reactant_mapping,
+    std::vector<std::vector<Cplx>>& input_reactants_copies,
+    Graph& reactants_graph_copy
+) const {
+  // we need to make a copy of the reactants because we will be modifying them
+  // a new graph will have its ordering indices cleared
+  input_reactants_copies.push_back(vector<Cplx>());
+  vector<Cplx>& input_reactants_copy = input_reactants_copies.back();
+  for (const Cplx* ci: input_reactants) {
+    input_reactants_copy.push_back(*ci);
+  }
+  reactants_graph_copy = input_reactants_copy[0].get_graph();
+  if (input_reactants_copy.size() == 2) {
+    merge_graphs(reactants_graph_copy, input_reactants_copy[1].get_graph());
+  }
+
+  set_ordering_indices(reactants_graph_copy);
+
+#ifdef DEBUG_CPLX_MATCHING
+  cout << "Products:\n";
+  dump_graph(products_graph);
+#endif
+
+  // manipulate nodes using information about products
+  apply_rxn_on_reactants_graph(
+      *bng_data,
+      reactants_graph_copy,
+      pattern_reactant_mapping,
+      patterns_graph,
+      products_to_patterns_mapping,
+      products_graph
+  );
+
+#ifdef DEBUG_CPLX_MATCHING
+  cout << "\nReactants after applying rxn:\n";
+  dump_graph(reactants_graph_copy);
+#endif
+}
+
+
+void RxnRule::compute_product_sets_for_specific_reactants(
+    const SpeciesContainer& all_species,
     const BNGConfig& bng_config,
     const std::vector<species_id_t>& reactant_species,
-    const double pb_factor,
-    RxnClassPathwayVector& pathways
-) {
+    ComplexRxnProductSets& product_sets
+) const {
 
-  // the result of this function is cached in rxnclass
   assert(reactant_species.size() == reactants.size());
   assert(reactant_species.size() == 1 || reactant_species.size() == 2);
 
@@ -1424,13 +1998,17 @@ void RxnRule::create_products_for_complex_rxn(
     set_graph_reactant_pattern_indices(reactants_graph, 0); // only one reactant
   }
 
-  // compute mapping reactant pattern -> reactant
+  // compute mapping reactant pattern -> reactant,
+  // mappings that differ only by a symmetry of the rule give identical products,
+  // only one of them is kept, vertices of the symmetric reactants graph have the same
+  // indices so the symmetry breaking conditions select one mapping from both graphs
   VertexMappingVector pattern_reactant_mappings;
   get_subgraph_isomorphism_mappings(
       patterns_graph, // pattern
       reactants_graph, // actual reactant
       false, // do not stop with first match
-      pattern_reactant_mappings
+      pattern_reactant_mappings,
+      &patterns_symmetry
   );
 
   if (use_symmetric_reactants_graph) {
@@ -1440,7 +2018,8 @@ void RxnRule::create_products_for_complex_rxn(
         patterns_graph, // pattern
         symmetric_reactants_graph, // actual reactant
         false, // do not stop with first match
-        symmetric_pattern_reactant_mappings
+        symmetric_pattern_reactant_mappings,
+        &patterns_symmetry
     );
     pattern_reactant_mappings.insert(
         pattern_reactant_mappings.end(),
@@ -1457,80 +2036,73 @@ void RxnRule::create_products_for_complex_rxn(
   release_assert(pattern_reactant_mappings.size() < MAX_PRODUCT_SETS_PER_RXN
       && "Encountered a huge number of potential product sets for a single reaction");
 
+#ifndef NDEBUG
+  {
+    // each kept mapping represents exactly patterns_symmetry.factor mappings
+    VertexMappingVector all_mappings;
+    get_subgraph_isomorphism_mappings(patterns_graph, reactants_graph, false, all_mappings);
+    size_t num_all_mappings = all_mappings.size();
+    if (use_symmetric_reactants_graph) {
+      get_subgraph_isomorphism_mappings(patterns_graph, symmetric_reactants_graph, false, all_mappings);
+      num_all_mappings += all_mappings.size();
+    }
+    assert((double)num_all_mappings == pattern_reactant_mappings.size() * patterns_symmetry.factor);
+  }
+#endif
+
   if (bng_config.notifications.bng_verbosity_level >= 1) {
-    cout << "  - found " << pattern_reactant_mappings.size() << " potential products";
+    cout << "  - found " << pattern_reactant_mappings.size() << " potential products up to symmetry " <<
+        patterns_symmetry.factor;
     cout.flush();
   }
 
   // sort the mappings to make sure we get identical results everywhere
   sort_mappings(pattern_reactant_mappings);
 
-  // decide whether only cache the possible products
+  // decide whether only cache the possible products, species of the products
+  // are defined once the pathway is used, see RxnClass::get_rxn_products_for_pathway
   if (pattern_reactant_mappings.size() > MAX_IMMEDIATELLY_COMPUTED_PRODUCT_SETS_PER_RXN &&
-      !has_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS)) {
-
-    for (const VertexMapping& mapping: pattern_reactant_mappings) {
-      // define the products as species
-      RxnProductsVector product_species;
-
-      // we cannot sort the products because we do not know what they are
-      // FIXME: we should unify this... - changing MAX_IMMEDIATELLY_COMPUTED_PRODUCT_SETS_PER_RXN
-      // may change results
-
-      // the probability is divided by the number of mapping of pattern onto pattern
-      // because so many more product sets we will get
-      double prob = compute_rxn_probability(bng_config, pb_factor);
-
-      pathways.push_back(RxnClassPathway(id, prob, mapping));
-    }
+      !kept_mappings_may_produce_identical_products()) {
+    product_sets.lazy_mappings = pattern_reactant_mappings;
     return;
   }
 
-  vector<vector<Cplx>> input_reactants_copies;
-  vector<Graph> distinct_product_graphs;
-#ifndef NDEBUG
-  vector<Graph> debug_distinct_product_graphs;
-#endif
-
-  // now, for each of the mappings, compute what different products we might get
-  for (const VertexMapping& mapping: pattern_reactant_mappings) {
-
+  ProductSetsVector& created_product_sets = product_sets.product_sets;
 
-  #ifdef DEBUG_CPLX_MATCHING
-    cout << "Products:\n";
-    dump_graph(products_graph);
-  #endif
-
-    // we need to make a copy of the reactants because we will be modifying them
-    // a new graph will have its ordering indices cleared
-    input_reactants_copies.push_back(vector<Cplx>());
-    vector<Cplx>& input_reactants_copy = input_reactants_copies.back();
-    for (const Cplx* ci: input_reactants) {
-      input_reactants_copy.push_back(*ci);
-    }
-    Graph reactants_graph_copy = input_reactants_copy[0].get_graph();
-    if (input_reactants_copy.size() == 2) {
-      merge_graphs(reactants_graph_copy, input_reactants_copy[1].get_graph());
+  if (!kept_mappings_may_produce_identical_products()) {
+    // each kept match is a unique product because the only symmetries of the patterns
+    // are symmetries of the rule and there are no multiple components of the same name
+    for (const VertexMapping& mapping: pattern_reactant_mappings) {
+      created_product_sets.push_back(ProductCplxWIndicesVector());
+      create_products_for_mapping(input_reactants, mapping, created_product_sets.back());
     }
 
-    set_ordering_indices(reactants_graph_copy);
-
-    // manipulate nodes using information about products
-    apply_rxn_on_reactants_graph(
-        *bng_data,
-        reactants_graph_copy,
-        mapping,
-        patterns_graph,
-        products_to_patterns_mapping,
-        products_graph
-    );
-
-  #ifdef DEBUG_CPLX_MATCHING
-    cout << "\nReactants after applying rxn:\n";
-    dump_graph(reactants_graph_copy);
+  #ifndef NDEBUG
+    // the assumption above should be ok but to be sure let's check it,
+    // this covers both rules without symmetries and rules whose symmetries were
+    // removed by symmetry breaking (kept_mappings_give_unique_products)
+    vector<vector<Cplx>> debug_input_reactants_copies;
+    vector<Graph> debug_distinct_product_graphs;
+    for (const VertexMapping& mapping: pattern_reactant_mappings) {
+      Graph reactants_graph_copy;
+      apply_rxn_on_reactants_copy(input_reactants, mapping, debug_input_reactants_copies, reactants_graph_copy);
+      if (is_graph_unique_wrt_modified_ordering(reactants_graph_copy, debug_distinct_product_graphs)) {
+        debug_distinct_product_graphs.push_back(reactants_graph_copy);
+      }
+    }
+    assert(debug_distinct_product_graphs.size() == pattern_reactant_mappings.size() &&
+        "Each kept mapping must give a unique product");
   #endif
+  }
+  else {
+    vector<vector<Cplx>> input_reactants_copies;
+    vector<Graph> distinct_product_graphs;
+
+    // now, for each of the mappings, compute what different products we might get
+    for (const VertexMapping& mapping: pattern_reactant_mappings) {
+      Graph reactants_graph_copy;
+      apply_rxn_on_reactants_copy(input_reactants, mapping, input_reactants_copies, reactants_graph_copy);
 
-    if (has_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS)) {
       // we must verify that we don't have this product yet,
       // this is quite time expensive
       // TODO: some optimization is needed
@@ -1538,60 +2110,81 @@ void RxnRule::create_products_for_complex_rxn(
         distinct_product_graphs.push_back(reactants_graph_copy);
       }
     }
-    else {
-      // each match is a unique product because the patterns are not symmetrical and
-      // there are no multiple components of the same name
-      distinct_product_graphs.push_back(reactants_graph_copy);
 
-    #ifndef NDEBUG
-      // the assumption above should be ok but to be sure let's check it
-      if (is_graph_unique_wrt_modified_ordering(reactants_graph_copy, debug_distinct_product_graphs)) {
-        debug_distinct_product_graphs.push_back(reactants_graph_copy);
-      }
-    #endif
+    for (Graph& product_graph: distinct_product_graphs) {
+      // and finally create products, each disconnected graph in the result is a
+      // separate complex
+      created_product_sets.push_back(ProductCplxWIndicesVector());
+      create_products_from_reactants_graph(bng_data, product_graph, created_product_sets.back());
     }
   }
 
-#ifndef NDEBUG
-  if (!has_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS)) {
-    assert(distinct_product_graphs.size() == debug_distinct_product_graphs.size());
+  if (bng_config.notifications.bng_verbosity_level >= 1) {
+    cout << ", of it " << created_product_sets.size() << " unique products\n";
+  }
+
+#ifdef DEBUG_CPLX_MATCHING
+  cout << "Resulting products:\n";
+  for (auto& product_set: created_product_sets) {
+    for (auto& c: product_set) {
+      c.product_species->dump();
+      cout << "\n";
+    }
   }
 #endif
 
-  if (bng_config.notifications.bng_verbosity_level >= 1) {
-    cout << ", of it " << distinct_product_graphs.size() << " unique products\n";
+  for (ProductCplxWIndicesVector& product_cplxs: created_product_sets) {
+    // sort products by the rxn rule product indices (if applicable)
+    sort(product_cplxs.begin(), product_cplxs.end(), less_product_cplxs_by_rxn_rule_index);
+
+    // canonicalization is the costly part, the species are only looked up when they are defined
+    for (ProductSpeciesPtrWIndices& product_w_indices: product_cplxs) {
+      product_w_indices.product_species->finalize_species(bng_config);
+    }
   }
+}
 
-  ProductSetsVector created_product_sets;
-  for (Graph& product_graph: distinct_product_graphs) {
-    // and finally create products, each disconnected graph in the result is a
-    // separate complex
 
-    created_product_sets.push_back(ProductCplxWIndicesVector());
-    create_products_from_reactants_graph(bng_data, product_graph, created_product_sets.back());
+void RxnRule::create_products_for_complex_rxn(
+    SpeciesContainer& all_species,
+    const BNGConfig& bng_config,
+    const std::vector<species_id_t>& reactant_species,
+    const double pb_factor,
+    RxnClassPathwayVector& pathways,
+    ComplexRxnProductSets* computed_product_sets
+) {
 
-  #ifdef DEBUG_CPLX_MATCHING
-    cout << "Resulting products:\n";
-    for (auto& c: created_product_sets.back()) {
-      c.product_species->dump();
-      cout << "\n";
+  // the result of this function is cached in rxnclass
+  ComplexRxnProductSets product_sets;
+  if (computed_product_sets == nullptr) {
+    if (is_bimol()) {
+      // update cache to be sure
+      species_can_be_reactant(reactant_species[0], all_species);
+      species_can_be_reactant(reactant_species[1], all_species);
     }
-  #endif
+    compute_product_sets_for_specific_reactants(all_species, bng_config, reactant_species, product_sets);
+    computed_product_sets = &product_sets;
+  }
+
+  // each product set stands for patterns_symmetry.factor mappings that give the same products,
+  // the rate constant is divided by the symmetry factor as in BioNetGen and multiplied by
+  // the number of such mappings so the probability of each product set is not changed
+  assert(!cmp_eq(get_rate_constant(), DBL_GIGANTIC));
+  double prob = compute_rxn_probability(bng_config, pb_factor);
 
+  // products are defined once the pathway is used
+  for (const VertexMapping& mapping: computed_product_sets->lazy_mappings) {
+    pathways.push_back(RxnClassPathway(id, prob, mapping));
   }
 
   // and convert resulting complexes represented by Species* to species ids
-  for (ProductCplxWIndicesVector& product_cplxs: created_product_sets) {
+  for (ProductCplxWIndicesVector& product_cplxs: computed_product_sets->product_sets) {
     // define the products as species
     RxnProductsVector product_species;
 
-    // sort products by the rxn rule product indices (if applicable)
-    sort(product_cplxs.begin(), product_cplxs.end(), less_product_cplxs_by_rxn_rule_index);
-
     // iterating over map sorted by product indices
     for (ProductSpeciesPtrWIndices& product_w_indices: product_cplxs) {
       // need to transform cplx into species id, the possibly new species will be removable
-      product_w_indices.product_species->finalize_species(bng_config);
       species_id_t species_id = all_species.find_or_add_delete_if_exist(
           product_w_indices.product_species, true);
 
@@ -1600,67 +2193,54 @@ void RxnRule::create_products_for_complex_rxn(
           ProductSpeciesIdWIndices(species_id, product_w_indices.rule_product_indices));
     }
 
-    assert(!cmp_eq(get_rate_constant(), DBL_GIGANTIC));
-
-    // the probability is divided by the number of mapping of pattern onto pattern
-    // because so many more product sets we will get
-    double prob = compute_rxn_probability(bng_config, pb_factor);
-
     pathways.push_back(RxnClassPathway(id, prob, product_species));
   }
+  computed_product_sets->lazy_mappings.clear();
+  computed_product_sets->product_sets.clear();
 }
 
 
-// TODO: very similar code as in the function above, must be unified
-void RxnRule::define_rxn_pathway_using_mapping(
-  SpeciesContainer& all_species,
+void RxnRule::compute_pathway_products_using_mapping(
+  const SpeciesContainer& all_species,
   const BNGConfig& bng_config,
   const std::vector<species_id_t>& reactant_species,
-  RxnClassPathway& pathway
+  const RxnClassPathway& pathway,
+  ProductCplxWIndicesVector& product_cplxs
 ) const {
   assert(!pathway.products_are_defined);
   assert(!pathway.rule_mapping_onto_reactants.empty());
 
-  // we need to make a copy of the reactants because we will be modifying them
-  // a new graph will have its ordering indices cleared
-  vector<Cplx> input_reactants_copy;
-  input_reactants_copy.reserve(2);
+  vector<const Cplx*> input_reactants;
   for (species_id_t s_id: reactant_species) {
-    input_reactants_copy.push_back(all_species.get(s_id));
+    input_reactants.push_back(dynamic_cast<const Cplx*>(&all_species.get(s_id)));
   }
 
-  // and create a graph from them
-  // because we creating it from canonical species, we know for sure that this is the same
-  // graph as was used when mapping was computed
-  Graph reactants_graph = input_reactants_copy[0].get_graph();
-  if (input_reactants_copy.size() == 2) {
-    merge_graphs(reactants_graph, input_reactants_copy[1].get_graph());
-  }
+  // because the reactants are canonical species, the layout of their merged graph
+  // is the same as when the mapping was computed
+  product_cplxs.clear();
+  create_products_for_mapping(input_reactants, pathway.rule_mapping_onto_reactants, product_cplxs);
 
-  set_ordering_indices(reactants_graph);
+  // sort products by the rxn rule product indices (if applicable)
+  sort(product_cplxs.begin(), product_cplxs.end(), less_product_cplxs_by_rxn_rule_index);
 
-  // manipulate nodes using information about products and the precomputed mapping
-  apply_rxn_on_reactants_graph(
-      *bng_data,
-      reactants_graph,
-      pathway.rule_mapping_onto_reactants,
-      patterns_graph,
-      products_to_patterns_mapping,
-      products_graph
-  );
+  // canonicalization is the costly part, the species are only looked up when they are defined
+  for (ProductSpeciesPtrWIndices& product_w_indices: product_cplxs) {
+    product_w_indices.product_species->finalize_species(bng_config);
+  }
+}
 
-  // convert graph with products into cplx instances
-  ProductCplxWIndicesVector product_cplxs;
-  create_products_from_reactants_graph(bng_data, reactants_graph, product_cplxs);
 
-  // sort products by the rxn rule product indices (if applicable)
-  sort(product_cplxs.begin(), product_cplxs.end(), less_product_cplxs_by_rxn_rule_index);
+void RxnRule::define_rxn_pathway_using_products(
+  SpeciesContainer& all_species,
+  ProductCplxWIndicesVector& product_cplxs,
+  RxnClassPathway& pathway
+) {
+  assert(!pathway.products_are_defined);
 
-  // and cplx instances into species
+  // cplx instances into species
   // we are not setting the resulting compartment, neither orientation
   for (ProductSpeciesPtrWIndices& product_w_indices: product_cplxs) {
-    // need to transform cplx into species id, the possibly new species will be removable
-    product_w_indices.product_species->finalize_species(bng_config);
+    // the possibly new species will be removable
     species_id_t species_id = all_species.find_or_add_delete_if_exist(
         product_w_indices.product_species, true);
 
@@ -1669,6 +2249,7 @@ void RxnRule::define_rxn_pathway_using_mapping(
         ProductSpeciesIdWIndices(species_id, product_w_indices.rule_product_indices)
     );
   }
+  product_cplxs.clear();
 
   pathway.rule_mapping_onto_reactants.clear();
   pathway.products_are_defined = true;
@@ -2028,7 +2609,7 @@ void RxnRule::get_reactant_indices(
   }
 
   for (uint i = 0; i < reactants.size(); i++) {
-    if (species_applicable_as_reactant[i].count(species_id)) {
+    if (species_applicability.matches(species_id, i)) {
       indices.push_back(i);
     }
   }
@@ -2053,19 +2634,15 @@ void RxnRule::get_reactant_indices_uncached(
 void RxnRule::get_bimol_reactant_indices(
     const species_id_t id1, const species_id_t id2,
     const SpeciesContainer& all_species,
-    std::vector<std::pair<uint, uint>>& reac_indices) {
+    std::vector<std::pair<uint, uint>>& reac_indices) const {
 
   assert(is_bimol());
 
-  // update cache to be sure
-  species_can_be_reactant(id1, all_species);
-  species_can_be_reactant(id2, all_species);
-
   bool id1_matches[2] = {false, false};
   bool id2_matches[2] = {false, false};
   for (size_t i = 0; i < reactants.size(); i++) {
-    id1_matches[i] = species_applicable_as_reactant[i].count(id1) != 0;
-    id2_matches[i] = species_applicable_as_reactant[i].count(id2) != 0;
+    id1_matches[i] = species_applicability.matches(id1, i);
+    id2_matches[i] = species_applicability.matches(id2, i);
   }
 
   if (id1_matches[0] && id2_matches[1]) {
@@ -2082,37 +2659,76 @@ void RxnRule::get_bimol_reactant_indices(
 
 bool RxnRule::species_can_be_reactant(const species_id_t id, const SpeciesContainer& all_species) {
 
-  // check caches first - if we processed this species
-  if (species_applicable_as_any_reactant.count(id) != 0) {
-    return true;
+  // check cache first - if we processed this species
+  if (species_applicability.is_known(id)) {
+    return species_applicability.matches_any(id);
   }
-  if (species_not_applicable_as_any_reactant.count(id) != 0) {
-    return false;
+
+  std::vector<uint> indices;
+  if (is_explicit()) {
+    compute_species_reactant_indices(id, all_species, indices);
+  }
+  else if (reactant_pattern_table != nullptr) {
+    // result may be already known from other rxn rules with the same patterns
+    for (uint i = 0; i < reactants.size(); i++) {
+      if (reactant_pattern_table->species_matches(reactant_pattern_ids[i], id, all_species)) {
+        indices.push_back(i);
+      }
+    }
+  }
+  else {
+    // need to check whether the complex instance can be a reactant
+    get_reactant_indices_uncached(all_species.get_as_cplx(id), all_species, indices);
   }
 
-  // need to check whether the complex instance can be a reactant
-  const Cplx& inst = all_species.get_as_cplx(id);
+  set_species_reactant_indices(id, indices);
 
-  std::vector<uint> indices;
-  get_reactant_indices_uncached(inst, all_species, indices);
+  return !indices.empty();
+}
 
-  if (!indices.empty()) {
-    species_applicable_as_any_reactant.insert_unique(id);
-    for (uint i: indices) {
-      species_applicable_as_reactant[i].insert_unique(id);
-    }
 
-    return true;
+void RxnRule::compute_species_reactant_indices(
+    const species_id_t id, const SpeciesContainer& all_species,
+    std::vector<uint>& indices) const {
+
+  if (is_explicit()) {
+    // reactants are specific species, no matching is needed
+    for (uint i = 0; i < explicit_reactant_species_ids.size(); i++) {
+      if (explicit_reactant_species_ids[i] == id) {
+        indices.push_back(i);
+      }
+    }
   }
-  else {
-    species_not_applicable_as_any_reactant.insert_unique(id);
-    species_not_applicable_as_reactant[0].insert_unique(id);
-    if (is_bimol()) {
-      species_not_applicable_as_reactant[1].insert_unique(id);
+  else if (reactant_pattern_table != nullptr) {
+    for (uint i = 0; i < reactants.size(); i++) {
+      if (reactant_pattern_table->species_matches_no_cache_update(reactant_pattern_ids[i], id, all_species)) {
+        indices.push_back(i);
+      }
     }
+  }
+  else {
+    get_reactant_indices_uncached(all_species.get_as_cplx(id), all_species, indices);
+  }
+}
 
-    return false;
+
+void RxnRule::set_reactant_pattern_table(ReactantPatternTable& table) {
+  assert(is_finalized());
+  reactant_pattern_table = &table;
+  reactant_pattern_ids.clear();
+  for (const Cplx& reactant: reactants) {
+    reactant_pattern_ids.push_back(table.add_pattern(reactant));
+  }
+}
+
+
+void RxnRule::set_species_reactant_indices(const species_id_t id, const std::vector<uint>& indices) {
+  bool matches[2] = {false, false};
+  for (uint i: indices) {
+    assert(i < 2);
+    matches[i] = true;
   }
+  species_applicability.set(id, reactants.size(), matches[0], matches[1]);
 }
 
 
@@ -2134,8 +2750,8 @@ bool RxnRule::species_can_be_bimol_reactants(
   bool id1_matches[2] = {false, false};
   bool id2_matches[2] = {false, false};
   for (size_t i = 0; i < reactants.size(); i++) {
-    id1_matches[i] = species_applicable_as_reactant[i].count(id1) != 0;
-    id2_matches[i] = species_applicable_as_reactant[i].count(id2) != 0;
+    id1_matches[i] = species_applicability.matches(id1, i);
+    id2_matches[i] = species_applicability.matches(id2, i);
   }
 
   // there must be direct or crossed covering of the reactants, i.e.
@@ -2183,19 +2799,14 @@ bool RxnRule::species_is_both_bimol_reactants(const species_id_t id, const Speci
   }
 
   return
-      species_applicable_as_reactant[0].count(id) != 0 &&
-      species_applicable_as_reactant[1].count(id) != 0;
+      species_applicability.matches(id, 0) &&
+      species_applicability.matches(id, 1);
 }
 
 
 void RxnRule::remove_species_id_references(const species_id_t id) {
   // this rxn rule might not have seen this species
-  species_applicable_as_any_reactant.erase(id);
-  species_applicable_as_reactant[0].erase(id);
-  species_applicable_as_reactant[1].erase(id);
-  species_not_applicable_as_any_reactant.erase(id);
-  species_not_applicable_as_reactant[0].erase(id);
-  species_not_applicable_as_reactant[1].erase(id);
+  species_applicability.reset(id);
 }
 
 
@@ -2211,31 +2822,27 @@ bool RxnRule::update_variable_rxn_rate(const double current_time, const RxnClass
     return false;
   }
 
-  // find which time to use - the highest but still smaller than the following one
-  size_t current_index = next_variable_rate_index;
-  while (current_index < base_variable_rates.size() &&
-          (current_time > base_variable_rates[current_index + 1].time ||
-           cmp_eq(current_time, base_variable_rates[current_index + 1].time)
-        )
-  ) {
-    current_index++;
-  }
-
-  // should we use the last entry?
-  if (current_index == base_variable_rates.size() &&
-      next_variable_rate_index == current_index - 1) {
-    current_index = next_variable_rate_index;
-  }
+  // find which time to use - the last one that is not after current_time,
+  // rates are sorted by time so binary search can be used
+  auto it_first_after = std::upper_bound(
+      base_variable_rates.begin() + next_variable_rate_index, base_variable_rates.end(), current_time,
+      [](const double time, const RxnRateInfo& ri) -> bool {
+        return time < ri.time && !cmp_eq(time, ri.time);
+      }
+  );
+  assert(it_first_after != base_variable_rates.begin() + next_variable_rate_index);
+  size_t current_index = (it_first_after - base_variable_rates.begin()) - 1;
 
   // current_time >= time for next change
   base_rate_constant = base_variable_rates[current_index].rate_constant;
   next_variable_rate_index = current_index + 1;
 
-  // notify parents that update is needed
+  // notify parents that update is needed,
+  // products stay the same, only probabilities are recomputed
   for (RxnClass* user: rxn_classes_where_used) {
     // do not call update on the class that called us
     if (user != requester) {
-      user->update_rxn_rates_if_needed(current_time);
+      user->update_pathway_probabilities();
     }
   }
 
@@ -2243,6 +2850,27 @@ bool RxnRule::update_variable_rxn_rate(const double current_time, const RxnClass
 }
 
 
+void RxnRule::remove_rxn_class_where_used(RxnClass* rxn_class, const uint index) {
+  assert(index < rxn_classes_where_used.size());
+  assert(rxn_classes_where_used[index] == rxn_class);
+
+  RxnClass* moved = rxn_classes_where_used.back();
+  rxn_classes_where_used[index] = moved;
+  rxn_classes_where_used.pop_back();
+  if (moved != rxn_class) {
+    moved->set_rxn_rule_where_used_index(id, index);
+  }
+}
+
+
+void RxnRule::set_variable_rates(const std::vector<RxnRateInfo>& rates) {
+  base_variable_rates.assign(rates.begin(), rates.end());
+  // keep the order of entries with the same time
+  std::stable_sort(base_variable_rates.begin(), base_variable_rates.end());
+  next_variable_rate_index = 0;
+}
+
+
 bool RxnRule::update_rxn_rate(const double new_rate) {
 
   // skip if rate is the same
@@ -2253,11 +2881,10 @@ bool RxnRule::update_rxn_rate(const double new_rate) {
   // update the rate
   base_rate_constant = new_rate;
 
-  // notify parents that update is needed
+  // notify parents that update is needed,
+  // products stay the same, only probabilities are recomputed
   for (RxnClass* user: rxn_classes_where_used) {
-    // NOTE: this can be done more efficiently if needed,
-    // no need to recompute products again
-    user->init_rxn_pathways_and_rates(true);
+    user->update_pathway_probabilities();
   }
 
   return true;
@@ -12,6 +12,8 @@
 
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <bitset>
 
 #include "bng/bng_defines.h"
 #include "bng/cplx.h"
@@ -21,6 +23,93 @@ namespace BNG {
 class BNGData;
 class SpeciesContainer;
 class RxnClass;
+class ReactantPatternTable;
+
+/**
+ * Set of indices of rxn rule products stored as a bitmask,
+ * has the same interface as std::set<uint> for the operations we need,
+ * iteration goes in ascending order.
+ */
+class RuleProductIndices {
+public:
+  // rxn rules with more products are not supported
+  static const uint MAX_NUM_PRODUCTS = 64;
+
+  class const_iterator {
+  public:
+    const_iterator(const uint64_t remaining_)
+      : remaining(remaining_) {
+    }
+
+    // index of the lowest set bit
+    uint operator*() const {
+      assert(remaining != 0);
+      uint index = 0;
+      while ((remaining & ((uint64_t)1 << index)) == 0) {
+        index++;
+      }
+      return index;
+    }
+
+    const_iterator& operator++() {
+      // clear the lowest set bit
+      remaining &= remaining - 1;
+      return *this;
+    }
+
+    bool operator == (const const_iterator& other) const {
+      return remaining == other.remaining;
+    }
+
+    bool operator != (const const_iterator& other) const {
+      return remaining != other.remaining;
+    }
+
+  private:
+    uint64_t remaining;
+  };
+
+  RuleProductIndices()
+    : mask(0) {
+  }
+
+  void insert(const uint index) {
+    release_assert(index < MAX_NUM_PRODUCTS && "Rxn rules with more than 64 products are not supported");
+    mask |= (uint64_t)1 << index;
+  }
+
+  size_t count(const uint index) const {
+    return (index < MAX_NUM_PRODUCTS && (mask & ((uint64_t)1 << index)) != 0) ? 1 : 0;
+  }
+
+  bool empty() const {
+    return mask == 0;
+  }
+
+  size_t size() const {
+    return std::bitset<MAX_NUM_PRODUCTS>(mask).count();
+  }
+
+  void clear() {
+    mask = 0;
+  }
+
+  const_iterator begin() const {
+    return const_iterator(mask);
+  }
+
+  const_iterator end() const {
+    return const_iterator(0);
+  }
+
+  bool operator == (const RuleProductIndices& other) const {
+    return mask == other.mask;
+  }
+
+private:
+  uint64_t mask;
+};
+
 
 /**
  * Used to hold information on a single product and
@@ -47,17 +136,23 @@ public:
   // general case
   ProductSpeciesIdWIndices(
       const species_id_t product_species_id_,
-      const std::set<uint>& rule_product_indices_)
+      const RuleProductIndices& rule_product_indices_)
     : product_species_id(product_species_id_),
       rule_product_indices(rule_product_indices_) {
   }
 
   species_id_t product_species_id;
-  // must use container with guaranteed order
-  std::set<uint> rule_product_indices;
+  // iterated in ascending order
+  RuleProductIndices rule_product_indices;
 };
 
+#ifndef INDEXER_WA
+// products of the usual rxns with up to 2 products are stored inline in RxnClassPathway,
+// so pathways of a rxn class along with their products occupy a single contiguous array
+typedef boost::container::small_vector<ProductSpeciesIdWIndices, 2> RxnProductsVector;
+#else
 typedef std::vector<ProductSpeciesIdWIndices> RxnProductsVector;
+#endif
 
 /**
  * Similar as ProductSpeciesWIndices, only uses cplx inst instead of species id.
@@ -66,7 +161,7 @@ class ProductSpeciesPtrWIndices {
 public:
   ProductSpeciesPtrWIndices(
       Species* product_species_,
-      const std::set<uint>& rule_product_indices_)
+      const RuleProductIndices& rule_product_indices_)
     : product_species(product_species_),
       rule_product_indices(rule_product_indices_) {
   }
@@ -74,8 +169,8 @@ public:
   // does not own this object
   Species* product_species;
 
-  // must use container with guaranteed order
-  std::set<uint> rule_product_indices;
+  // iterated in ascending order
+  RuleProductIndices rule_product_indices;
 };
 
 typedef std::vector<ProductSpeciesPtrWIndices> ProductCplxWIndicesVector;
@@ -84,6 +179,18 @@ typedef std::vector<ProductSpeciesPtrWIndices> ProductCplxWIndicesVector;
 // - second dimension are individual products
 typedef std::vector<std::vector<ProductSpeciesPtrWIndices>> ProductSetsVector;
 
+// products of a complex rxn rule for specific reactants computed by
+// RxnRule::compute_product_sets_for_specific_reactants,
+// the product species are finalized but not added to the species container yet
+struct ComplexRxnProductSets {
+  // set when there are too many product sets to compute them immediately,
+  // each mapping then defines a pathway whose products are computed once it is used
+  VertexMappingVector lazy_mappings;
+
+  // owns the product species
+  ProductSetsVector product_sets;
+};
+
 
 // TODO: some of these classes rather belong to rxn_class.h
 /**
@@ -153,6 +260,70 @@ struct CplxIndexPair {
 };
 
 
+// primitive modification of reactants made by a complex rxn rule,
+// reactant vertices are addressed by vertices of the reactant patterns graph
+enum class RxnRuleEditType {
+  SetProductIndex,   // marks elementary molecule as a part of product 'id'
+  SetState,          // sets state 'id' of a component
+  SetBond,           // sets bond of a component according to 'bond_value' of the product
+  ChangeElemMolType, // changes type of an elementary molecule to 'id'
+  SetCompartment     // sets compartment 'id' of an elementary molecule
+};
+
+
+struct RxnRuleEdit {
+  RxnRuleEdit(const RxnRuleEditType type_, const vertex_descriptor_t pattern_vertex_, const uint id_)
+    : type(type_), pattern_vertex(pattern_vertex_), id(id_),
+      bond_value(BOND_VALUE_INVALID), target_is_new_component(false),
+      target_pattern_vertex(0), target_new_component_index(INDEX_INVALID) {
+  }
+
+  RxnRuleEditType type;
+  vertex_descriptor_t pattern_vertex;
+  uint id;
+
+  // used for SetBond, a numeric bond value connects the component either with a component
+  // addressed by pattern vertex or with a component of a newly created elementary molecule
+  bond_value_t bond_value;
+  bool target_is_new_component;
+  vertex_descriptor_t target_pattern_vertex;
+  uint target_new_component_index;
+};
+
+
+// bond of a component of a newly created elementary molecule,
+// new components are indexed in the order of new elementary molecules and their components
+struct RxnRuleNewBond {
+  uint new_component_index;
+  bool target_is_new_component;
+  vertex_descriptor_t target_pattern_vertex;
+  uint target_new_component_index;
+};
+
+
+// rxn rule compiled into a list of edits applied directly to copies of reactant elementary molecules,
+// products are then the connected parts of the result, valid only when 'compiled' is true
+struct RxnRuleEditScript {
+  RxnRuleEditScript()
+    : compiled(false) {
+  }
+
+  void clear() {
+    compiled = false;
+    edits.clear();
+    new_elem_mols.clear();
+    new_elem_mol_product_indices.clear();
+    new_bonds.clear();
+  }
+
+  bool compiled;
+  std::vector<RxnRuleEdit> edits;
+  std::vector<ElemMol> new_elem_mols;
+  std::vector<uint> new_elem_mol_product_indices;
+  std::vector<RxnRuleNewBond> new_bonds;
+};
+
+
 struct RxnRateInfo {
   double time;
   double rate_constant;
@@ -162,6 +333,107 @@ struct RxnRateInfo {
   }
 };
 
+/**
+ * Cache of results of matching species onto reactant patterns of a rxn rule,
+ * indexed by species id.
+ * Each reactant slot uses two bits - whether the result is known and
+ * whether the species matches, i.e. each species takes 4 bits.
+ */
+class SpeciesApplicabilityBitmap {
+public:
+  SpeciesApplicabilityBitmap()
+    : num_applicable(0), num_not_applicable(0) {
+  }
+
+  bool is_known(const species_id_t id) const {
+    return (get_nibble(id) & KNOWN_BIT0) != 0;
+  }
+
+  bool matches(const species_id_t id, const uint reactant_index) const {
+    assert(reactant_index < 2);
+    assert(is_known(id));
+    return (get_nibble(id) & (MATCHES_BIT0 << (2 * reactant_index))) != 0;
+  }
+
+  bool matches_any(const species_id_t id) const {
+    assert(is_known(id));
+    return (get_nibble(id) & (MATCHES_BIT0 | MATCHES_BIT1)) != 0;
+  }
+
+  // num_reactants tells which reactant slots are valid
+  void set(const species_id_t id, const uint num_reactants, const bool matches0, const bool matches1) {
+    assert(num_reactants <= 2);
+    assert(!is_known(id));
+    uint8_t nibble = 0;
+    if (num_reactants >= 1) {
+      nibble |= KNOWN_BIT0 | (matches0 ? MATCHES_BIT0 : 0);
+    }
+    if (num_reactants == 2) {
+      nibble |= KNOWN_BIT1 | (matches1 ? MATCHES_BIT1 : 0);
+    }
+
+    size_t byte_index = id / 2;
+    if (byte_index >= bits.size()) {
+      bits.resize(byte_index + 1, 0);
+    }
+    bits[byte_index] |= nibble << (4 * (id % 2));
+
+    if (matches0 || matches1) {
+      num_applicable++;
+    }
+    else {
+      num_not_applicable++;
+    }
+  }
+
+  // forgets the result for this species, used when the species is removed
+  void reset(const species_id_t id) {
+    if (!is_known(id)) {
+      return;
+    }
+    if (matches_any(id)) {
+      num_applicable--;
+    }
+    else {
+      num_not_applicable--;
+    }
+    bits[id / 2] &= ~(0xF << (4 * (id % 2)));
+  }
+
+  size_t get_num_applicable() const {
+    return num_applicable;
+  }
+
+  size_t get_num_not_applicable() const {
+    return num_not_applicable;
+  }
+
+  size_t get_memory_size() const {
+    return bits.capacity();
+  }
+
+private:
+  static const uint8_t KNOWN_BIT0 = 1;
+  static const uint8_t MATCHES_BIT0 = 2;
+  static const uint8_t KNOWN_BIT1 = 4;
+  static const uint8_t MATCHES_BIT1 = 8;
+
+  uint8_t get_nibble(const species_id_t id) const {
+    size_t byte_index = id / 2;
+    if (byte_index >= bits.size()) {
+      return 0;
+    }
+    return (bits[byte_index] >> (4 * (id % 2))) & 0xF;
+  }
+
+  // two species per byte, species with even id uses the lower 4 bits
+  std::vector<uint8_t> bits;
+
+  size_t num_applicable;
+  size_t num_not_applicable;
+};
+
+
 enum class RxnType {
   Invalid,
   // Standard is any other reaction than below,
@@ -183,7 +455,10 @@ public:
     : id(RXN_RULE_ID_INVALID), type(RxnType::Invalid),
       base_rate_constant(FLT_INVALID),
       mol_instances_are_fully_maintained(false),
+      cplxs_are_canonical(false),
       next_variable_rate_index(0),
+      kept_mappings_give_unique_products(false),
+      reactant_pattern_table(nullptr),
       bng_data(bng_data_)
       {
   }
@@ -194,6 +469,55 @@ public:
   // and to set orientations from compartments
   void finalize();
 
+  // finalizes a rxn rule whose reactants and products are the given species,
+  // e.g. a rxn of a network that was already generated by BioNetGen,
+  // graphs for pattern matching and for creation of products are not built,
+  // the rule is used only through rxn classes with explicit pathways
+  // (see RxnContainer::add_explicit_rxn)
+  void finalize_explicit(
+      const std::vector<species_id_t>& reactant_species_ids,
+      const std::vector<species_id_t>& product_species_ids);
+
+  bool is_explicit() const {
+    return !explicit_reactant_species_ids.empty();
+  }
+
+  // valid only for explicit rxns
+  const std::vector<species_id_t>& get_explicit_reactant_species_ids() const {
+    assert(is_explicit());
+    return explicit_reactant_species_ids;
+  }
+
+  const std::vector<species_id_t>& get_explicit_product_species_ids() const {
+    assert(is_explicit());
+    return explicit_product_species_ids;
+  }
+
+  // registers reactant patterns in a table shared by multiple rxn rules,
+  // matching of species onto reactants then uses the table's cache,
+  // must be called after finalize
+  void set_reactant_pattern_table(ReactantPatternTable& table);
+
+  pattern_id_t get_reactant_pattern_id(const uint index) const {
+    assert(index < reactant_pattern_ids.size());
+    return reactant_pattern_ids[index];
+  }
+
+  // number of automorphisms of the graph of all reactant patterns that are
+  // also symmetries of the rule, i.e. how many matches of the patterns onto the same
+  // reactants give the same products, computed in finalize
+  double get_patterns_symmetry_factor() const {
+    assert(is_finalized());
+    return patterns_symmetry.factor;
+  }
+
+  // orbit index for each vertex of the reactant patterns graph, vertices in the same
+  // orbit are interchangeable, computed in finalize
+  const std::vector<int>& get_patterns_graph_orbits() const {
+    assert(is_finalized());
+    return patterns_symmetry.orbits;
+  }
+
   // NOTE: must be called only after molecule types are fully known, i.e.
   // whether they are surface or volume reactants otherwise MCell
   // orientation won't be printed
@@ -219,13 +543,13 @@ public:
   // set to true if it was possible to do a mapping between reactants and products
   bool mol_instances_are_fully_maintained;
 
-  // caching
-  // TODO: we are keeping here all the species from the past, might use some cleanup with species cleanup as well
-  uint_set<species_id_t> species_applicable_as_any_reactant; // same as species_applicable_as_reactant[0] for unimol rxns
-  uint_set<species_id_t> species_applicable_as_reactant[2]; // [1] is empty for unimol rxns
+  // set to true when reactants and products are known to be canonical and have their names set
+  // (e.g. rules loaded from a model cache), finalize then does not canonicalize them again
+  bool cplxs_are_canonical;
 
-  uint_set<species_id_t> species_not_applicable_as_any_reactant; // same as species_applicable_as_reactant1 for unimol rxns
-  uint_set<species_id_t> species_not_applicable_as_reactant[2]; // [1] is empty for unimol rxns
+  // caching of species_can_be_reactant results
+  // TODO: we are keeping here all the species from the past, might use some cleanup with species cleanup as well
+  SpeciesApplicabilityBitmap species_applicability;
 
 private:
   // variable reaction rate constants, sorted by time
@@ -237,11 +561,17 @@ private:
   // rate MDL feature, not used in
   // WARNING: do not use to figure out whether which species may be affected because this
   // gets periodically cleaned
-  std::set<RxnClass*> rxn_classes_where_used;
+  // - rxn classes are pooled by RxnContainer so the pointers stay valid until the rxn class
+  //   is deleted, a flat vector is used because rxn classes are often added and removed
+  //   and the whole list is iterated on each rate update
+  // - each rxn class remembers its index in this vector so it is removed in constant time
+  small_vector<RxnClass*> rxn_classes_where_used;
 
 public:
   // - method used when RxnClass is being created
   // - defines new species when needed and might invalidate Species references
+  // - computed_product_sets are products of a complex rxn computed earlier by
+  //   compute_product_sets_for_specific_reactants, ownership of their species is taken over
   // TODO: pass reactants as vector
   void define_rxn_pathways_for_specific_reactants(
       SpeciesContainer& all_species,
@@ -249,17 +579,40 @@ public:
       const species_id_t reactant_a_species_id,
       const species_id_t reactant_b_species_id,
       const double pb_factor,
-      RxnClassPathwayVector& pathways
+      RxnClassPathwayVector& pathways,
+      ComplexRxnProductSets* computed_product_sets = nullptr
   );
 
+  // computes products of a complex rxn for specific reactants without defining any species,
+  // does not modify any shared data so it may be called from multiple threads,
+  // applicability of the reactant species must be already known
+  void compute_product_sets_for_specific_reactants(
+      const SpeciesContainer& all_species,
+      const BNGConfig& bng_config,
+      const std::vector<species_id_t>& reactant_species,
+      ComplexRxnProductSets& product_sets
+  ) const;
+
 
-  void define_rxn_pathway_using_mapping(
-    SpeciesContainer& all_species,
+  // computes finalized product species of a pathway that has only the mapping defined,
+  // the products are not added to all_species so no species ids are assigned,
+  // does not modify any shared data
+  void compute_pathway_products_using_mapping(
+    const SpeciesContainer& all_species,
     const BNGConfig& bng_config,
     const std::vector<species_id_t>& reactant_species,
-    RxnClassPathway& pathway
+    const RxnClassPathway& pathway,
+    ProductCplxWIndicesVector& product_cplxs
   ) const;
 
+  // finds or adds products computed by compute_pathway_products_using_mapping as species
+  // and stores them into the pathway, takes over ownership of the product species
+  static void define_rxn_pathway_using_products(
+    SpeciesContainer& all_species,
+    ProductCplxWIndicesVector& product_cplxs,
+    RxnClassPathway& pathway
+  );
+
   double get_rate_constant() const {
     return base_rate_constant;
   }
@@ -267,6 +620,17 @@ public:
   // converts rxn units in config.use_bng_units is set
   double compute_rxn_probability(const BNGConfig& bng_config, const double pb_factor) const;
 
+  // probability of each pathway created from this rxn rule,
+  // special surface reactions with gigantic rate constant are not scaled by pb_factor
+  double compute_pathway_probability(const BNGConfig& bng_config, const double pb_factor) const {
+    if (cmp_eq(get_rate_constant(), DBL_GIGANTIC)) {
+      return compute_rxn_probability(bng_config, 1);
+    }
+    else {
+      return compute_rxn_probability(bng_config, pb_factor);
+    }
+  }
+
   const Cplx& get_cplx_reactant(const uint index) const {
     assert(index <= reactants.size());
     return reactants[index];
@@ -417,10 +781,11 @@ public:
     }
   }
 
+  // applicability of both species must be already known
   void get_bimol_reactant_indices(
       const species_id_t id1, const species_id_t id2,
       const SpeciesContainer& all_species,
-      std::vector<std::pair<uint, uint>>& reac_indices);
+      std::vector<std::pair<uint, uint>>& reac_indices) const;
 
   void get_reactant_indices(
       const species_id_t species_id, const SpeciesContainer& all_species,
@@ -430,6 +795,16 @@ public:
   // updates local cache
   bool species_can_be_reactant(const species_id_t id, const SpeciesContainer& all_species);
 
+  // - computes the same result as species_can_be_reactant but does not use nor update the cache,
+  // - may be called from multiple threads as long as the species container is not modified,
+  //   the result is then stored with set_species_reactant_indices
+  void compute_species_reactant_indices(
+      const species_id_t id, const SpeciesContainer& all_species,
+      std::vector<uint>& indices) const;
+
+  // stores result of compute_species_reactant_indices into the cache
+  void set_species_reactant_indices(const species_id_t id, const std::vector<uint>& indices);
+
   // returns true if both species can be used as separate reactants for a bimol rxn
   // sets assigned indices if assigned_indexN are not nullptr
   bool species_can_be_bimol_reactants(
@@ -474,18 +849,28 @@ public:
     return has_flag(RXN_FLAG_SIMPLE);
   }
 
-  void add_rxn_class_where_used(RxnClass* rxn_class) {
-    rxn_classes_where_used.insert(rxn_class);
+  // true if products of this complex rule are created using the compiled edit script,
+  // false if the rule is simple or uses a construct that the edit script does not support
+  bool uses_edit_script() const {
+    return edit_script.compiled;
+  }
+
+  // - the caller (RxnClass::add_rxn_rule_no_update) guarantees that the rxn class was not added yet,
+  // - returns index of the rxn class that the rxn class must keep for remove_rxn_class_where_used
+  uint add_rxn_class_where_used(RxnClass* rxn_class) {
+    assert(std::find(rxn_classes_where_used.begin(), rxn_classes_where_used.end(), rxn_class) ==
+        rxn_classes_where_used.end());
+    rxn_classes_where_used.push_back(rxn_class);
+    return rxn_classes_where_used.size() - 1;
   }
 
   void reset_rxn_classes_where_used() {
     rxn_classes_where_used.clear();
   }
 
-  void remove_rxn_class_where_used(RxnClass* rxn_class) {
-    assert(rxn_classes_where_used.count(rxn_class) != 0);
-    rxn_classes_where_used.erase(rxn_class);
-  }
+  // order of rxn classes is not important, the last item is moved into the freed slot
+  // and its rxn class is notified about its new index
+  void remove_rxn_class_where_used(RxnClass* rxn_class, const uint index);
 
   void remove_species_id_references(const species_id_t id);
 
@@ -495,9 +880,14 @@ public:
   }
 
   // returns true if rate was updated
-  // requester is the rxn class that requested this update
+  // requester is the rxn class that requested this update, may be nullptr
   bool update_variable_rxn_rate(const double current_time, const RxnClass* requester);
 
+  // sets the whole schedule of variable rates, the rates are sorted by time,
+  // RxnContainer::init_rxn_rate_schedule must be called afterwards if
+  // RxnContainer::advance_to is used
+  void set_variable_rates(const std::vector<RxnRateInfo>& rates);
+
   double get_next_time_of_rxn_rate_update() const {
     if (may_update_rxn_rate()) {
       return base_variable_rates[next_variable_rate_index].time;
@@ -519,7 +909,43 @@ public:
 
 private:
 
-  void set_product_compartments(Species* product_species, std::set<uint>& product_indices) const;
+  void set_product_compartments(Species* product_species, const RuleProductIndices& product_indices) const;
+
+  // - compiles edit_script from patterns and products graphs,
+  // - returns false if the rule uses a construct that the edit script does not support,
+  //   graphs are used to create products of such rules
+  bool compile_edit_script();
+
+  // creates products from reactants, mapping maps patterns_graph onto the merged graph of reactants
+  void create_products_using_edit_script(
+      const std::vector<const Cplx*>& input_reactants,
+      const VertexMapping& pattern_reactant_mapping,
+      ProductCplxWIndicesVector& created_products
+  ) const;
+
+  // creates products by applying the rule onto a merged graph of reactant copies
+  void create_products_using_graphs(
+      const std::vector<const Cplx*>& input_reactants,
+      const VertexMapping& pattern_reactant_mapping,
+      ProductCplxWIndicesVector& created_products
+  ) const;
+
+  // applies the rule onto a merged graph of copies of input_reactants,
+  // the copies are appended to input_reactants_copies because nodes of the graph point to them
+  void apply_rxn_on_reactants_copy(
+      const std::vector<const Cplx*>& input_reactants,
+      const VertexMapping& pattern_reactant_mapping,
+      std::vector<std::vector<Cplx>>& input_reactants_copies,
+      Graph& reactants_graph_copy
+  ) const;
+
+  // uses edit_script if compiled, graphs otherwise
+  void create_products_for_mapping(
+      const std::vector<const Cplx*>& input_reactants,
+      const VertexMapping& pattern_reactant_mapping,
+      ProductCplxWIndicesVector& created_products
+  ) const;
+
   void create_products_from_reactants_graph(
       const BNGData* bng_data,
       Graph& reactants_graph,
@@ -532,7 +958,8 @@ private:
       const BNGConfig& bng_config,
       const std::vector<species_id_t>& reactant_species,
       const double pb_factor,
-      RxnClassPathwayVector& pathways
+      RxnClassPathwayVector& pathways,
+      ComplexRxnProductSets* computed_product_sets
   );
 
   // use other methods that provide caching instead
@@ -563,7 +990,13 @@ private:
   );
 
   bool may_modify_more_than_one_identical_component() const;
-  bool matching_may_produce_multiple_identical_results() const;
+  uint get_num_patterns_graph_self_matches() const;
+
+  // true if mappings that were kept after symmetry breaking may still produce
+  // identical products, these must be then compared
+  bool kept_mappings_may_produce_identical_products() const {
+    return has_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS) && !kept_mappings_give_unique_products;
+  }
 
   std::string cplx_vector_to_str(const CplxVector& complexes, const bool with_orientation = true) const;
   void dump_cplx_vector(
@@ -571,17 +1004,35 @@ private:
       const std::string ind) const;
 
 
-  // mutable is needed because of usage in create_products_for_complex_rxn
+  // mutable is needed because of usage in compute_product_sets_for_specific_reactants
   // the graphs are not modified, but boost cannot use them as const
   mutable Graph patterns_graph; // graphs based on reactants
   mutable Graph products_graph;
   VertexMapping products_to_patterns_mapping;
 
+  // automorphisms of patterns_graph with identical node labels that
+  // can be extended to products_graph
+  GraphSymmetry patterns_symmetry;
+
+  // set in finalize when the only matches of patterns_graph onto itself are
+  // the automorphisms in patterns_symmetry
+  bool kept_mappings_give_unique_products;
+
+  RxnRuleEditScript edit_script;
+
   // maps complexes from their pattern to the product, they must use the same compartments
   // used mainly for handling of MCell3 reaction behavior where reactants that stay the same on the 
   // products side are kept unchanged in a reaction
   small_vector<CplxIndexPair> pat_prod_cplx_mapping;
 
+  // set by set_reactant_pattern_table, indexed by reactant index
+  small_vector<pattern_id_t> reactant_pattern_ids;
+  ReactantPatternTable* reactant_pattern_table; // owned by RxnContainer
+
+  // species of reactants and products, set by finalize_explicit
+  std::vector<species_id_t> explicit_reactant_species_ids;
+  std::vector<species_id_t> explicit_product_species_ids;
+
   const BNGData* bng_data; // needed to create results of complex reactions
 };
 
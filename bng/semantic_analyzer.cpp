@@ -27,42 +27,6 @@ const char* const DIR_FORWARD = "forward";
 const char* const DIR_REVERSE = "reverse";
 
 
-// function names - name and number of arguments, list used by data model to pymcell4 converter
-// is in generator_utils.h: mdl_functions_to_py_bngl_map
-struct BnglFunctionInfo {
-  uint num_arguments;
-  double (*eval_1_arg_func_call)(double);
-  double (*eval_2_args_func_call)(double, double);
-};
-
-static double bngl_max(const double a, const double b) {
-  return (a<b)?b:a;
-}
-
-static double bngl_min(const double a, const double b) {
-  return !(b<a)?a:b;
-}
-
-// TODO: check allowed argument ranges e.g. for asin
-// TODO: only the intersection of MDL and BNGL functions is supported now, some BNGL functios are missing
-static const std::map<std::string, BnglFunctionInfo> bngl_function_infos {
-  { "sqrt", {1, sqrt, nullptr} },
-  { "exp", {1, exp, nullptr} },
-  { "ln", {1, log, nullptr} },
-  { "log10", {1, log10, nullptr} },
-  { "sin", {1, sin, nullptr} },
-  { "cos", {1, cos, nullptr} },
-  { "tan", {1, tan, nullptr} },
-  { "asin", {1, asin, nullptr} },
-  { "acos", {1, acos, nullptr} },
-  { "atan", {1, atan, nullptr} },
-  { "abs", {1, fabs, nullptr} },
-  { "ceil", {1, ceil, nullptr} },
-  { "floor", {1, floor, nullptr} },
-  { "max", {2, nullptr, bngl_max} },
-  { "min", {2, nullptr, bngl_min} }
-};
-
 static bool is_thrash_or_zero(const string& name) {
   // same check as in nfsim
   return name == COMPLEX_ZERO || name == COMPLEX_Trash || name == COMPLEX_TRASH || name == COMPLEX_trash;
@@ -72,25 +36,15 @@ static bool is_thrash_or_zero(const string& name) {
 double SemanticAnalyzer::evaluate_function_call(ASTExprNode* call_node, const std::vector<double>& arg_values) {
   assert(call_node != nullptr);
   const string& name = call_node->get_function_name();
-  const auto& func_info_it = bngl_function_infos.find(name);
-  if (func_info_it != bngl_function_infos.end()) {
-    if (arg_values.size() == func_info_it->second.num_arguments) {
-      const BnglFunctionInfo& info = func_info_it->second;
-      if (info.num_arguments == 1) {
-        return info.eval_1_arg_func_call(arg_values[0]);
-      }
-      else if (info.num_arguments == 2) {
-        return info.eval_2_args_func_call(arg_values[0], arg_values[1]);
-      }
-      else {
-        assert(false);
-        return 0;
-      }
+  const BnglFunctionInfo* info = find_bngl_function_info(name);
+  if (info != nullptr) {
+    if (arg_values.size() == info->num_arguments) {
+      return info->evaluate(arg_values.data());
     }
     else {
       errs_loc(call_node) <<
           "Invalid number of arguments for function '" << name << "', got " << arg_values.size() <<
-          " expected " << func_info_it->second.num_arguments << ".\n"; // test TODO
+          " expected " << info->num_arguments << ".\n"; // test TODO
       ctx->inc_error_count();
       return 0;
     }
@@ -104,52 +58,150 @@ double SemanticAnalyzer::evaluate_function_call(ASTExprNode* call_node, const st
 }
 
 
-// returns new node, owned by ctx if any new nodes were created
-// called recursively, the set used_ids is copied intentionally every call
-ASTExprNode* SemanticAnalyzer::evaluate_to_dbl(ASTExprNode* root, set<string> used_ids) {
-  if (root->is_dbl()) {
-    // already computed
-    return root;
+// returns false and reports an error if the id does not reference a parameter
+bool SemanticAnalyzer::find_parameter_index(const ASTExprNode* id_node, uint& index) {
+  assert(id_node->is_id());
+  const string& id = id_node->get_id();
+
+  auto it = parameter_indices.find(id);
+  if (it != parameter_indices.end()) {
+    index = it->second;
+    return true;
   }
-  else if (root->is_llong()) {
-    return ctx->new_dbl_node(root->get_llong(), root);
+
+  // find the value in the symbol table to report the right error
+  ASTBaseNode* val = ctx->symtab.get(id, const_cast<ASTExprNode*>(id_node), ctx);
+  if (val == nullptr) {
+    // error msg was printed by the symbol table
+    return false;
   }
-  else if (root->is_id()) {
-    const string& id = root->get_id();
-    if (used_ids.count(id) != 0) {
-      errs_loc(root) <<
-          "Cyclic dependence while evaluating an expression, id '" << id << "' was already used.\n"; // test N0012
-      ctx->inc_error_count();
-      return ctx->new_dbl_node(0, root);
+  assert(!val->is_expr() && "All parameters must have been compiled");
+  errs_loc(id_node) <<
+      "Referenced id '" << id << "' cannot be used in an expression.\n"; // test N0013
+  ctx->inc_error_count();
+  return false;
+}
+
+
+// collects indices of parameters used in an expression along with the id nodes
+// that reference them, invalid ids are reported once the expression is evaluated
+void SemanticAnalyzer::collect_parameter_dependencies(
+    const ASTExprNode* root, std::vector<std::pair<uint, const ASTExprNode*>>& deps) {
+
+  if (root->is_id()) {
+    auto it = parameter_indices.find(root->get_id());
+    if (it != parameter_indices.end()) {
+      deps.push_back(make_pair(it->second, root));
+    }
+  }
+  else if (root->is_unary_expr() || root->is_binary_expr()) {
+    collect_parameter_dependencies(root->get_left(), deps);
+    if (root->get_right() != nullptr) {
+      collect_parameter_dependencies(root->get_right(), deps);
     }
+  }
+  else if (root->is_function_call()) {
+    for (const ASTBaseNode* arg: root->get_args()->items) {
+      collect_parameter_dependencies(to_expr_node(arg), deps);
+    }
+  }
+}
+
 
-    // find the value in the symbol table
-    ASTBaseNode* val = ctx->symtab.get(root->get_id(), root, ctx);
-    if (val == nullptr) {
-      // error msg was printed by the symbol table
-      return ctx->new_dbl_node(0, root);
+// builds dependency graph of all parameters and orders them so that each parameter
+// is evaluated after all parameters that it uses, cycles are reported as errors
+void SemanticAnalyzer::compile_parameters(std::vector<uint>& evaluation_order) {
+  parameter_indices.clear();
+  parameter_names.clear();
+  parameter_exprs.clear();
+
+  // every symbol that maps directly into a value is a parameter,
+  // sorted so that the order of evaluation and of reported errors is stable
+  vector<const ASTSymbolTable::IdToNodeMap::value_type*> sorted_symbols;
+  ctx->symtab.get_sorted_symbols(sorted_symbols);
+  for (const auto* it_sym: sorted_symbols) {
+    if (it_sym->second->is_expr()) {
+      parameter_indices[it_sym->first] = parameter_exprs.size();
+      parameter_names.push_back(it_sym->first);
+      parameter_exprs.push_back(to_expr_node(it_sym->second));
     }
-    if (!val->is_expr()) {
-      errs_loc(root) <<
-          "Referenced id '" << id << "' cannot be used in an expression.\n";
-      ctx->inc_error_count();
-      return ctx->new_dbl_node(0, root);
+  }
+
+  vector<vector<pair<uint, const ASTExprNode*>>> deps(parameter_exprs.size());
+  for (uint i = 0; i < parameter_exprs.size(); i++) {
+    collect_parameter_dependencies(parameter_exprs[i], deps[i]);
+  }
+
+  // iterative depth-first search, deep parameter hierarchies would overflow the stack
+  enum class VisitState { NotVisited, InProgress, Done };
+  vector<VisitState> states(parameter_exprs.size(), VisitState::NotVisited);
+  evaluation_order.clear();
+  evaluation_order.reserve(parameter_exprs.size());
+
+  // parameter index and index of the next dependency to be visited
+  vector<pair<uint, uint>> stack;
+  for (uint start = 0; start < parameter_exprs.size(); start++) {
+    if (states[start] != VisitState::NotVisited) {
+      continue;
+    }
+    states[start] = VisitState::InProgress;
+    stack.push_back(make_pair(start, 0));
+
+    while (!stack.empty()) {
+      uint param = stack.back().first;
+      uint& next_dep = stack.back().second;
+
+      if (next_dep == deps[param].size()) {
+        states[param] = VisitState::Done;
+        evaluation_order.push_back(param);
+        stack.pop_back();
+        continue;
+      }
+
+      const pair<uint, const ASTExprNode*>& dep = deps[param][next_dep];
+      next_dep++;
+
+      if (states[dep.first] == VisitState::InProgress) {
+        errs_loc(dep.second) <<
+            "Cyclic dependence while evaluating an expression, id '" << dep.second->get_id() <<
+            "' was already used.\n"; // test N0012
+        ctx->inc_error_count();
+      }
+      else if (states[dep.first] == VisitState::NotVisited) {
+        states[dep.first] = VisitState::InProgress;
+        stack.push_back(make_pair(dep.first, 0));
+      }
     }
+  }
+}
+
 
-    used_ids.insert(id);
-    return evaluate_to_dbl(to_expr_node(val), used_ids);
+// uses values of parameters computed by convert_and_evaluate_parameters
+double SemanticAnalyzer::evaluate_compiled_expr(const ASTExprNode* root) {
+  if (root->is_dbl()) {
+    return root->get_dbl();
+  }
+  else if (root->is_llong()) {
+    return root->get_llong();
+  }
+  else if (root->is_id()) {
+    uint index;
+    if (!find_parameter_index(root, index)) {
+      return 0;
+    }
+    return parameter_values[index];
   }
   else if (root->is_unary_expr()) {
     assert(root->get_left() != nullptr);
     assert(root->get_right() == nullptr);
-    double res = evaluate_to_dbl(root->get_left(), used_ids)->get_dbl();
-    return ctx->new_dbl_node( (root->get_op() == ExprType::UnaryMinus) ? -res : res, root);
+    double res = evaluate_compiled_expr(root->get_left());
+    return (root->get_op() == ExprType::UnaryMinus) ? -res : res;
   }
   else if (root->is_binary_expr()) {
     assert(root->get_left() != nullptr);
     assert(root->get_right() != nullptr);
-    double res_left = evaluate_to_dbl(root->get_left(), used_ids)->get_dbl();
-    double res_right = evaluate_to_dbl(root->get_right(), used_ids)->get_dbl();
+    double res_left = evaluate_compiled_expr(root->get_left());
+    double res_right = evaluate_compiled_expr(root->get_right());
     double res = 0;
     switch (root->get_op()) {
       case ExprType::Add:
@@ -176,22 +228,97 @@ ASTExprNode* SemanticAnalyzer::evaluate_to_dbl(ASTExprNode* root, set<string> us
       default:
         release_assert(false && "Invalid operator");
     }
-    return ctx->new_dbl_node(res, root);
+    return res;
   }
   else if (root->is_function_call()) {
     assert(root->get_args() != nullptr);
     // evaluate all arguments
     vector<double> arg_values;
-    for (ASTBaseNode* base_arg_node: root->get_args()->items) {
-      ASTExprNode* arg_node = to_expr_node(base_arg_node);
-      arg_values.push_back(evaluate_to_dbl(arg_node, used_ids)->get_dbl());
+    for (const ASTBaseNode* base_arg_node: root->get_args()->items) {
+      arg_values.push_back(evaluate_compiled_expr(to_expr_node(base_arg_node)));
     }
-    double res = evaluate_function_call(root, arg_values);
-    return ctx->new_dbl_node(res, root);
+    return evaluate_function_call(const_cast<ASTExprNode*>(root), arg_values);
   }
 
   assert(false && "unreachable");
-  return nullptr;
+  return 0;
+}
+
+
+// converts expression to a form that can be evaluated again with different
+// parameter values, may be called only after convert_and_evaluate_parameters
+void SemanticAnalyzer::compile_expr(const ASTExprNode* root, CompiledExpr& res) {
+  if (root->is_dbl()) {
+    res.append_const(root->get_dbl());
+  }
+  else if (root->is_llong()) {
+    res.append_const(root->get_llong());
+  }
+  else if (root->is_id()) {
+    auto it = parameter_indices.find(root->get_id());
+    if (it != parameter_indices.end()) {
+      res.append_param(compiled_parameter_indices[it->second]);
+    }
+    else {
+      // error was reported during evaluation
+      res.append_const(0);
+    }
+  }
+  else if (root->is_unary_expr()) {
+    compile_expr(root->get_left(), res);
+    if (root->get_op() == ExprType::UnaryMinus) {
+      res.append(CompiledExprInstr(CompiledExprOp::UnaryMinus));
+    }
+  }
+  else if (root->is_binary_expr()) {
+    compile_expr(root->get_left(), res);
+    compile_expr(root->get_right(), res);
+    switch (root->get_op()) {
+      case ExprType::Add:
+        res.append(CompiledExprInstr(CompiledExprOp::Add));
+        break;
+      case ExprType::Sub:
+        res.append(CompiledExprInstr(CompiledExprOp::Sub));
+        break;
+      case ExprType::Mul:
+        res.append(CompiledExprInstr(CompiledExprOp::Mul));
+        break;
+      case ExprType::Div:
+        res.append(CompiledExprInstr(CompiledExprOp::Div));
+        break;
+      case ExprType::Pow:
+        res.append(CompiledExprInstr(CompiledExprOp::Pow));
+        break;
+      default:
+        release_assert(false && "Invalid operator");
+    }
+  }
+  else if (root->is_function_call()) {
+    for (const ASTBaseNode* arg: root->get_args()->items) {
+      compile_expr(to_expr_node(arg), res);
+    }
+    // function and number of arguments were checked during evaluation
+    const BnglFunctionInfo* info = find_bngl_function_info(root->get_function_name());
+    release_assert(info != nullptr);
+    release_assert(root->get_args()->items.size() == info->num_arguments);
+    CompiledExprInstr instr(CompiledExprOp::FunctionCall);
+    instr.func = info;
+    res.append(instr);
+  }
+  else {
+    assert(false && "unreachable");
+  }
+}
+
+
+// returns new node owned by ctx or root if it is already a floating point value,
+// may be called only after convert_and_evaluate_parameters
+ASTExprNode* SemanticAnalyzer::evaluate_to_dbl(ASTExprNode* root) {
+  if (root->is_dbl()) {
+    // already computed
+    return root;
+  }
+  return ctx->new_dbl_node(evaluate_compiled_expr(root), root);
 }
 
 
@@ -224,6 +351,8 @@ void SemanticAnalyzer::resolve_rxn_rates() {
     for (size_t i = 0; i < rule->rates->items.size(); i++) {
       ASTExprNode* orig_expr = to_expr_node(rule->rates->items[i]);
       ASTExprNode* new_expr = evaluate_to_dbl(orig_expr);
+      // keep the definition so that the rate can be updated when parameters change
+      compile_expr(orig_expr, compiled_rate_exprs[new_expr]);
       // all nodes are owned by context and deleted after parsing has finished
       rule->rates->items[i] = new_expr;
     }
@@ -236,26 +365,24 @@ void SemanticAnalyzer::resolve_rxn_rates() {
 void SemanticAnalyzer::convert_and_evaluate_parameters(
     const std::map<std::string, double>& parameter_overrides) {
 
-  // first go trough all parameter overrides and either change definition or add
-  // this parameter to the symbol table
+  // first go trough all parameter overrides and check that they override a parameter,
+  // parameters that are not defined are added to the symbol table,
+  // definitions of the overridden parameters are kept so that they can be used
+  // when the parameters are updated without these overrides
   ASTSymbolTable::IdToNodeMap& symtab_map = ctx->symtab.get_as_map();
   for (auto it_override: parameter_overrides) {
     // is defined?
     auto it_found_sym = symtab_map.find(it_override.first);
     if (it_found_sym != symtab_map.end()) {
       // and it is a symbol
-      if (it_found_sym->second->is_expr()) {
-        // override its value
-        it_found_sym->second = ctx->new_dbl_node(it_override.second);
-      }
-      else {
+      if (!it_found_sym->second->is_expr()) {
         errs() <<
             "Cannot override symbol " << it_override.first << " that is not a parameter.\n";
         ctx->inc_error_count();
       }
     }
     else {
-      // define as a new symbol
+      // define as a new symbol, the override is its only definition
       ctx->symtab.insert(
           it_override.first,
           ctx->new_dbl_node(it_override.second),
@@ -264,15 +391,38 @@ void SemanticAnalyzer::convert_and_evaluate_parameters(
     }
   }
 
-  // every symbol that maps directly into a value is a parameter
-  // evaluate them and store
-  for (auto it_sym: ctx->symtab.get_as_map()) {
-    if (it_sym.second->is_expr()) {
-      ASTExprNode* orig_expr = to_expr_node(it_sym.second);
-      ASTExprNode* new_expr = evaluate_to_dbl(orig_expr);
+  // every symbol that maps directly into a value is a parameter,
+  // dependencies between them are analyzed once and then each of them is evaluated once
+  vector<uint> evaluation_order;
+  compile_parameters(evaluation_order);
+
+  // parameters that are a part of a cycle are evaluated with values 0
+  // of their dependencies that were not computed yet, an error was reported
+  parameter_values.assign(parameter_exprs.size(), 0);
+  for (uint index: evaluation_order) {
+    // the definition of an overridden parameter is also evaluated to report its errors
+    double value = evaluate_compiled_expr(parameter_exprs[index]);
+    auto it_override = parameter_overrides.find(parameter_names[index]);
+    parameter_values[index] = (it_override != parameter_overrides.end()) ? it_override->second : value;
+  }
+
+  // store them
+  for (const auto& it_index: parameter_indices) {
+    bng_data->add_parameter(it_index.first, parameter_values[it_index.second]);
+  }
 
-      bng_data->add_parameter(it_sym.first, new_expr->get_dbl());
+  // and also their definitions, in the evaluation order
+  if (ctx->get_error_count() == 0) {
+    CompiledParameters& compiled_parameters = bng_data->get_compiled_parameters();
+    compiled_parameter_indices.assign(parameter_exprs.size(), INDEX_INVALID);
+    for (uint index: evaluation_order) {
+      CompiledExpr expr;
+      compile_expr(parameter_exprs[index], expr);
+      compiled_parameter_indices[index] =
+          compiled_parameters.add_parameter(parameter_names[index], expr, parameter_values[index]);
     }
+    // the next update re-evaluates parameters whose override is not used anymore
+    compiled_parameters.set_applied_overrides(parameter_overrides);
   }
 }
 
@@ -362,12 +512,14 @@ ElemMolType SemanticAnalyzer::convert_molecule_type(
 
 void SemanticAnalyzer::convert_and_store_molecule_types() {
 
-  // for each molecule (type) from the symbol table
-  const ASTSymbolTable::IdToNodeMap& table = ctx->symtab.get_as_map();
-  for (const auto& it: table) {
-    assert(it.second != nullptr);
-    if (it.second->is_mol()) {
-      const ASTMolNode* n = to_molecule_node(it.second);
+  // for each molecule (type) from the symbol table,
+  // molecule type ids are assigned in the order of their names
+  vector<const ASTSymbolTable::IdToNodeMap::value_type*> sorted_symbols;
+  ctx->symtab.get_sorted_symbols(sorted_symbols);
+  for (const auto* it: sorted_symbols) {
+    assert(it->second != nullptr);
+    if (it->second->is_mol()) {
+      const ASTMolNode* n = to_molecule_node(it->second);
 
       if (n->has_compartment()) {
         errs_loc(n) <<
@@ -501,46 +653,46 @@ void SemanticAnalyzer::convert_and_store_compartments() {
 
 void SemanticAnalyzer::collect_molecule_types_molecule_list(
     const ASTListNode* cplx_list,
-    vector<const ASTMolNode*>& molecule_nodes
+    map<string, vector<const ASTMolNode*>>& mol_uses_with_same_name
 ) {
   for (size_t i = 0; i < cplx_list->items.size(); i++) {
-    const ASTCplxNode* cplx = to_cplx_node(cplx_list->items[i]);
+    collect_molecule_types_cplx(to_cplx_node(cplx_list->items[i]), mol_uses_with_same_name);
+  }
+}
 
-    molecule_nodes.insert(molecule_nodes.end(), cplx->mols.begin(), cplx->mols.end());
+
+void SemanticAnalyzer::collect_molecule_types_cplx(
+    const ASTCplxNode* cplx,
+    map<string, vector<const ASTMolNode*>>& mol_uses_with_same_name
+) {
+  for (const ASTMolNode* n: cplx->mols) {
+    // skip those that are already known
+    if (bng_data->find_elem_mol_type_id(n->name) == ELEM_MOL_TYPE_ID_INVALID) {
+      mol_uses_with_same_name[n->name].push_back(n);
+    }
   }
 }
 
 
 void SemanticAnalyzer::collect_and_store_implicit_molecule_types() {
-  // go through reaction rules and seed species to define molecule types
+  // go through reaction rules and seed species to define molecule types,
+  // molecule nodes are sorted by name in a single pass
+  map<string, vector<const ASTMolNode*>> mol_uses_with_same_name;
 
-  // first collect all molecule nodes
   // for each rxn rule
-  vector<const ASTMolNode*> found_mol_nodes;
   for (const ASTBaseNode* n: ctx->rxn_rules.items) {
     const ASTRxnRuleNode* r = to_rxn_rule_node(n);
-    collect_molecule_types_molecule_list(r->reactants, found_mol_nodes);
-    collect_molecule_types_molecule_list(r->products, found_mol_nodes);
+    collect_molecule_types_molecule_list(r->reactants, mol_uses_with_same_name);
+    collect_molecule_types_molecule_list(r->products, mol_uses_with_same_name);
   }
 
   for (const ASTBaseNode* n: ctx->seed_species.items) {
-    const ASTSeedSpeciesNode* ss = to_seed_species_node(n);
-    found_mol_nodes.insert(found_mol_nodes.end(),
-        ss->cplx->mols.begin(), ss->cplx->mols.end());
-  }
-
-  // sort by name and skip those that are already known
-  map<string, vector<const ASTMolNode*>> mol_uses_with_same_name;
-  for (const ASTMolNode* n: found_mol_nodes) {
-    elem_mol_type_id_t mt_id = bng_data->find_elem_mol_type_id(n->name);
-    if (mt_id == ELEM_MOL_TYPE_ID_INVALID) {
-      mol_uses_with_same_name[n->name].push_back(n);
-    }
+    collect_molecule_types_cplx(to_seed_species_node(n)->cplx, mol_uses_with_same_name);
   }
 
   // and merge into a single definition
   // for each different name
-  for (auto same_name_it: mol_uses_with_same_name) {
+  for (const auto& same_name_it: mol_uses_with_same_name) {
 
     // create a map of used states per each component
     map<string, set<string>> component_state_names;
@@ -945,7 +1097,12 @@ void SemanticAnalyzer::finalize_and_store_rxn_rule(
     return;
   }
 
-  bng_data->find_or_add_rxn_rule(r);
+  rxn_rule_id_t id = bng_data->find_or_add_rxn_rule(r);
+
+  auto it_rate = compiled_rate_exprs.find(n->rates->items[forward_direction ? 0 : 1]);
+  if (it_rate != compiled_rate_exprs.end()) {
+    bng_data->get_compiled_parameters().set_rxn_rule_rate_expr(id, it_rate->second);
+  }
 }
 
 
@@ -1216,8 +1373,8 @@ void SemanticAnalyzer::define_compartments_used_by_cplx_as_3d_compartments(
 
   for (const string& n: compartment_names) {
     compartment_id_t in_out_id = get_in_or_out_compartment_id(n);
-    if (in_out_id == COMPARTMENT_ID_INVALID) {
-      // is a standard compartment, add it
+    if (in_out_id == COMPARTMENT_ID_INVALID && bng_data->find_compartment_id(n) == COMPARTMENT_ID_INVALID) {
+      // is a standard compartment that was not used yet, add it
       Compartment c;
       c.name = n;
       c.is_3d = true;
@@ -13,6 +13,8 @@
 #include <set>
 #include <string>
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "bng/ast.h"
 #include "bng/bng_engine.h"
@@ -33,7 +35,13 @@ public:
 
 private:
   double evaluate_function_call(ASTExprNode* call_node, const std::vector<double>& arg_values);
-  ASTExprNode* evaluate_to_dbl(ASTExprNode* root, std::set<std::string> used_ids={});
+  bool find_parameter_index(const ASTExprNode* id_node, uint& index);
+  void collect_parameter_dependencies(
+      const ASTExprNode* root, std::vector<std::pair<uint, const ASTExprNode*>>& deps);
+  void compile_parameters(std::vector<uint>& evaluation_order);
+  double evaluate_compiled_expr(const ASTExprNode* root);
+  void compile_expr(const ASTExprNode* root, CompiledExpr& res);
+  ASTExprNode* evaluate_to_dbl(ASTExprNode* root);
   void resolve_rxn_rates();
 
   void convert_and_evaluate_parameters(const std::map<std::string, double>& parameter_overrides);
@@ -54,8 +62,12 @@ private:
 
   void merge_molecule_type_definition(ElemMolType& dstsrc, const ElemMolType& src);
   void collect_molecule_types_molecule_list(
-      const ASTListNode* molecule_list,
-      std::vector<const ASTMolNode*>& molecule_nodes
+      const ASTListNode* cplx_list,
+      std::map<std::string, std::vector<const ASTMolNode*>>& mol_uses_with_same_name
+  );
+  void collect_molecule_types_cplx(
+      const ASTCplxNode* cplx,
+      std::map<std::string, std::vector<const ASTMolNode*>>& mol_uses_with_same_name
   );
   void collect_and_store_implicit_molecule_types();
 
@@ -87,6 +99,18 @@ private:
   // as arguments
   ParserContext* ctx;
   BNGData* bng_data;
+
+  // parameters are evaluated only once, in the order given by their dependencies,
+  // expressions that use them read the values from parameter_values
+  std::unordered_map<std::string, uint> parameter_indices;
+  std::vector<std::string> parameter_names;
+  std::vector<const ASTExprNode*> parameter_exprs;
+  std::vector<double> parameter_values;
+
+  // parameter indices used by bng_data's CompiledParameters
+  std::vector<uint> compiled_parameter_indices;
+  // compiled rate expressions, key is the evaluated rate node
+  std::map<const ASTBaseNode*, CompiledExpr> compiled_rate_exprs;
 };
 
 
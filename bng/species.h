@@ -39,7 +39,9 @@ public:
       reactant_class_id(REACTANT_CLASS_ID_INVALID) {
   }
 
-  void finalize_species(const BNGConfig& config, const bool update_diffusion_constant = true) {
+  // when assume_canonical is true, the complex is not canonicalized, see Cplx::assume_canonical
+  void finalize_species(
+      const BNGConfig& config, const bool update_diffusion_constant = true, const bool assume_canonical = false) {
     // species must not use IN/OUT, remove it automatically when defining species
     for (auto& em: elem_mols) {
       if (is_in_out_compartment_id(em.compartment_id)) {
@@ -47,7 +49,12 @@ public:
       }
     }
 
-    canonicalize(); // sets name as well
+    if (assume_canonical) {
+      Cplx::assume_canonical(); // sets name as well
+    }
+    else {
+      canonicalize(); // sets name as well
+    }
     set_flag(SPECIES_FLAG_CAN_DIFFUSE, D != 0);
     if (is_reactive_surface()) {
       // surfaces are always assumed to be instantiated
@@ -63,14 +70,14 @@ public:
   // id is not set and name is determined automatically
   Species(
       const Cplx& cplx_inst, const BNGData& data, const BNGConfig& config,
-      const bool update_diffusion_constant = true)
+      const bool update_diffusion_constant = true, const bool assume_canonical = false)
     : Cplx(&data),
       id(SPECIES_ID_INVALID),
       space_step(FLT_INVALID), time_step(TIME_INVALID),
       rxn_flags_were_updated(false), num_instantiations(0), reactant_class_id(REACTANT_CLASS_ID_INVALID) {
 
     elem_mols = cplx_inst.elem_mols;
-    finalize_species(config, update_diffusion_constant);
+    finalize_species(config, update_diffusion_constant, assume_canonical);
   }
 
   // we need explicit copy ctor to call CplxInstance's copy ctor
@@ -11,52 +11,52 @@
 #include <cstdlib>
 
 #include "bngl_parser.hpp"
+#include "bngl_scanner.hpp"
 #include "bng/species.h"
 #include "bng/semantic_analyzer.h"
 #include "bng/bng_engine.h"
 
 using namespace std;
 
-extern FILE *bnglin;
-
 // returns 0 if everything was ok
 int parse_bngl(char const *name, const bool dump_ast, const bool dump_bng_data) {
 
-  BNG::create_parser_context();
-  BNG::ParserContext* ctx = BNG::get_parser_context();
-
   FILE *infile = fopen(name, "r");
   if (infile == nullptr) {
     cerr << "Could not open input file.\n";
     return 1;
   }
 
-  ctx->set_current_file_name(name);
-  bnglin = infile;
-  int res = bnglparse();
+  BNG::ParserContext ctx;
+  ctx.set_current_file_name(name);
+
+  yyscan_t scanner;
+  bngllex_init_extra(&ctx, &scanner);
+  bnglset_in(infile, scanner);
+  int res = bnglparse(scanner, &ctx);
   if (res != 0) {
     cerr << "\nParse error code is " << res << ".\n";
   }
+  bngllex_destroy(scanner);
+  fclose(infile);
 
   if (dump_ast) {
-    ctx->dump();
+    ctx.dump();
   }
 
   BNG::SemanticAnalyzer sema;
 
   BNG::BNGConfig bng_config; // we do not care about the config values here
   BNG::BNGEngine bng_engine(bng_config);
-  sema.check_and_convert_parsed_file(ctx, &bng_engine.get_data());
+  sema.check_and_convert_parsed_file(&ctx, &bng_engine.get_data());
 
   if (dump_bng_data) {
     bng_engine.get_data().dump();
   }
 
-  ctx->print_error_report();
-
-  int errors = ctx->get_error_count();
+  ctx.print_error_report();
 
-  BNG::delete_parser_context();
+  int errors = ctx.get_error_count();
 
   return errors != 0;
 }
@@ -0,0 +1,85 @@
+#include <string>
+#include <set>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  RxnContainer& all_rxns = bng_engine.get_all_rxns();
+
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+  release_assert(all_rxn_classes.size() == 3);
+  release_assert(all_rxns.get_num_rxn_classes() == 3);
+  release_assert(all_rxns.get_num_rxn_class_cache_misses() != 0);
+
+  // no limit is set, nothing is evicted
+  uint num_evicted = all_rxns.evict_cold_rxn_classes();
+  release_assert(num_evicted == 0);
+
+  // keep only one rxn class
+  bng_config.max_num_rxn_classes = 1;
+  num_evicted = all_rxns.evict_cold_rxn_classes();
+  release_assert(num_evicted == 2);
+  release_assert(all_rxns.get_num_rxn_classes() == 1);
+  release_assert(all_rxns.get_num_rxn_class_evictions() == 2);
+
+  // evicted rxn classes are recreated on-demand and give the same network
+  bng_config.max_num_rxn_classes = 0;
+  set<RxnClass*> all_rxn_classes_recreated;
+  generate_network(bng_engine, all_rxn_classes_recreated);
+
+  dump_network(all_rxn_classes_recreated);
+
+  release_assert(all_rxn_classes_recreated.size() == 3);
+  release_assert(get_num_rxns_in_network(all_rxn_classes_recreated) == 4);
+  release_assert(all_rxns.get_num_rxn_classes() == 3);
+
+  // rxn classes reached through get_bimol_rxns_for_reactant are marked as used
+  // when they are used to evaluate a collision and are not evicted
+  bng_config.max_num_rxn_classes = 2;
+  num_evicted = all_rxns.evict_cold_rxn_classes();
+  release_assert(num_evicted == 1);
+
+  Species x(bng_data);
+  release_assert(parse_single_cplx_string("X(y,p~0)", bng_data, x) == 0);
+  x.finalize_species(bng_config);
+  species_id_t x_id = bng_engine.get_all_species().find_or_add(x);
+
+  SpeciesRxnClassesMap* x_bimol_rxn_classes = all_rxns.get_bimol_rxns_for_reactant(x_id, true);
+  release_assert(x_bimol_rxn_classes != nullptr && x_bimol_rxn_classes->size() == 1);
+  RxnClass* x_y_rxn_class = x_bimol_rxn_classes->begin()->second;
+  rxn_class_id_t x_y_rxn_class_id = x_y_rxn_class->id;
+
+  uint64_t num_hits = all_rxns.get_num_rxn_class_cache_hits();
+  uint64_t num_uses = x_y_rxn_class->get_num_uses();
+  x_y_rxn_class->get_max_fixed_p();
+  release_assert(x_y_rxn_class->get_num_uses() == num_uses + 1);
+  release_assert(all_rxns.get_num_rxn_class_cache_hits() == num_hits + 1);
+
+  bng_config.max_num_rxn_classes = 1;
+  all_rxns.evict_cold_rxn_classes();
+  release_assert(all_rxns.get_num_rxn_classes() == 1);
+  release_assert(all_rxns.get_rxn_class(x_y_rxn_class_id) == x_y_rxn_class);
+
+  // hits of evicted rxn classes are kept
+  release_assert(all_rxns.get_num_rxn_class_cache_hits() >= num_hits + 1);
+}
@@ -0,0 +1,71 @@
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+// loads the model, runs warm-up for seed species and returns names of all species
+static void warm_up_seed_species(const uint num_threads, vector<string>& species_names, uint& num_rxn_classes) {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  bng_engine.initialize();
+
+  vector<species_id_t> seed_species_ids;
+  for (const SeedSpecies& seed: bng_data.get_seed_species()) {
+    Species s(seed.cplx, bng_data, bng_config);
+    seed_species_ids.push_back(bng_engine.get_all_species().find_or_add(s));
+  }
+
+  RxnContainer& all_rxns = bng_engine.get_all_rxns();
+  all_rxns.warm_up(seed_species_ids, num_threads);
+
+  // all rxn classes among seed species must exist now
+  release_assert(all_rxns.get_unimol_rxn_class(seed_species_ids[1]) != nullptr);
+  release_assert(all_rxns.get_bimol_rxn_class(seed_species_ids[0], seed_species_ids[1]) != nullptr);
+  release_assert(all_rxns.get_bimol_rxn_class(seed_species_ids[0], seed_species_ids[2]) != nullptr);
+
+  num_rxn_classes = all_rxns.get_num_rxn_classes();
+  for (const Species* s: bng_engine.get_all_species().get_species_vector()) {
+    species_names.push_back(s->name);
+  }
+}
+
+
+int main() {
+
+  vector<string> species_names_sequential;
+  uint num_rxn_classes_sequential;
+  warm_up_seed_species(1, species_names_sequential, num_rxn_classes_sequential);
+
+  vector<string> species_names_parallel;
+  uint num_rxn_classes_parallel;
+  warm_up_seed_species(4, species_names_parallel, num_rxn_classes_parallel);
+
+  for (const string& name: species_names_parallel) {
+    cout << name << "\n";
+  }
+
+  // results must not depend on the number of threads
+  release_assert(num_rxn_classes_sequential == num_rxn_classes_parallel);
+  release_assert(species_names_sequential == species_names_parallel);
+
+  // R(l,p~0) -> R(l,p~1), L(r,r) + R(l,p~0), and L(r,r) + R(l,p~1)
+  release_assert(num_rxn_classes_parallel == 3);
+
+  // seed species and the two products L(r!1,r).R(l!1,p~0) and L(r!1,r).R(l!1,p~1)
+  release_assert(species_names_parallel.size() == 5);
+  release_assert(species_names_parallel[3] == "L(r!1,r).R(l!1,p~0)");
+  release_assert(species_names_parallel[4] == "L(r!1,r).R(l!1,p~1)");
+}
@@ -0,0 +1,64 @@
+#include <string>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNG::BNGConfig bng_config;
+  // unimol rxn probabilities are computed as rate * time_unit
+  bng_config.time_unit = 1e-6;
+  BNG::BNGEngine bng_engine(bng_config);
+  BNG::BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = BNG::parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  BNG::Species A(bng_engine.get_data());
+  num_errors = BNG::parse_single_cplx_string("A", bng_data, A);
+  release_assert(num_errors == 0);
+
+  A.finalize_species(bng_config, false);
+  BNG::species_id_t A_id = bng_engine.get_all_species().find_or_add(A);
+
+  BNG::RxnClass* rxn_class = bng_engine.get_all_rxns().get_unimol_rxn_class(A_id);
+  release_assert(rxn_class != nullptr);
+  rxn_class->init_rxn_pathways_and_rates();
+  release_assert(rxn_class->get_num_pathways() == 4);
+
+  // sample uniformly spaced numbers with both selection methods,
+  // each pathway must be selected proportionally to its probability
+  const uint num_samples = 100000;
+  vector<uint> alias_counts(rxn_class->get_num_pathways(), 0);
+  vector<uint> binary_search_counts(rxn_class->get_num_pathways(), 0);
+  double max_fixed_p = rxn_class->get_max_fixed_p();
+  for (uint i = 0; i < num_samples; i++) {
+    double u = (i + 0.5) / num_samples;
+
+    BNG::rxn_class_pathway_index_t alias_index = rxn_class->get_pathway_index_for_uniform_random(u);
+    release_assert(alias_index >= 0 && alias_index < (int)rxn_class->get_num_pathways());
+    alias_counts[alias_index]++;
+
+    BNG::rxn_class_pathway_index_t bs_index = rxn_class->get_pathway_index_for_probability(u * max_fixed_p, 1.0);
+    binary_search_counts[bs_index]++;
+  }
+
+  for (uint i = 0; i < rxn_class->get_num_pathways(); i++) {
+    double expected = rxn_class->pathways[i].pathway_prob / max_fixed_p;
+    cout << "pathway " << i << ": expected " << expected <<
+        ", alias table " << (double)alias_counts[i] / num_samples <<
+        ", binary search " << (double)binary_search_counts[i] / num_samples << "\n";
+
+    release_assert(fabs((double)alias_counts[i] / num_samples - expected) < 1e-3);
+    release_assert(fabs((double)binary_search_counts[i] / num_samples - expected) < 1e-3);
+  }
+}
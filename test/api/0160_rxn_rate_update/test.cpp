@@ -0,0 +1,64 @@
+#include <string>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNG::BNGConfig bng_config;
+  // unimol rxn probabilities are computed as rate * time_unit
+  bng_config.time_unit = 1e-6;
+  bng_config.notifications.rxn_probability_changed = false;
+
+  BNG::BNGEngine bng_engine(bng_config);
+  BNG::BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = BNG::parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  BNG::Species A(bng_engine.get_data());
+  num_errors = BNG::parse_single_cplx_string("A(a~0,b~0)", bng_data, A);
+  release_assert(num_errors == 0);
+
+  A.finalize_species(bng_config, false);
+  BNG::species_id_t A_id = bng_engine.get_all_species().find_or_add(A);
+
+  BNG::RxnClass* rxn_class = bng_engine.get_all_rxns().get_unimol_rxn_class(A_id);
+  release_assert(rxn_class != nullptr);
+  rxn_class->init_rxn_pathways_and_rates();
+  release_assert(rxn_class->get_num_pathways() == 2);
+
+  vector<BNG::species_id_t> products_before;
+  for (uint i = 0; i < rxn_class->get_num_pathways(); i++) {
+    products_before.push_back(rxn_class->get_rxn_products_for_pathway(i)[0].product_species_id);
+  }
+  uint num_species_before = bng_engine.get_all_species().get_species_vector().size();
+  double prob_before = rxn_class->pathways[0].pathway_prob;
+  double max_fixed_p_before = rxn_class->get_max_fixed_p();
+
+  // change the rate of the first rxn, only probabilities must be updated
+  BNG::RxnRule* rxn = bng_engine.get_all_rxns().get(rxn_class->pathways[0].rxn_rule_id);
+  bool updated = rxn->update_rxn_rate(rxn->get_rate_constant() * 4);
+  release_assert(updated);
+
+  release_assert(rxn_class->get_num_pathways() == 2);
+  release_assert(fabs(rxn_class->pathways[0].pathway_prob - 4 * prob_before) < 1e-12);
+  release_assert(fabs(rxn_class->get_max_fixed_p() - (max_fixed_p_before + 3 * prob_before)) < 1e-12);
+  release_assert(fabs(rxn_class->pathways[1].cum_prob - rxn_class->get_max_fixed_p()) < 1e-12);
+
+  for (uint i = 0; i < rxn_class->get_num_pathways(); i++) {
+    release_assert(rxn_class->get_rxn_products_for_pathway(i)[0].product_species_id == products_before[i]);
+  }
+  release_assert(bng_engine.get_all_species().get_species_vector().size() == num_species_before);
+
+  cout << rxn_class->to_str() << "\n";
+}
@@ -0,0 +1,68 @@
+#include <string>
+#include <vector>
+#include <cmath>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNG::BNGConfig bng_config;
+  // unimol rxn probabilities are computed as rate * time_unit
+  bng_config.time_unit = 1;
+  bng_config.notifications.rxn_probability_changed = false;
+
+  BNG::BNGEngine bng_engine(bng_config);
+  BNG::BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = BNG::parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  BNG::RxnContainer& all_rxns = bng_engine.get_all_rxns();
+
+  // rate of the first rxn changes at times 1, 2, ..., 1000 to the value of the time,
+  // the table is given unsorted
+  vector<BNG::RxnRateInfo> rates;
+  for (int i = 1000; i >= 1; i--) {
+    rates.push_back(BNG::RxnRateInfo{(double)i, (double)i});
+  }
+  all_rxns.get(0)->set_variable_rates(rates);
+  all_rxns.init_rxn_rate_schedule();
+  release_assert(all_rxns.get_next_rxn_rate_change_time() == 1);
+
+  BNG::Species A(bng_engine.get_data());
+  num_errors = BNG::parse_single_cplx_string("A", bng_data, A);
+  release_assert(num_errors == 0);
+
+  A.finalize_species(bng_config, false);
+  BNG::species_id_t A_id = bng_engine.get_all_species().find_or_add(A);
+
+  BNG::RxnClass* rxn_class = all_rxns.get_unimol_rxn_class(A_id);
+  release_assert(rxn_class != nullptr);
+  rxn_class->init_rxn_pathways_and_rates();
+  release_assert(rxn_class->get_max_fixed_p() == 2);
+
+  // nothing is scheduled before time 1
+  release_assert(all_rxns.advance_to(0.5) == 0);
+
+  // jump over multiple scheduled changes, only the last one is used
+  release_assert(all_rxns.advance_to(10.5) == 1);
+  release_assert(rxn_class->get_max_fixed_p() == 10 + 1);
+  release_assert(all_rxns.get_next_rxn_rate_change_time() == 11);
+
+  release_assert(all_rxns.advance_to(11) == 1);
+  release_assert(rxn_class->get_max_fixed_p() == 11 + 1);
+
+  release_assert(all_rxns.advance_to(5000) == 1);
+  release_assert(rxn_class->get_max_fixed_p() == 1000 + 1);
+  release_assert(all_rxns.get_next_rxn_rate_change_time() == TIME_FOREVER);
+
+  cout << rxn_class->to_str() << "\n";
+}
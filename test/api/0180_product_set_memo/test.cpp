@@ -0,0 +1,98 @@
+#include <string>
+#include <set>
+#include <map>
+#include <vector>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+typedef pair<species_id_t, species_id_t> ReactantsPair;
+
+// rxn rule id and product species ids for each pathway
+typedef vector<pair<rxn_rule_id_t, vector<species_id_t>>> PathwaysInfo;
+
+static void collect_pathways(const set<RxnClass*>& all_rxn_classes, map<ReactantsPair, PathwaysInfo>& res) {
+  res.clear();
+  for (RxnClass* rxn_class: all_rxn_classes) {
+    rxn_class->init_rxn_pathways_and_rates();
+
+    ReactantsPair key(
+        rxn_class->reactant_ids[0],
+        rxn_class->is_bimol() ? rxn_class->reactant_ids[1] : SPECIES_ID_INVALID);
+
+    PathwaysInfo& info = res[key];
+    for (uint i = 0; i < rxn_class->get_num_pathways(); i++) {
+      vector<species_id_t> products;
+      for (const ProductSpeciesIdWIndices& p: rxn_class->get_rxn_products_for_pathway(i)) {
+        products.push_back(p.product_species_id);
+      }
+      info.push_back(make_pair(rxn_class->pathways[i].rxn_rule_id, products));
+    }
+  }
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  RxnContainer& all_rxns = bng_engine.get_all_rxns();
+  ProductSetMemo& memo = all_rxns.get_product_set_memo();
+
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+  map<ReactantsPair, PathwaysInfo> pathways_orig;
+  collect_pathways(all_rxn_classes, pathways_orig);
+
+  uint num_species = bng_engine.get_all_species().get_species_vector().size();
+  uint num_memo_entries = memo.size();
+  release_assert(num_memo_entries == 4);
+  release_assert(memo.get_num_hits() == 0);
+
+  // rxn classes are removed, the memo is kept
+  all_rxns.reset_caches();
+  release_assert(memo.size() == num_memo_entries);
+
+  set<RxnClass*> all_rxn_classes_recreated;
+  generate_network(bng_engine, all_rxn_classes_recreated);
+  map<ReactantsPair, PathwaysInfo> pathways_recreated;
+  collect_pathways(all_rxn_classes_recreated, pathways_recreated);
+
+  // all products were taken from the memo
+  release_assert(memo.get_num_hits() == num_memo_entries);
+  release_assert(memo.size() == num_memo_entries);
+  release_assert(pathways_recreated == pathways_orig);
+  release_assert(bng_engine.get_all_species().get_species_vector().size() == num_species);
+
+  // bounded memo keeps only the latest entries
+  bng_config.max_num_product_set_memo_entries = 2;
+  memo.clear();
+  all_rxns.reset_caches();
+
+  set<RxnClass*> all_rxn_classes_bounded;
+  generate_network(bng_engine, all_rxn_classes_bounded);
+  map<ReactantsPair, PathwaysInfo> pathways_bounded;
+  collect_pathways(all_rxn_classes_bounded, pathways_bounded);
+
+  release_assert(memo.size() == 2);
+  // evicted entries are not kept in the per-reactant index
+  release_assert(memo.get_num_reactant_references() <= 2 * memo.size());
+  release_assert(pathways_bounded == pathways_orig);
+
+  dump_network(all_rxn_classes_bounded);
+}
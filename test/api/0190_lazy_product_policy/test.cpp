@@ -0,0 +1,138 @@
+#include <string>
+#include <vector>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+// chain of A molecules, rule A(b~0) -> A(b~1) can be applied onto each of them
+static string get_chain(const uint length) {
+  string res;
+  for (uint i = 0; i < length; i++) {
+    if (i != 0) {
+      res += ".";
+    }
+    res += "A(b~0,l" + (i == 0 ? string("") : "!" + to_string(i)) +
+        ",r" + (i == length - 1 ? string("") : "!" + to_string(i + 1)) + ")";
+  }
+  return res;
+}
+
+
+static void init_engine(BNGEngine& bng_engine) {
+  int num_errors = parse_bngl_file(get_test_bngl_file_name(__FILE__), bng_engine.get_data());
+  release_assert(num_errors == 0);
+  bng_engine.initialize();
+}
+
+
+static RxnClass* get_rxn_class(BNGEngine& bng_engine, const string& reactant) {
+  Species s(bng_engine.get_data());
+  int num_errors = parse_single_cplx_string(reactant, bng_engine.get_data(), s);
+  release_assert(num_errors == 0);
+
+  s.finalize_species(bng_engine.get_config(), false);
+  species_id_t id = bng_engine.get_all_species().find_or_add(s);
+
+  RxnClass* rxn_class = bng_engine.get_all_rxns().get_unimol_rxn_class(id);
+  release_assert(rxn_class != nullptr);
+  rxn_class->init_rxn_pathways_and_rates();
+  return rxn_class;
+}
+
+
+// returns ids of product species in the order of queries
+static vector<species_id_t> query_products(RxnClass* rxn_class, const vector<uint>& pathway_indices) {
+  vector<species_id_t> res;
+  for (uint i: pathway_indices) {
+    const RxnProductsVector& products = rxn_class->get_rxn_products_for_pathway(i);
+    release_assert(products.size() == 1);
+    res.push_back(products[0].product_species_id);
+  }
+  return res;
+}
+
+
+static vector<string> get_species_names(BNGEngine& bng_engine) {
+  vector<string> res;
+  for (const Species* s: bng_engine.get_all_species().get_species_vector()) {
+    res.push_back(s->name);
+  }
+  return res;
+}
+
+
+int main() {
+
+  BNGConfig bng_config;
+  bng_config.time_unit = 1e-6;
+
+  // products of a rxn with few product sets are defined right away
+  BNGEngine bng_engine_short(bng_config);
+  init_engine(bng_engine_short);
+  RxnClass* rxn_class_short = get_rxn_class(bng_engine_short, get_chain(3));
+  release_assert(rxn_class_short->get_num_pathways() == 3);
+  release_assert(rxn_class_short->get_num_undefined_pathways() == 0);
+
+  // products computed on demand and by the lazy product policy
+  const uint num_pathways = 10;
+  BNGEngine bng_engine_lazy(bng_config);
+  init_engine(bng_engine_lazy);
+  RxnClass* rxn_class_lazy = get_rxn_class(bng_engine_lazy, get_chain(num_pathways));
+  release_assert(rxn_class_lazy->get_num_pathways() == num_pathways);
+  release_assert(rxn_class_lazy->get_num_undefined_pathways() == num_pathways);
+
+  // queried pathways are defined one by one, the class is not hot yet
+  vector<uint> queries_cold = {7, 7, 0, 0, 1, 1};
+  vector<species_id_t> ids_lazy = query_products(rxn_class_lazy, queries_cold);
+  release_assert(rxn_class_lazy->get_num_undefined_pathways() == num_pathways - 3);
+  release_assert(rxn_class_lazy->get_num_precomputed_pathways() == 0);
+  release_assert(rxn_class_lazy->get_num_product_queries() == queries_cold.size());
+
+  // class is queried repeatedly and as much time was spent on computing products on demand
+  // as it would take to compute the rest, products of the remaining pathways are precomputed
+  vector<uint> queries_hot = {2, 2, 3, 3, 4, 4};
+  vector<species_id_t> ids_lazy_hot = query_products(rxn_class_lazy, queries_hot);
+  ids_lazy.insert(ids_lazy.end(), ids_lazy_hot.begin(), ids_lazy_hot.end());
+  release_assert(rxn_class_lazy->get_num_undefined_pathways() == num_pathways - 6);
+  release_assert(rxn_class_lazy->get_num_precomputed_pathways() == num_pathways - 6);
+
+  // species of precomputed products are created only once they are queried
+  uint num_species_before = bng_engine_lazy.get_all_species().get_species_vector().size();
+  vector<uint> queries_rest = {9, 5, 9, 8, 6};
+  vector<species_id_t> ids_lazy_rest = query_products(rxn_class_lazy, queries_rest);
+  ids_lazy.insert(ids_lazy.end(), ids_lazy_rest.begin(), ids_lazy_rest.end());
+  release_assert(rxn_class_lazy->get_num_undefined_pathways() == 0);
+  release_assert(rxn_class_lazy->get_num_precomputed_pathways() == 0);
+  release_assert(bng_engine_lazy.get_all_species().get_species_vector().size() == num_species_before + 4);
+
+  // all products computed right after initialization,
+  // the policy decides only when the products are computed, results must be the same
+  BNGEngine bng_engine_eager(bng_config);
+  init_engine(bng_engine_eager);
+  RxnClass* rxn_class_eager = get_rxn_class(bng_engine_eager, get_chain(num_pathways));
+  release_assert(rxn_class_eager->precompute_pathway_products() == num_pathways);
+  release_assert(rxn_class_eager->get_num_undefined_pathways() == num_pathways);
+  release_assert(rxn_class_eager->get_num_precomputed_pathways() == num_pathways);
+
+  vector<uint> all_queries = queries_cold;
+  all_queries.insert(all_queries.end(), queries_hot.begin(), queries_hot.end());
+  all_queries.insert(all_queries.end(), queries_rest.begin(), queries_rest.end());
+  vector<species_id_t> ids_eager = query_products(rxn_class_eager, all_queries);
+  release_assert(rxn_class_eager->get_num_undefined_pathways() == 0);
+
+  release_assert(ids_lazy == ids_eager);
+  release_assert(get_species_names(bng_engine_lazy) == get_species_names(bng_engine_eager));
+
+  // each pathway gives a different product
+  for (uint i = 0; i < num_pathways; i++) {
+    for (uint k = i + 1; k < num_pathways; k++) {
+      release_assert(
+          rxn_class_lazy->get_rxn_products_for_pathway(i)[0].product_species_id !=
+          rxn_class_lazy->get_rxn_products_for_pathway(k)[0].product_species_id);
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#include <string>
+#include <set>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  // none of the rules needs graph manipulation to create products
+  const RxnRuleVector& rxn_rules = bng_engine.get_all_rxns().get_rxn_rules_vector();
+  release_assert(rxn_rules.size() == 6);
+  for (const RxnRule* rxn_rule: rxn_rules) {
+    release_assert(!rxn_rule->is_simple());
+    release_assert(rxn_rule->uses_edit_script());
+  }
+
+  // products of complex rules are created with edit scripts,
+  // in debug builds they are also checked against products created with graphs
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+
+  // print the result
+  dump_network(all_rxn_classes);
+
+  // check the number of rxn classes we got
+  // A(b,s~1) + B(a,c) has a second pathway that deletes B
+  release_assert(all_rxn_classes.size() == 6);
+  release_assert(get_num_rxns_in_network(all_rxn_classes) == 10);
+}
@@ -0,0 +1,61 @@
+#include <string>
+#include <set>
+#include <vector>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  RxnContainer& all_rxns = bng_engine.get_all_rxns();
+  const ReactantPatternTable& table = all_rxns.get_reactant_pattern_table();
+
+  // reactant X(y!1,p~0).Y(x!1) is shared by two rxn rules
+  uint num_reactants = 0;
+  for (const RxnRule* r: all_rxns.get_rxn_rules_vector()) {
+    num_reactants += r->reactants.size();
+  }
+  release_assert(num_reactants == 5);
+  // observable pattern X(p~1,y) is also added
+  release_assert(table.get_num_patterns() == 5);
+
+  const RxnRule* dissoc = all_rxns.get_rxn_rules_vector()[2];
+  const RxnRule* cat = all_rxns.get_rxn_rules_vector()[3];
+  release_assert(dissoc->get_reactant_pattern_id(0) == cat->get_reactant_pattern_id(0));
+
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+  release_assert(!all_rxn_classes.empty());
+
+  // each species was matched at most once against each unique pattern
+  uint num_species = bng_engine.get_all_species().get_species_vector().size();
+  uint64_t num_computations = table.get_num_match_computations();
+  release_assert(num_computations > 0);
+  release_assert(num_computations <= (uint64_t)table.get_num_patterns() * num_species);
+
+  // cached matches are reused after the rxn rule caches are reset
+  all_rxns.reset_caches();
+  set<RxnClass*> all_rxn_classes_recreated;
+  generate_network(bng_engine, all_rxn_classes_recreated);
+  release_assert(all_rxn_classes_recreated.size() == all_rxn_classes.size());
+  release_assert(table.get_num_match_computations() == num_computations);
+
+  dump_network(all_rxn_classes_recreated);
+}
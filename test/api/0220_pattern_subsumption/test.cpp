@@ -0,0 +1,97 @@
+#include <string>
+#include <set>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static pattern_id_t find_pattern_id(const ReactantPatternTable& table, const string& pattern_str) {
+  for (pattern_id_t id = 0; id < table.get_num_patterns(); id++) {
+    if (table.get_pattern(id).to_str(false, false) == pattern_str) {
+      return id;
+    }
+  }
+  return PATTERN_ID_INVALID;
+}
+
+
+static bool is_closest_more_general(
+    const ReactantPatternTable& table, const string& general, const string& specific) {
+  const vector<pattern_id_t>& ids = table.get_more_general_patterns(find_pattern_id(table, specific));
+  return find(ids.begin(), ids.end(), find_pattern_id(table, general)) != ids.end();
+}
+
+
+static Cplx parse_pattern(BNGData& bng_data, const string& str) {
+  Cplx res(&bng_data);
+  int num_errors = parse_single_cplx_string(str, bng_data, res);
+  release_assert(num_errors == 0);
+  res.finalize_cplx();
+  return res;
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // we must initialize the bng_engine now
+  bng_engine.initialize();
+
+  ReactantPatternTable& table = bng_engine.get_all_rxns().get_reactant_pattern_table();
+
+  // observable A is added to the rxn rule patterns, A(b~P) is shared
+  release_assert(table.get_num_patterns() == 6);
+
+  release_assert(is_closest_more_general(table, "A", "A(b~0)"));
+  release_assert(is_closest_more_general(table, "A", "A(b~P)"));
+  release_assert(is_closest_more_general(table, "A", "A(c)"));
+  release_assert(is_closest_more_general(table, "A(b~P)", "A(b~P,c!1).C(a!1)"));
+  // A is reached through A(b~P)
+  release_assert(!is_closest_more_general(table, "A", "A(b~P,c!1).C(a!1)"));
+  // unbound component is not more general than a bound one
+  release_assert(!is_closest_more_general(table, "A(c)", "A(b~P,c!1).C(a!1)"));
+  release_assert(table.get_more_general_patterns(find_pattern_id(table, "A")).empty());
+  release_assert(table.get_more_general_patterns(find_pattern_id(table, "C(a)")).empty());
+
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+
+  // results with pruning must be the same as when every pattern is matched
+  const SpeciesContainer& all_species = bng_engine.get_all_species();
+  for (const Species* s: all_species.get_species_vector()) {
+    for (pattern_id_t id = 0; id < table.get_num_patterns(); id++) {
+      release_assert(
+          table.species_matches(id, s->id, all_species) ==
+          s->matches_pattern(table.get_pattern(id), true));
+    }
+  }
+
+  // species without A were decided without matching them onto the specific A patterns
+  release_assert(table.get_num_matches_pruned() > 0);
+
+  dump_network(all_rxn_classes);
+
+  // pattern matching uses induced subgraphs, D(x!+,x!+) does not match D(x!1,x!1)
+  // because the bond between its components is not in the pattern
+  ReactantPatternTable bond_table;
+  bond_table.add_pattern(parse_pattern(bng_data, "D(x!+,x!+)"));
+  bond_table.add_pattern(parse_pattern(bng_data, "D(x!1,x!1)"));
+  bond_table.add_pattern(parse_pattern(bng_data, "D(x!+)"));
+  bond_table.compute_subsumption();
+  release_assert(!is_closest_more_general(bond_table, "D(x!+,x!+)", "D(x!1,x!1)"));
+  release_assert(is_closest_more_general(bond_table, "D(x!+)", "D(x!1,x!1)"));
+}
@@ -0,0 +1,66 @@
+#include <string>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static Cplx parse_cplx(BNGData& bng_data, const string& str) {
+  Cplx res(&bng_data);
+  int num_errors = parse_single_cplx_string(str, bng_data, res);
+  release_assert(num_errors == 0);
+  res.finalize_cplx();
+  return res;
+}
+
+
+static bool matches(BNGData& bng_data, const string& inst_str, const string& pattern_str) {
+  Cplx inst = parse_cplx(bng_data, inst_str);
+  Cplx pattern = parse_cplx(bng_data, pattern_str);
+  return inst.matches_pattern(pattern, true);
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  bng_engine.initialize();
+
+  // states, components with the same name are assigned to different components
+  release_assert(matches(bng_data, "A(x~0,x~1,y)", "A(x~1)"));
+  release_assert(matches(bng_data, "A(x~0,x~1,y)", "A(x~0,x~1)"));
+  release_assert(!matches(bng_data, "A(x~0,x~1,y)", "A(x~1,x~1)"));
+  release_assert(matches(bng_data, "A(x~1,x~1,y)", "A(x~1,x~1)"));
+  release_assert(matches(bng_data, "A(x~0,x~1,y)", "A"));
+  release_assert(!matches(bng_data, "B(a)", "A"));
+
+  // bond flags
+  release_assert(matches(bng_data, "A(x~0,x~1,y!1).B(a!1)", "A(y!+)"));
+  release_assert(!matches(bng_data, "A(x~0,x~1,y!1).B(a!1)", "A(y)"));
+  release_assert(matches(bng_data, "A(x~0,x~1,y!1).B(a!1)", "A(y!?)"));
+  release_assert(matches(bng_data, "A(x~0,x~1,y)", "A(y!?)"));
+  release_assert(matches(bng_data, "A(x~0!1,x~1,y).B(a!1)", "A(x~1,x!+)"));
+  release_assert(!matches(bng_data, "A(x~0!1,x~1,y).B(a!1)", "A(x~0,x!+)"));
+  release_assert(matches(bng_data, "A(x~0,x~1,y!1).B(a!1)", "B(a!+)"));
+
+  // two pattern components cannot be matched onto components bound to each other
+  release_assert(!matches(bng_data, "A(x~0!1,x~1!1,y)", "A(x!+,x!+)"));
+  release_assert(matches(bng_data, "A(x~0!1,x~1!1,y)", "A(x!+)"));
+  release_assert(matches(bng_data, "A(x~0!1,x~1!1,y)", "A(x!+,y)"));
+  release_assert(matches(bng_data, "A(x~0!1,x~1!2,y).B(a!1).B(a!2)", "A(x!+,x!+)"));
+
+  // pattern with an explicit bond uses graph matching
+  release_assert(matches(bng_data, "A(x~0!1,x~1!1,y)", "A(x!1,x!1)"));
+  release_assert(!matches(bng_data, "A(x~0!1,x~1!2,y).B(a!1).B(a!2)", "A(x!1,x!1)"));
+}
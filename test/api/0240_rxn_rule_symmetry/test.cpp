@@ -0,0 +1,92 @@
+#include <string>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static bool may_produce_identical_products(const RxnRule* r) {
+  return r->has_flag(RXN_FLAG_MAY_PRODUCE_MUTLIPLE_IDENTICAL_PRODUCTS);
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  // load the test BNG file
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  bng_engine.initialize();
+
+  const RxnRuleVector& rules = bng_engine.get_all_rxns().get_rxn_rules_vector();
+  release_assert(rules.size() == 5);
+
+  const RxnRule* bind = rules[0];
+  release_assert(may_produce_identical_products(bind));
+  // reactants can be swapped, vertices are A, b, A, b
+  release_assert(bind->get_patterns_symmetry_factor() == 2);
+  const vector<int>& orbits = bind->get_patterns_graph_orbits();
+  release_assert(orbits.size() == 4);
+  release_assert(orbits[0] == orbits[2] && orbits[1] == orbits[3]);
+  release_assert(orbits[0] != orbits[1]);
+
+  const RxnRule* unbind = rules[1];
+  release_assert(may_produce_identical_products(unbind));
+  release_assert(unbind->get_patterns_symmetry_factor() == 2);
+
+  // found by matching of patterns onto each other
+  const RxnRule* bind_c = rules[2];
+  release_assert(may_produce_identical_products(bind_c));
+  release_assert(bind_c->get_patterns_symmetry_factor() == 1);
+
+  const RxnRule* bind_b = rules[3];
+  release_assert(!may_produce_identical_products(bind_b));
+  release_assert(bind_b->get_patterns_symmetry_factor() == 1);
+
+  const RxnRule* phos = rules[4];
+  release_assert(!may_produce_identical_products(phos));
+  release_assert(phos->get_patterns_symmetry_factor() == 1);
+
+  // symmetric dimer
+  Species dimer(bng_data);
+  num_errors = parse_single_cplx_string("A(b~0!1,c).A(b~0!1,c)", bng_data, dimer);
+  release_assert(num_errors == 0);
+  dimer.finalize_species(bng_config, false);
+  SpeciesContainer& all_species = bng_engine.get_all_species();
+  species_id_t dimer_id = all_species.find_or_add(dimer);
+
+  RxnClass* rxn_class = bng_engine.get_all_rxns().get_unimol_rxn_class(dimer_id);
+  release_assert(rxn_class != nullptr);
+  rxn_class->init_rxn_pathways_and_rates();
+
+  // both matches of unbind give the same products and only one is kept,
+  // phos modifies different molecules so both of its matches are used
+  uint num_unbind_pathways = 0;
+  uint num_phos_pathways = 0;
+  for (const RxnClassPathway& pathway: rxn_class->pathways) {
+    if (pathway.rxn_rule_id == unbind->id) {
+      num_unbind_pathways++;
+    }
+    else if (pathway.rxn_rule_id == phos->id) {
+      num_phos_pathways++;
+    }
+  }
+  release_assert(num_unbind_pathways == 1);
+  release_assert(num_phos_pathways == 2);
+
+  // molecules observable counts both matches of the symmetric pattern
+  ReactantPatternTable& table = bng_engine.get_all_rxns().get_reactant_pattern_table();
+  const Cplx& obs_pattern = bng_data.get_observables()[0].patterns[0];
+  pattern_id_t obs_id = table.add_pattern(obs_pattern);
+  release_assert(table.get_pattern_symmetry(obs_id).factor == 2);
+  release_assert(table.get_num_pattern_matches(obs_id, dimer_id, all_species) == 2);
+  release_assert(all_species.get(dimer_id).get_pattern_num_matches(obs_pattern) == 2);
+}
@@ -0,0 +1,78 @@
+#include <string>
+#include <vector>
+#include <thread>
+#include <sstream>
+#include <iostream>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+struct ParseResult {
+  int num_errors;
+  uint num_rxn_rules;
+  uint num_seed_species;
+  map<string, double> parameters;
+  string cplx;
+};
+
+
+static void parse(const string& file_name, const map<string, double>& overrides, ParseResult& res) {
+  BNGData bng_data;
+  res.num_errors = parse_bngl_file(file_name, bng_data, overrides);
+  res.num_rxn_rules = bng_data.get_rxn_rules().size();
+  res.num_seed_species = bng_data.get_seed_species().size();
+  res.parameters = bng_data.get_parameters();
+
+  Cplx cplx(&bng_data);
+  res.num_errors += parse_single_cplx_string("A(c!1,b~P).C(a!1)", bng_data, cplx);
+  res.cplx = cplx.to_str();
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  const uint num_threads = 8;
+
+  // each thread parses its own variant of the model
+  vector<ParseResult> results(num_threads);
+  vector<thread> threads;
+  for (uint i = 0; i < num_threads; i++) {
+    map<string, double> overrides;
+    overrides["k_bind"] = i + 1;
+    threads.push_back(thread(parse, file_name, overrides, std::ref(results[i])));
+  }
+  for (thread& t: threads) {
+    t.join();
+  }
+
+  ParseResult sequential;
+  parse(file_name, map<string, double>(), sequential);
+  release_assert(sequential.num_errors == 0);
+
+  for (uint i = 0; i < num_threads; i++) {
+    const ParseResult& r = results[i];
+    release_assert(r.num_errors == 0);
+    release_assert(r.num_rxn_rules == sequential.num_rxn_rules);
+    release_assert(r.num_seed_species == sequential.num_seed_species);
+    release_assert(r.parameters.at("k_bind") == i + 1);
+    release_assert(r.parameters.at("k_unbind") == sequential.parameters.at("k_unbind"));
+    release_assert(r.cplx == sequential.cplx);
+  }
+
+  // errors in a single complex string are reported on line 1
+  BNGData bng_data;
+  release_assert(parse_bngl_file(file_name, bng_data) == 0);
+  stringstream err_out;
+  streambuf* orig_cerr = cerr.rdbuf(err_out.rdbuf());
+  Cplx cplx(&bng_data);
+  int num_errors = parse_single_cplx_string("A(c!1,b~P).C(a!1", bng_data, cplx);
+  cerr.rdbuf(orig_cerr);
+  release_assert(num_errors != 0);
+  release_assert(err_out.str().find("A(c!1,b~P).C(a!1:1: error:") == 0);
+}
@@ -0,0 +1,97 @@
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <iostream>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static string read_file(const string& file_name) {
+  ifstream in(file_name);
+  release_assert(in.is_open());
+  stringstream ss;
+  ss << in.rdbuf();
+  return ss.str();
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+  string contents = read_file(file_name);
+
+  // model read from a file and from memory must be the same
+  BNGData from_file;
+  int num_errors = parse_bngl_file(file_name, from_file);
+  release_assert(num_errors == 0);
+
+  BNGData from_buffer;
+  num_errors = parse_bngl_buffer(contents, from_buffer);
+  release_assert(num_errors == 0);
+  check_same_model(from_file, from_buffer);
+
+  // parameter overrides are applied as well
+  map<string, double> overrides;
+  overrides["k_bind"] = 5;
+  BNGData from_buffer_overridden;
+  num_errors = parse_bngl_buffer(contents, from_buffer_overridden, overrides, "generated_model");
+  release_assert(num_errors == 0);
+  release_assert(from_buffer_overridden.get_parameters().at("k_bind") == 5);
+
+  // buffer does not need to be terminated
+  string twice = contents + contents;
+  BNGData from_view;
+  num_errors = parse_bngl_buffer(string_view(twice.data(), contents.size()), from_view);
+  release_assert(num_errors == 0);
+  check_same_model(from_file, from_view);
+
+  // file that fills whole memory pages, the terminating zero bytes are on the next page
+  string padded = contents + "#";
+  while (padded.size() % 4096 != 4095) {
+    padded += " ";
+  }
+  padded += "\n";
+  string padded_file_name = "0260_parse_bngl_buffer_padded.bngl";
+  {
+    ofstream out(padded_file_name, ios::binary);
+    out << padded;
+  }
+  BNGData from_padded_file;
+  num_errors = parse_bngl_file(padded_file_name, from_padded_file);
+  remove(padded_file_name.c_str());
+  release_assert(num_errors == 0);
+  check_same_model(from_file, from_padded_file);
+
+  // errors are reported with their line numbers
+  stringstream err_out;
+  streambuf* orig_cerr = cerr.rdbuf(err_out.rdbuf());
+  BNGData invalid;
+  num_errors = parse_bngl_buffer("begin parameters\n  k 1 )\nend parameters\n", invalid);
+  cerr.rdbuf(orig_cerr);
+  release_assert(num_errors != 0);
+  release_assert(err_out.str().find("<buffer>:2: error:") == 0);
+
+  string invalid_file_name = "0260_parse_bngl_buffer_invalid.bngl";
+  {
+    ofstream out(invalid_file_name, ios::binary);
+    out << "begin parameters\n  k 1\n  l 2 )\nend parameters\n";
+  }
+  err_out.str("");
+  orig_cerr = cerr.rdbuf(err_out.rdbuf());
+  BNGData invalid_file;
+  num_errors = parse_bngl_file(invalid_file_name, invalid_file);
+  cerr.rdbuf(orig_cerr);
+  remove(invalid_file_name.c_str());
+  release_assert(num_errors != 0);
+  release_assert(err_out.str().find(invalid_file_name + ":3: error:") == 0);
+
+  // missing file
+  BNGData missing;
+  num_errors = parse_bngl_file("nonexistent_file.bngl", missing);
+  release_assert(num_errors != 0);
+}
@@ -0,0 +1,100 @@
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGData bng_data;
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  // results are compared with strings parsed one by one
+  BNGData bng_data_single;
+  num_errors = parse_bngl_file(file_name, bng_data_single);
+  release_assert(num_errors == 0);
+
+  vector<string> cplx_strings = {
+      // canonical
+      "A(x~0,x~1,y)",
+      "A(x~0!1,x~1,y).B(a!1)",
+      "A(x~0!1,x~1!1,y)",
+      "B(a!+)",
+      "A(y!?)",
+      "A",
+      "A()",
+      // compartments and whitespace
+      "B(a)@EC",
+      "@EC:A(y)",
+      "A(x~0, y)",
+      // extend molecule types
+      "C(b~Z)",
+      "C(b~Z)",
+      "A(x~01)",
+      "A(x~2)",
+      // errors
+      "A(y!1)",
+      "A(y,y)",
+      "A(x~0~1)",
+      "A(x~3).",
+      // correct strings after errors
+      "A(x~2,x~1,y!1).B(a!1)",
+      "C(b~Z!1).C(b~Z!1)"
+  };
+
+  vector<Cplx> cplxs;
+  num_errors = parse_cplx_strings(cplx_strings, bng_data, cplxs);
+  release_assert(cplxs.size() == cplx_strings.size());
+
+  int num_errors_single = 0;
+  for (size_t i = 0; i < cplx_strings.size(); i++) {
+    Cplx single(&bng_data_single);
+    int n = parse_single_cplx_string(cplx_strings[i], bng_data_single, single);
+    num_errors_single += n;
+    if (n != 0) {
+      release_assert(cplxs[i].elem_mols.empty());
+    }
+    else {
+      release_assert(cplxs[i].to_str() == single.to_str());
+      release_assert(cplxs[i].elem_mols == single.elem_mols);
+    }
+  }
+  release_assert(num_errors == num_errors_single);
+  release_assert(num_errors >= 4);
+
+  release_assert(bng_data.get_elem_mol_types().size() == bng_data_single.get_elem_mol_types().size());
+  for (size_t i = 0; i < bng_data.get_elem_mol_types().size(); i++) {
+    release_assert(bng_data.get_elem_mol_types()[i].to_str(bng_data) ==
+        bng_data_single.get_elem_mol_types()[i].to_str(bng_data_single));
+  }
+
+  // strings after the first one that needs the parser reuse the scanner,
+  // their errors are still reported on line 1
+  stringstream err_out;
+  streambuf* orig_cerr = cerr.rdbuf(err_out.rdbuf());
+  num_errors = parse_cplx_strings({"B(a)@EC", "@EC:A(y)", "A(x~3)."}, bng_data, cplxs);
+  cerr.rdbuf(orig_cerr);
+  release_assert(num_errors == 1);
+  release_assert(err_out.str().find("A(x~3).:1: error:") == 0);
+
+  // many species names
+  vector<string> species_names;
+  for (int i = 0; i < 10000; i++) {
+    species_names.push_back("A(x~" + to_string(i % 2) + "!1,x~" + to_string(i % 3) + ",y!2).B(a!1).B(a!2)");
+  }
+  num_errors = parse_cplx_strings(species_names, bng_data, cplxs);
+  release_assert(num_errors == 0);
+  release_assert(cplxs.size() == species_names.size());
+  for (const Cplx& c: cplxs) {
+    release_assert(c.elem_mols.size() == 3);
+  }
+}
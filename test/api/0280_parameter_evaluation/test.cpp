@@ -0,0 +1,53 @@
+#include <string>
+#include <sstream>
+#include <cmath>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGData bng_data;
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data, "b") == 6);
+  release_assert(get_parameter(bng_data, "c") == 8);
+  release_assert(get_parameter(bng_data, "d") == 4);
+  release_assert(bng_data.get_rxn_rules()[0].base_rate_constant == 8);
+
+  // overrides are used by dependent parameters
+  map<string, double> overrides;
+  overrides["a"] = 1;
+  BNGData bng_data_overridden;
+  num_errors = parse_bngl_file(file_name, bng_data_overridden, overrides);
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data_overridden, "d") == 4);
+
+  // deep hierarchy where each parameter uses the previous one twice,
+  // each parameter must be evaluated only once
+  const int num_params = 20000;
+  stringstream model;
+  model << "begin parameters\n";
+  model << "  p0 1\n";
+  for (int i = 1; i < num_params; i++) {
+    model << "  p" << i << " (p" << i - 1 << " + p" << i - 1 << ") / 2 + 1\n";
+  }
+  model << "end parameters\n";
+
+  BNGData bng_data_deep;
+  num_errors = parse_bngl_buffer(model.str(), bng_data_deep);
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data_deep, "p" + to_string(num_params - 1)) == num_params);
+
+  // cycles are reported
+  BNGData bng_data_cyclic;
+  num_errors = parse_bngl_buffer(
+      "begin parameters\n  x y + 1\n  y z\n  z x * 2\n  w 1\nend parameters\n", bng_data_cyclic);
+  release_assert(num_errors == 1);
+}
@@ -0,0 +1,129 @@
+#include <string>
+#include <set>
+#include <map>
+#include <cmath>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+// returns rxn class that uses only the given rxn rule
+static RxnClass* find_rxn_class(const set<RxnClass*>& all_rxn_classes, const rxn_rule_id_t id) {
+  for (RxnClass* rc: all_rxn_classes) {
+    if (rc->get_num_reactions() == 1 && rc->get_rxn_rule_id(0) == id) {
+      return rc;
+    }
+  }
+  release_assert(false && "Rxn class not found");
+  return nullptr;
+}
+
+
+static bool eq(const double a, const double b) {
+  return fabs(a - b) <= 1e-12 * fabs(a);
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+
+  int num_errors = parse_bngl_file(file_name, bng_data);
+  release_assert(num_errors == 0);
+
+  bng_engine.initialize();
+
+  set<RxnClass*> all_rxn_classes;
+  generate_network(bng_engine, all_rxn_classes);
+
+  RxnContainer& all_rxns = bng_engine.get_all_rxns();
+  const RxnRule* dephos = all_rxns.get(0);
+  const RxnRule* bind = all_rxns.get(1);
+  const RxnRule* cat = all_rxns.get(3);
+  release_assert(bind->base_rate_constant == 15e7);
+  release_assert(cat->base_rate_constant == 3e5);
+
+  RxnClass* dephos_class = find_rxn_class(all_rxn_classes, dephos->id);
+  RxnClass* bind_class = find_rxn_class(all_rxn_classes, bind->id);
+  double dephos_p = dephos_class->get_max_fixed_p();
+  double bind_p = bind_class->get_max_fixed_p();
+
+  uint num_species = bng_engine.get_all_species().get_species_vector().size();
+  uint num_rxn_classes = all_rxns.get_num_rxn_classes();
+
+  // dependent parameters and rates are updated, rxn classes are kept
+  map<string, double> overrides;
+  overrides["kon_base"] = 3e6;
+  overrides["kcat"] = 1e6;
+  num_errors = bng_engine.update_parameters(overrides);
+  release_assert(num_errors == 0);
+
+  release_assert(get_parameter(bng_data, "kon") == 3e7);
+  release_assert(get_parameter(bng_data, "kcat") == 1e6);
+  release_assert(get_parameter(bng_data, "koff") == 1e8);
+  release_assert(bind->base_rate_constant == 3e7);
+  release_assert(cat->base_rate_constant == 5e5);
+  release_assert(eq(bind_class->get_max_fixed_p(), bind_p * 0.2));
+  release_assert(dephos_class->get_max_fixed_p() == dephos_p);
+
+  set<RxnClass*> all_rxn_classes_after_update;
+  generate_network(bng_engine, all_rxn_classes_after_update);
+  release_assert(all_rxn_classes_after_update == all_rxn_classes);
+  release_assert(bng_engine.get_all_species().get_species_vector().size() == num_species);
+  release_assert(all_rxns.get_num_rxn_classes() == num_rxn_classes);
+
+  // overrides from the previous call are not kept
+  overrides.clear();
+  overrides["dephos"] = 1e6;
+  num_errors = bng_engine.update_parameters(overrides);
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data, "kon") == 15e7);
+  release_assert(get_parameter(bng_data, "kcat") == 0.6 * 1e6);
+  release_assert(bind->base_rate_constant == 15e7);
+  release_assert(eq(bind_class->get_max_fixed_p(), bind_p));
+  release_assert(eq(dephos_class->get_max_fixed_p(), dephos_p * 2));
+
+  // unknown parameter
+  overrides["unknown"] = 1;
+  num_errors = bng_engine.update_parameters(overrides);
+  release_assert(num_errors == 1);
+  release_assert(get_parameter(bng_data, "dephos") == 1e6);
+
+  // parameters overridden during parsing get their definition from the model back
+  // once they are not overridden
+  BNGConfig bng_config_overridden;
+  BNGEngine bng_engine_overridden(bng_config_overridden);
+  BNGData& bng_data_overridden = bng_engine_overridden.get_data();
+
+  map<string, double> parse_overrides;
+  parse_overrides["kon_base"] = 3e6;
+  parse_overrides["kcat"] = 1e6;
+  parse_overrides["not_in_model"] = 2;
+  num_errors = parse_bngl_file(file_name, bng_data_overridden, parse_overrides);
+  release_assert(num_errors == 0);
+
+  bng_engine_overridden.initialize();
+
+  const RxnRule* bind_overridden = bng_engine_overridden.get_all_rxns().get(1);
+  const RxnRule* cat_overridden = bng_engine_overridden.get_all_rxns().get(3);
+  release_assert(get_parameter(bng_data_overridden, "kon") == 3e7);
+  release_assert(bind_overridden->base_rate_constant == 3e7);
+  release_assert(cat_overridden->base_rate_constant == 5e5);
+
+  num_errors = bng_engine_overridden.update_parameters(map<string, double>());
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data_overridden, "kon_base") == 15e6);
+  release_assert(get_parameter(bng_data_overridden, "kon") == 15e7);
+  release_assert(get_parameter(bng_data_overridden, "kcat") == 0.6 * 1e6);
+  release_assert(bind_overridden->base_rate_constant == 15e7);
+  release_assert(cat_overridden->base_rate_constant == 3e5);
+  // has no definition in the model, keeps the parse-time value
+  release_assert(get_parameter(bng_data_overridden, "not_in_model") == 2);
+}
@@ -0,0 +1,119 @@
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+// rxn rules loaded from the cache are not finalized and are not canonicalized again,
+// they are finalized only once by BNGEngine::initialize
+static void check_rules_not_finalized(const BNGData& loaded) {
+  for (const RxnRule& r: loaded.get_rxn_rules()) {
+    release_assert(!r.is_finalized());
+    release_assert(r.cplxs_are_canonical);
+  }
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+  // tests are run in a work directory
+  string cache_file_name = "0300_model_cache.bngcache";
+  remove(cache_file_name.c_str());
+
+  BNGData parsed_bng_data;
+  int num_errors = parse_bngl_file(file_name, parsed_bng_data);
+  release_assert(num_errors == 0);
+
+  // cache is created
+  BNGData first_bng_data;
+  num_errors = parse_bngl_file_cached(file_name, cache_file_name, first_bng_data);
+  release_assert(num_errors == 0);
+  check_same_model(parsed_bng_data, first_bng_data);
+
+  ifstream fin(file_name);
+  stringstream source;
+  source << fin.rdbuf();
+  uint64_t key = get_model_cache_key(source.str(), map<string, double>());
+
+  BNGData loaded_bng_data;
+  release_assert(load_model_cache(cache_file_name, key, loaded_bng_data));
+  check_same_model(parsed_bng_data, loaded_bng_data);
+  check_rules_not_finalized(loaded_bng_data);
+
+  // overrides are a part of the key
+  map<string, double> overrides;
+  overrides["kon_base"] = 1e6;
+  release_assert(get_model_cache_key(source.str(), overrides) != key);
+  release_assert(!load_model_cache(cache_file_name, get_model_cache_key(source.str(), overrides), loaded_bng_data));
+  release_assert(loaded_bng_data.get_rxn_rules().size() == parsed_bng_data.get_rxn_rules().size());
+
+  // parameter sweep works also with a model loaded from the cache
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  BNGData& bng_data = bng_engine.get_data();
+  num_errors = parse_bngl_file_cached(file_name, cache_file_name, bng_data);
+  release_assert(num_errors == 0);
+  check_same_model(parsed_bng_data, bng_data);
+
+  check_rules_not_finalized(bng_data);
+
+  bng_engine.initialize();
+
+  // the engine finalized its copies of the rules, rules in bng_data stay as they were loaded
+  check_rules_not_finalized(bng_data);
+  const RxnRuleVector& engine_rules = bng_engine.get_all_rxns().get_rxn_rules_vector();
+  release_assert(engine_rules.size() == parsed_bng_data.get_rxn_rules().size());
+  for (size_t i = 0; i < engine_rules.size(); i++) {
+    release_assert(engine_rules[i]->is_finalized());
+    release_assert(engine_rules[i]->to_str() == parsed_bng_data.get_rxn_rules()[i].to_str());
+    // symmetry is computed from the loaded canonical complexes
+    release_assert(
+        engine_rules[i]->get_patterns_symmetry_factor() ==
+        parsed_bng_data.get_rxn_rules()[i].get_patterns_symmetry_factor());
+    release_assert(
+        engine_rules[i]->get_patterns_graph_orbits() ==
+        parsed_bng_data.get_rxn_rules()[i].get_patterns_graph_orbits());
+  }
+
+  const RxnRule* bind = bng_engine.get_all_rxns().get(1);
+  const RxnRule* unbind = bng_engine.get_all_rxns().get(2);
+  release_assert(bind->base_rate_constant == 15e7);
+  release_assert(unbind->base_rate_constant == 7.5e6);
+
+  overrides["kon_base"] = 4e6;
+  num_errors = bng_engine.update_parameters(overrides);
+  release_assert(num_errors == 0);
+  release_assert(get_parameter(bng_data, "kon") == 4e7);
+  release_assert(get_parameter(bng_data, "koff") == 2e6);
+  release_assert(bind->base_rate_constant == 4e7);
+  release_assert(unbind->base_rate_constant == 2e6);
+
+  // damaged cache is not used
+  {
+    fstream f(cache_file_name, ios::in | ios::out | ios::binary);
+    f.seekg(0, ios::end);
+    streamoff size = f.tellg();
+    f.seekp(size / 2);
+    char c = 0x55;
+    f.write(&c, 1);
+  }
+  release_assert(!load_model_cache(cache_file_name, key, loaded_bng_data));
+  check_same_model(parsed_bng_data, loaded_bng_data);
+
+  // and is replaced by the next parse
+  BNGData reparsed_bng_data;
+  num_errors = parse_bngl_file_cached(file_name, cache_file_name, reparsed_bng_data);
+  release_assert(num_errors == 0);
+  release_assert(load_model_cache(cache_file_name, key, loaded_bng_data));
+  check_same_model(parsed_bng_data, loaded_bng_data);
+
+  remove(cache_file_name.c_str());
+}
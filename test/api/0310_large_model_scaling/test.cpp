@@ -0,0 +1,132 @@
+#include <string>
+#include <sstream>
+#include <chrono>
+#include <iostream>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+// generates a model similar to those created by scripts,
+// each part of the model has num_items items and molecule types are defined implicitly
+static string generate_model(const uint num_items) {
+  stringstream ss;
+
+  ss << "begin parameters\n";
+  ss << "  k0 1\n";
+  for (uint i = 1; i < num_items; i++) {
+    ss << "  k" << i << " k" << i - 1 << " + 1e-3\n";
+  }
+  ss << "end parameters\n";
+
+  ss << "begin seed species\n";
+  for (uint i = 0; i < num_items; i++) {
+    ss << "  M" << i << "(s~0,b) 10\n";
+  }
+  ss << "end seed species\n";
+
+  ss << "begin observables\n";
+  for (uint i = 0; i < num_items; i++) {
+    ss << "  Molecules O" << i << " M" << i << "(s~1)\n";
+  }
+  ss << "end observables\n";
+
+  ss << "begin reaction rules\n";
+  for (uint i = 0; i < num_items; i++) {
+    ss << "  M" << i << "(s~0) -> M" << i << "(s~1) k" << i << "\n";
+    ss << "  M" << i << "(s~1,b) -> M" << i << "(s~0,b) k" << i << "\n";
+    ss << "  M" << i << "(b) + M" << (i + 1) % num_items << "(b) -> " <<
+        "M" << i << "(b!1).M" << (i + 1) % num_items << "(b!1) k" << i << "\n";
+  }
+  ss << "end reaction rules\n";
+
+  return ss.str();
+}
+
+
+// returns time in seconds
+static double parse_model(const uint num_items) {
+  string model = generate_model(num_items);
+
+  BNGData bng_data;
+  auto start = chrono::steady_clock::now();
+  int num_errors = parse_bngl_buffer(model, bng_data);
+  double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  release_assert(num_errors == 0);
+  release_assert(bng_data.get_elem_mol_types().size() == num_items);
+  release_assert(bng_data.get_rxn_rules().size() == 3 * num_items);
+  release_assert(bng_data.get_seed_species().size() == num_items);
+  release_assert(bng_data.get_observables().size() == num_items);
+  release_assert(bng_data.get_parameters().size() == num_items);
+  release_assert(bng_data.find_elem_mol_type_id("M" + to_string(num_items - 1)) != ELEM_MOL_TYPE_ID_INVALID);
+  return time;
+}
+
+
+// returns time in seconds
+static double compute_pattern_subsumption(const uint num_items) {
+  string model = generate_model(num_items);
+
+  BNGConfig bng_config;
+  BNGEngine bng_engine(bng_config);
+  int num_errors = parse_bngl_buffer(model, bng_engine.get_data());
+  release_assert(num_errors == 0);
+  bng_engine.initialize();
+
+  // initialize already computed the subsumption, we measure only this step
+  ReactantPatternTable& table = bng_engine.get_all_rxns().get_reactant_pattern_table();
+  auto start = chrono::steady_clock::now();
+  table.compute_subsumption();
+  double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+  // each molecule type has patterns M(s~0), M(b), M(s~1) and M(s~1,b),
+  // M(b) and M(s~1) are more general than M(s~1,b)
+  release_assert(table.get_num_patterns() == 4 * num_items);
+  uint num_relations = 0;
+  for (pattern_id_t id = 0; id < table.get_num_patterns(); id++) {
+    num_relations += table.get_more_general_patterns(id).size();
+  }
+  release_assert(num_relations == 2 * num_items);
+  return time;
+}
+
+
+int main() {
+#ifdef SCALING_BENCHMARK
+  const uint base_size = 2000;
+#else
+  const uint base_size = 500;
+#endif
+  const uint scale = 4;
+
+#ifdef SCALING_BENCHMARK
+  // warm up
+  parse_model(base_size / 10);
+#endif
+
+  double base_time = parse_model(base_size);
+  double scaled_time = parse_model(base_size * scale);
+
+  cout << "items: " << base_size << ", time: " << base_time << " s\n";
+  cout << "items: " << base_size * scale << ", time: " << scaled_time << " s\n";
+  cout << "ratio: " << scaled_time / base_time << " (size ratio " << scale << ")\n";
+
+  double base_subsumption_time = compute_pattern_subsumption(base_size);
+  double scaled_subsumption_time = compute_pattern_subsumption(base_size * scale);
+
+  cout << "subsumption, items: " << base_size << ", time: " << base_subsumption_time << " s\n";
+  cout << "subsumption, items: " << base_size * scale << ", time: " << scaled_subsumption_time << " s\n";
+  cout << "subsumption ratio: " << scaled_subsumption_time / base_subsumption_time <<
+      " (size ratio " << scale << ")\n";
+
+#ifdef SCALING_BENCHMARK
+  // time must grow about linearly, quadratic growth would give a ratio of 16,
+  // checked only by the benchmark target because timing depends on the machine load
+  release_assert(scaled_time < 2.5 * scale * base_time);
+  release_assert(scaled_subsumption_time < 2.5 * scale * base_subsumption_time);
+#endif
+}
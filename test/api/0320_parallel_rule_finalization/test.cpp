@@ -0,0 +1,87 @@
+#include <string>
+#include <set>
+#include <vector>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static void check_same_rxn_rules(const RxnContainer& a, const RxnContainer& b) {
+  release_assert(a.get_rxn_rules_vector().size() == b.get_rxn_rules_vector().size());
+  for (size_t i = 0; i < a.get_rxn_rules_vector().size(); i++) {
+    const RxnRule* ra = a.get_rxn_rules_vector()[i];
+    const RxnRule* rb = b.get_rxn_rules_vector()[i];
+    release_assert(ra->id == i && rb->id == i);
+    release_assert(ra->is_finalized() && rb->is_finalized());
+    release_assert(ra->to_str() == rb->to_str());
+    release_assert(ra->get_flags() == rb->get_flags());
+    release_assert(ra->get_patterns_symmetry_factor() == rb->get_patterns_symmetry_factor());
+    release_assert(ra->get_patterns_graph_orbits() == rb->get_patterns_graph_orbits());
+    for (uint k = 0; k < ra->reactants.size(); k++) {
+      release_assert(ra->get_reactant_pattern_id(k) == rb->get_reactant_pattern_id(k));
+    }
+  }
+  release_assert(
+      a.get_reactant_pattern_table().get_num_patterns() ==
+      b.get_reactant_pattern_table().get_num_patterns());
+}
+
+
+static void get_species_names(const BNGEngine& bng_engine, vector<string>& names) {
+  for (const Species* s: bng_engine.get_all_species().get_species_vector()) {
+    names.push_back(s->name);
+  }
+}
+
+
+int main() {
+
+  string file_name = get_test_bngl_file_name(__FILE__);
+
+  BNGConfig bng_config;
+
+  BNGEngine serial_engine(bng_config);
+  int num_errors = parse_bngl_file(file_name, serial_engine.get_data());
+  release_assert(num_errors == 0);
+  serial_engine.initialize();
+
+  BNGEngine parallel_engine(bng_config);
+  num_errors = parse_bngl_file(file_name, parallel_engine.get_data());
+  release_assert(num_errors == 0);
+  parallel_engine.initialize(4);
+
+  // more threads than rules
+  BNGEngine many_threads_engine(bng_config);
+  num_errors = parse_bngl_file(file_name, many_threads_engine.get_data());
+  release_assert(num_errors == 0);
+  many_threads_engine.initialize(64);
+
+  // rules and their ids do not depend on the number of threads
+  release_assert(serial_engine.get_all_rxns().get_rxn_rules_vector().size() == 10);
+  check_same_rxn_rules(serial_engine.get_all_rxns(), parallel_engine.get_all_rxns());
+  check_same_rxn_rules(serial_engine.get_all_rxns(), many_threads_engine.get_all_rxns());
+
+  // and so does the generated network
+  set<RxnClass*> serial_rxn_classes;
+  generate_network(serial_engine, serial_rxn_classes);
+  set<RxnClass*> parallel_rxn_classes;
+  generate_network(parallel_engine, parallel_rxn_classes);
+  release_assert(serial_rxn_classes.size() == parallel_rxn_classes.size());
+
+  vector<string> serial_species;
+  get_species_names(serial_engine, serial_species);
+  vector<string> parallel_species;
+  get_species_names(parallel_engine, parallel_species);
+  release_assert(serial_species == parallel_species);
+
+  // rate updates are applied to the rules created in parallel
+  map<string, double> overrides;
+  overrides["kp"] = 5e2;
+  release_assert(parallel_engine.update_parameters(overrides) == 0);
+  release_assert(parallel_engine.get_all_rxns().get(4)->base_rate_constant == 5e2);
+
+  dump_network(parallel_rxn_classes);
+}
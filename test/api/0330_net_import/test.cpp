@@ -0,0 +1,149 @@
+#include <string>
+#include <set>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+using namespace std;
+
+#include "bng/bng.h"
+#include "../shared/test_utils.h"
+
+using namespace BNG;
+
+
+static string get_test_net_file_name(const char* source_file) {
+  string bngl_file_name = get_test_bngl_file_name(source_file);
+  return bngl_file_name.substr(0, bngl_file_name.size() - string("bngl").size()) + "net";
+}
+
+
+// returns sorted descriptions of all pathways of the network,
+// reactants and products are sorted so that their order does not matter
+static vector<string> get_network_pathways(const BNGEngine& bng_engine, const set<RxnClass*>& rxn_classes) {
+  const SpeciesContainer& all_species = bng_engine.get_all_species();
+
+  vector<string> res;
+  for (RxnClass* rxn_class: rxn_classes) {
+    rxn_class->init_rxn_pathways_and_rates();
+
+    vector<string> reactants;
+    for (species_id_t id: rxn_class->reactant_ids) {
+      reactants.push_back(all_species.get(id).name);
+    }
+    sort(reactants.begin(), reactants.end());
+
+    for (uint i = 0; i < rxn_class->get_num_pathways(); i++) {
+      vector<string> products;
+      for (const ProductSpeciesIdWIndices& prod: rxn_class->get_rxn_products_for_pathway(i)) {
+        products.push_back(all_species.get(prod.product_species_id).name);
+      }
+      sort(products.begin(), products.end());
+
+      stringstream ss;
+      for (const string& r: reactants) {
+        ss << r << " ";
+      }
+      ss << "->";
+      for (const string& p: products) {
+        ss << " " << p;
+      }
+      ss << " " << rxn_class->get_rxn_for_pathway(i)->base_rate_constant;
+      ss << " " << rxn_class->pathways[i].pathway_prob;
+      res.push_back(ss.str());
+    }
+  }
+  sort(res.begin(), res.end());
+  return res;
+}
+
+
+int main() {
+
+  BNGConfig bng_config;
+
+  // network generated from rxn rules
+  BNGEngine rules_engine(bng_config);
+  int num_errors = parse_bngl_file(get_test_bngl_file_name(__FILE__), rules_engine.get_data());
+  release_assert(num_errors == 0);
+  rules_engine.initialize();
+
+  set<RxnClass*> rules_rxn_classes;
+  generate_network(rules_engine, rules_rxn_classes);
+  vector<string> rules_pathways = get_network_pathways(rules_engine, rules_rxn_classes);
+  release_assert(rules_pathways.size() == 7);
+
+  // the same network imported from a .net file
+  string net_file_name = get_test_net_file_name(__FILE__);
+  BNGEngine net_engine(bng_config);
+  NetGroupVector groups;
+  num_errors = import_net_file(net_file_name, net_engine, groups);
+  release_assert(num_errors == 0);
+
+  const BNGData& net_data = net_engine.get_data();
+  double koff;
+  release_assert(net_data.get_parameter_value("koff", koff) && koff == 1e4);
+  release_assert(net_data.get_elem_mol_types().size() == 2);
+  release_assert(net_data.get_observables().size() == 3);
+  release_assert(net_data.get_seed_species().size() == 2);
+  release_assert(net_data.get_seed_species()[1].count == 50);
+  release_assert(net_engine.get_all_species().get_species_vector().size() == 5);
+
+  // rxns are not matched onto species
+  RxnContainer& net_rxns = net_engine.get_all_rxns();
+  release_assert(net_rxns.get_rxn_rules_vector().size() == 7);
+  for (const RxnRule* r: net_rxns.get_rxn_rules_vector()) {
+    release_assert(r->is_explicit());
+  }
+  release_assert(net_rxns.get_reactant_pattern_table().get_num_patterns() == 0);
+  release_assert(net_rxns.get(6)->name == "_R3" && net_rxns.get(6)->products.empty());
+
+  set<RxnClass*> net_rxn_classes;
+  generate_network(net_engine, net_rxn_classes);
+  vector<string> net_pathways = get_network_pathways(net_engine, net_rxn_classes);
+  release_assert(net_pathways == rules_pathways);
+
+  // groups
+  release_assert(groups.size() == 3);
+  release_assert(groups[2].name == "Mols");
+  release_assert(groups[2].species_ids.size() == 5);
+  release_assert(groups[2].species_ids[3] == net_engine.get_all_species().find_by_name("A(b!1,s~0).B(a!1)"));
+  release_assert(groups[2].weights[3] == 2 && groups[2].weights[0] == 1);
+
+  // rate updates are applied to the imported rxns
+  species_id_t a0_id = net_engine.get_all_species().find_by_name("A(b,s~0)");
+  RxnClass* a0_rxn_class = net_rxns.get_unimol_rxn_class(a0_id);
+  release_assert(a0_rxn_class != nullptr && a0_rxn_class->get_num_pathways() == 1);
+  double orig_p = a0_rxn_class->get_max_fixed_p();
+  net_rxns.get(0)->update_rxn_rate(0.2);
+  double updated_p = a0_rxn_class->get_max_fixed_p();
+  release_assert(cmp_eq(updated_p, 2 * orig_p));
+
+  // rxn classes of explicit rxns are kept by cache resets
+  net_rxns.reset_caches();
+  a0_rxn_class = net_rxns.get_unimol_rxn_class(a0_id);
+  release_assert(a0_rxn_class != nullptr && a0_rxn_class->get_max_fixed_p() == updated_p);
+  release_assert(net_rxns.get_bimol_rxns_for_reactant(a0_id, true)->size() == 1);
+
+  // species strings may be trusted to be canonical
+  BNGEngine canonical_engine(bng_config);
+  num_errors = import_net_file(net_file_name, canonical_engine, groups, true);
+  release_assert(num_errors == 0);
+  release_assert(canonical_engine.get_all_species().find_by_name("A(b!1,s~1).B(a!1)") != SPECIES_ID_INVALID);
+  set<RxnClass*> canonical_rxn_classes;
+  generate_network(canonical_engine, canonical_rxn_classes);
+  release_assert(get_network_pathways(canonical_engine, canonical_rxn_classes).size() == 7);
+
+  // errors are reported
+  stringstream invalid_net;
+  invalid_net <<
+      "begin species\n" <<
+      "  1 A(b,s~0) 10\n" <<
+      "end species\n" <<
+      "begin reactions\n" <<
+      "  1 1 2 1.0\n" <<
+      "  2 1 1 k_undefined\n" <<
+      "end reactions\n";
+  BNGEngine invalid_engine(bng_config);
+  num_errors = import_net_stream(invalid_net, invalid_engine, groups);
+  release_assert(num_errors == 2);
+}
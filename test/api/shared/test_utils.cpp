@@ -138,3 +138,65 @@ void dump_network(const set<RxnClass*>& all_rxn_classes) {
   }
 }
 
+
+double get_parameter(const BNGData& bng_data, const string& name) {
+  double res;
+  release_assert(bng_data.get_parameter_value(name, res));
+  return res;
+}
+
+
+void check_same_model(const BNGData& parsed, const BNGData& other) {
+  release_assert(parsed.get_parameters() == other.get_parameters());
+
+  release_assert(parsed.get_elem_mol_types().size() == other.get_elem_mol_types().size());
+  for (size_t i = 0; i < parsed.get_elem_mol_types().size(); i++) {
+    release_assert(parsed.get_elem_mol_types()[i].to_str(parsed) == other.get_elem_mol_types()[i].to_str(other));
+  }
+
+  release_assert(parsed.get_compartments().size() == other.get_compartments().size());
+  for (size_t i = 0; i < parsed.get_compartments().size(); i++) {
+    const Compartment& p = parsed.get_compartments()[i];
+    const Compartment& o = other.get_compartments()[i];
+    release_assert(p.name == o.name && p.is_3d == o.is_3d);
+    release_assert(p.parent_compartment_id == o.parent_compartment_id);
+    release_assert(p.children_compartments == o.children_compartments);
+    release_assert(p.get_volume_including_children(parsed) == o.get_volume_including_children(other));
+  }
+
+  release_assert(parsed.get_rxn_rules().size() == other.get_rxn_rules().size());
+  for (size_t i = 0; i < parsed.get_rxn_rules().size(); i++) {
+    const RxnRule& p = parsed.get_rxn_rules()[i];
+    const RxnRule& o = other.get_rxn_rules()[i];
+    release_assert(p.to_str() == o.to_str());
+    release_assert(p.is_finalized());
+    // names are set by canonicalization, complexes loaded from a cache keep the stored names
+    release_assert(p.reactants.size() == o.reactants.size() && p.products.size() == o.products.size());
+    for (size_t k = 0; k < p.reactants.size(); k++) {
+      release_assert(p.reactants[k].name == o.reactants[k].name);
+    }
+    for (size_t k = 0; k < p.products.size(); k++) {
+      release_assert(p.products[k].name == o.products[k].name);
+    }
+  }
+
+  release_assert(parsed.get_seed_species().size() == other.get_seed_species().size());
+  for (size_t i = 0; i < parsed.get_seed_species().size(); i++) {
+    const SeedSpecies& p = parsed.get_seed_species()[i];
+    const SeedSpecies& o = other.get_seed_species()[i];
+    release_assert(p.cplx.to_str() == o.cplx.to_str());
+    release_assert(p.cplx.get_primary_compartment_id() == o.cplx.get_primary_compartment_id());
+    release_assert(p.count == o.count);
+  }
+
+  release_assert(parsed.get_observables().size() == other.get_observables().size());
+  for (size_t i = 0; i < parsed.get_observables().size(); i++) {
+    const Observable& p = parsed.get_observables()[i];
+    const Observable& o = other.get_observables()[i];
+    release_assert(p.name == o.name && p.type == o.type);
+    release_assert(p.patterns.size() == o.patterns.size());
+    for (size_t k = 0; k < p.patterns.size(); k++) {
+      release_assert(p.patterns[k].to_str() == o.patterns[k].to_str());
+    }
+  }
+}
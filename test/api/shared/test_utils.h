@@ -7,6 +7,7 @@
 
 namespace BNG {
 class BNGEngine;
+class BNGData;
 class RxnClass;
 }
 
@@ -18,4 +19,11 @@ unsigned int get_num_rxns_in_network(const std::set<BNG::RxnClass*>& all_rxn_cla
 
 void dump_network(const std::set<BNG::RxnClass*>& all_rxn_classes);
 
+// the parameter must exist
+double get_parameter(const BNG::BNGData& bng_data, const std::string& name);
+
+// checks that other contains the same model as parsed, rxn rules of parsed must be finalized,
+// rxn rules of other may be e.g. loaded from a model cache and not finalized yet
+void check_same_model(const BNG::BNGData& parsed, const BNG::BNGData& other);
+
 #endif // TEST_UTILS_H